@@ -194,6 +194,15 @@ action_quit_activated(GSimpleAction *action, GVariant *parameter, gpointer app)
     }
 }
 
+static FsearchDatabaseIndexPropertyFlags
+get_index_flags(FsearchConfig *config) {
+    FsearchDatabaseIndexPropertyFlags flags = DATABASE_INDEX_PROPERTY_FLAG_DEFAULT;
+    if (config->index_content_types) {
+        flags |= DATABASE_INDEX_PROPERTY_FLAG_FILETYPE;
+    }
+    return flags;
+}
+
 static void
 on_preferences_dialog_response(GtkDialog *dialog, gint response_id, gpointer user_data) {
     FsearchApplication *self = FSEARCH_APPLICATION(user_data);
@@ -209,11 +218,13 @@ on_preferences_dialog_response(GtkDialog *dialog, gint response_id, gpointer use
         self->config = new_config;
         config_save(self->config);
 
+        fsearch_database_set_trigram_index_enabled(self->db, self->config->enable_trigram_index);
+
         if (config_diff.database_config_changed) {
             fsearch_database_cancel_scan(self->db);
             g_autoptr(FsearchDatabaseWork) work = fsearch_database_work_new_scan(self->config->includes,
                                                                                  self->config->excludes,
-                                                                                 DATABASE_INDEX_PROPERTY_FLAG_DEFAULT);
+                                                                                 get_index_flags(self->config));
             fsearch_database_queue_work(self->db, work);
         }
 
@@ -424,12 +435,16 @@ on_database_load_finished(FsearchDatabase *db, FsearchDatabaseInfo *info, gpoint
     const bool includes_changed = !fsearch_database_include_manager_equal(db_includes, self->config->includes);
     const bool excludes_changed = !fsearch_database_exclude_manager_equal(db_excludes, self->config->excludes);
 
-    if (includes_changed || excludes_changed) {
+    const FsearchDatabaseIndexPropertyFlags index_flags = get_index_flags(self->config);
+    const bool content_types_changed = (fsearch_database_info_get_flags(info) & DATABASE_INDEX_PROPERTY_FLAG_FILETYPE)
+                                    != (index_flags & DATABASE_INDEX_PROPERTY_FLAG_FILETYPE);
+
+    if (includes_changed || excludes_changed || content_types_changed) {
         g_debug("[app] database config differs from config file, triggering rescan");
         fsearch_database_cancel_scan(self->db);
         g_autoptr(FsearchDatabaseWork) work = fsearch_database_work_new_scan(self->config->includes,
                                                                              self->config->excludes,
-                                                                             DATABASE_INDEX_PROPERTY_FLAG_DEFAULT);
+                                                                             index_flags);
         fsearch_database_queue_work(self->db, work);
     }
 }
@@ -456,6 +471,7 @@ fsearch_application_startup(GApplication *app) {
     g_autofree char *db_file_path = g_build_filename(g_get_user_data_dir(), "fsearch", "fsearch.db", NULL);
     g_autoptr(GFile) db_file = g_file_new_for_path(db_file_path);
     self->db = fsearch_database_new(g_steal_pointer(&db_file), self->config->includes, self->config->excludes);
+    fsearch_database_set_trigram_index_enabled(self->db, self->config->enable_trigram_index);
     self->db_state = FSEARCH_DATABASE_STATE_IDLE;
 
     g_signal_connect_object(self->db, "load-started", G_CALLBACK(on_database_load_started), self, G_CONNECT_AFTER);
@@ -20,13 +20,16 @@
 
 #include "fsearch_array.h"
 #include <glib.h>
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/param.h>
 
-#define MAX_SORT_THREADS 8
+#define MAX_SORT_THREADS 64
 #define MERGE_SORT_THRESHOLD 16
+// Sorting fewer items per thread isn't worth splitting and merging them
+#define MIN_ITEMS_PER_SORT_THREAD 4096
+// Number of items sampled from each sorted run per merge range, to pick the splitters between the ranges
+#define SPLITTER_SAMPLES_PER_RANGE 16
 
 struct DynamicArray {
     // number of items in array
@@ -89,12 +92,25 @@ darray_unref(DynamicArray *array) {
 }
 
 typedef struct {
-    DynamicArray *m1;
-    DynamicArray *m2;
-    DynamicArray *dest;
-    gpointer user_data;
+    GMutex mutex;
+    GCond cond;
+    uint32_t num_pending;
+    GCancellable *cancellable;
+} SortTaskGroup;
+
+typedef struct {
+    SortTaskGroup *group;
     DynamicArrayCompareDataFunc comp_func;
-} DynamicArraySortContext;
+    void *comp_data;
+    // Sort tasks: the run which gets sorted
+    DynamicArray *run;
+    // Merge tasks: the ranges [run_starts[i], run_ends[i]) of all runs get merged into dest
+    DynamicArray **runs;
+    uint32_t num_runs;
+    uint32_t *run_starts;
+    uint32_t *run_ends;
+    void **dest;
+} SortTask;
 
 static void
 insertion_sort_range(DynamicArray *array,
@@ -188,49 +204,128 @@ merge_sort(DynamicArray *to_sort, GCancellable *cancellable, DynamicArrayCompare
     split_merge(tmp, to_sort, 0, to_sort->num_items, cancellable, comp_func, comp_data);
 }
 
+// Whether the next item of run `a` comes before the one of run `b`. Ties go to the run which came first in the
+// array, which keeps the sort stable.
+static inline bool
+merge_run_is_before(SortTask *task, const uint32_t *positions, uint32_t a, uint32_t b) {
+    const int32_t res = task->comp_func(&task->runs[a]->data[positions[a]],
+                                        &task->runs[b]->data[positions[b]],
+                                        task->comp_data);
+    return res < 0 || (res == 0 && a < b);
+}
+
 static void
-sort_thread(gpointer data, gpointer user_data) {
-    DynamicArraySortContext *ctx = data;
-    GCancellable *cancellable = user_data;
-    merge_sort(ctx->dest, cancellable, (DynamicArrayCompareDataFunc)ctx->comp_func, ctx->user_data);
+merge_heap_sift_down(SortTask *task, const uint32_t *positions, uint32_t *heap, uint32_t heap_size, uint32_t idx) {
+    while (true) {
+        const uint32_t left = 2 * idx + 1;
+        const uint32_t right = left + 1;
+        uint32_t first = idx;
+        if (left < heap_size && merge_run_is_before(task, positions, heap[left], heap[first])) {
+            first = left;
+        }
+        if (right < heap_size && merge_run_is_before(task, positions, heap[right], heap[first])) {
+            first = right;
+        }
+        if (first == idx) {
+            return;
+        }
+        const uint32_t tmp = heap[idx];
+        heap[idx] = heap[first];
+        heap[first] = tmp;
+        idx = first;
+    }
 }
 
-static inline void
-add_remaining_items(DynamicArray *dest, DynamicArray *source, uint32_t start_idx) {
-    const uint32_t remaining_items = source->num_items - start_idx;
-    if (remaining_items > 0) {
-        darray_add_items(dest, &source->data[start_idx], remaining_items);
+// Merges the ranges of all sorted runs, with a heap of the runs ordered by their next item
+static void
+merge_runs(SortTask *task, GCancellable *cancellable) {
+    uint32_t positions[MAX_SORT_THREADS];
+    uint32_t heap[MAX_SORT_THREADS];
+    uint32_t heap_size = 0;
+    for (uint32_t i = 0; i < task->num_runs; ++i) {
+        positions[i] = task->run_starts[i];
+        if (positions[i] < task->run_ends[i]) {
+            heap[heap_size++] = i;
+        }
+    }
+    for (uint32_t i = heap_size / 2; i > 0; --i) {
+        merge_heap_sift_down(task, positions, heap, heap_size, i - 1);
+    }
+
+    uint32_t num_merged = 0;
+    while (heap_size > 1) {
+        if ((num_merged & 0xffff) == 0 && g_cancellable_is_cancelled(cancellable)) {
+            return;
+        }
+        const uint32_t run = heap[0];
+        task->dest[num_merged++] = task->runs[run]->data[positions[run]++];
+        if (positions[run] == task->run_ends[run]) {
+            heap[0] = heap[--heap_size];
+        }
+        merge_heap_sift_down(task, positions, heap, heap_size, 0);
+    }
+    if (heap_size == 1) {
+        const uint32_t run = heap[0];
+        memcpy(task->dest + num_merged,
+               task->runs[run]->data + positions[run],
+               (task->run_ends[run] - positions[run]) * sizeof(void *));
     }
 }
 
 static void
-merge_thread(gpointer data, gpointer user_data) {
-    DynamicArraySortContext *ctx = data;
-    uint32_t left_idx = 0;
-    uint32_t right_idx = 0;
-    const uint32_t left_size = ctx->m1->num_items;
-    const uint32_t right_size = ctx->m2->num_items;
-
-    // Merge arrays while both have elements
-    while (left_idx < left_size && right_idx < right_size) {
-        void *left_item = darray_get_item(ctx->m1, left_idx);
-        void *right_item = darray_get_item(ctx->m2, right_idx);
-
-        const int comparison = ctx->comp_func(&left_item, &right_item, ctx->user_data);
-
-        if (comparison <= 0) {
-            darray_add_item(ctx->dest, left_item);
-            left_idx++;
+sort_pool_func(gpointer data, gpointer user_data) {
+    SortTask *task = data;
+    SortTaskGroup *group = task->group;
+    if (!g_cancellable_is_cancelled(group->cancellable)) {
+        if (task->run) {
+            merge_sort(task->run, group->cancellable, task->comp_func, task->comp_data);
         }
         else {
-            darray_add_item(ctx->dest, right_item);
-            right_idx++;
+            merge_runs(task, group->cancellable);
         }
     }
 
-    // Add remaining elements from either array
-    add_remaining_items(ctx->dest, ctx->m1, left_idx);
-    add_remaining_items(ctx->dest, ctx->m2, right_idx);
+    g_mutex_lock(&group->mutex);
+    if (--group->num_pending == 0) {
+        g_cond_signal(&group->cond);
+    }
+    g_mutex_unlock(&group->mutex);
+}
+
+// All multi threaded sorts share one pool, which lives as long as the process, instead of starting new threads for
+// every sort
+static GThreadPool *
+get_sort_pool(void) {
+    static GThreadPool *sort_pool = NULL;
+    if (g_once_init_enter(&sort_pool)) {
+        const int num_threads = (int)MIN(g_get_num_processors(), MAX_SORT_THREADS);
+        GThreadPool *pool = g_thread_pool_new(sort_pool_func, NULL, num_threads, FALSE, NULL);
+        g_once_init_leave(&sort_pool, pool);
+    }
+    return sort_pool;
+}
+
+// Runs all tasks on the sort pool and waits until they're done
+static void
+sort_pool_run_tasks(SortTask *tasks, uint32_t num_tasks, GCancellable *cancellable) {
+    SortTaskGroup group = {.num_pending = num_tasks, .cancellable = cancellable};
+    g_mutex_init(&group.mutex);
+    g_cond_init(&group.cond);
+
+    GThreadPool *pool = get_sort_pool();
+    for (uint32_t i = 0; i < num_tasks; ++i) {
+        tasks[i].group = &group;
+        g_thread_pool_push(pool, &tasks[i], NULL);
+    }
+
+    g_mutex_lock(&group.mutex);
+    while (group.num_pending > 0) {
+        g_cond_wait(&group.cond, &group.mutex);
+    }
+    g_mutex_unlock(&group.mutex);
+
+    g_mutex_clear(&group.mutex);
+    g_cond_clear(&group.cond);
 }
 
 DynamicArray *
@@ -295,6 +390,17 @@ darray_add_array(DynamicArray *dest, DynamicArray *source) {
     darray_add_items(dest, source->data, source->num_items);
 }
 
+void
+darray_add_array_range(DynamicArray *dest, DynamicArray *source, uint32_t start_idx, uint32_t num_items) {
+    g_assert(dest);
+    g_assert(dest->data);
+    g_assert(source);
+    g_assert(source->data);
+    g_assert(start_idx + num_items <= source->num_items);
+
+    darray_add_items(dest, source->data + start_idx, num_items);
+}
+
 void
 darray_add_item(DynamicArray *array, void *data) {
     g_assert(array);
@@ -558,65 +664,56 @@ darray_get_size(DynamicArray *array) {
     return array->max_items;
 }
 
-static DynamicArray *
-new_array_from_data(void **data, uint32_t num_items) {
-    DynamicArray *array = darray_new(num_items);
-    darray_add_items(array, data, num_items);
-    return array;
-}
-
-static GArray *
-merge_sorted(GArray *merge_me, DynamicArrayCompareDataFunc comp_func, gpointer comp_data, GCancellable *cancellable) {
-    if (merge_me->len == 1) {
-        return merge_me;
-    }
-    if (g_cancellable_is_cancelled(cancellable)) {
-        return merge_me;
+// Index of the first item in `run` from `start` on which doesn't come before `item`
+static uint32_t
+run_lower_bound(DynamicArray *run, uint32_t start, void *item, DynamicArrayCompareDataFunc comp_func, void *data) {
+    uint32_t left = start;
+    uint32_t right = run->num_items;
+    while (left < right) {
+        const uint32_t middle = left + (right - left) / 2;
+        if (comp_func(&run->data[middle], &item, data) < 0) {
+            left = middle + 1;
+        }
+        else {
+            right = middle;
+        }
     }
-    const uint32_t num_threads = merge_me->len / 2;
-
-    g_autoptr(GArray) merged_data = g_array_sized_new(TRUE, TRUE, sizeof(DynamicArraySortContext), num_threads);
-    GThreadPool *merge_pool = g_thread_pool_new(merge_thread, NULL, (gint)num_threads, FALSE, NULL);
-
-    for (int i = 0; i < num_threads; ++i) {
-        DynamicArraySortContext *c1 = &g_array_index(merge_me, DynamicArraySortContext, 2 * i);
-        DynamicArraySortContext *c2 = &g_array_index(merge_me, DynamicArraySortContext, 2 * i + 1);
-        DynamicArray *i1 = c1->dest;
-        DynamicArray *i2 = c2->dest;
-
-        DynamicArraySortContext merge_ctx = {};
-        merge_ctx.m1 = i1;
-        merge_ctx.m2 = i2;
-        merge_ctx.comp_func = comp_func;
-        merge_ctx.user_data = comp_data;
-        merge_ctx.dest = darray_new(i1->num_items + i2->num_items);
-
-        g_array_insert_val(merged_data, i, merge_ctx);
+    return left;
+}
 
-        g_thread_pool_push(merge_pool, &g_array_index(merged_data, DynamicArraySortContext, i), NULL);
+// Picks `num_ranges - 1` splitters from samples of the sorted runs and stores where they split each run in `bounds`,
+// so that the ranges between them can be merged independently and get about the same size
+static void
+split_runs(DynamicArray **runs,
+           uint32_t num_runs,
+           uint32_t num_ranges,
+           DynamicArrayCompareDataFunc comp_func,
+           void *data,
+           uint32_t *bounds) {
+    g_autoptr(DynamicArray) samples = darray_new(num_runs * num_ranges * SPLITTER_SAMPLES_PER_RANGE);
+    for (uint32_t i = 0; i < num_runs; ++i) {
+        const uint32_t num_items = runs[i]->num_items;
+        const uint32_t num_samples = MIN(num_items, num_ranges * SPLITTER_SAMPLES_PER_RANGE);
+        for (uint32_t j = 0; j < num_samples; ++j) {
+            darray_add_item(samples, runs[i]->data[(uint64_t)j * num_items / num_samples]);
+        }
     }
+    darray_sort(samples, comp_func, NULL, data);
 
-    g_thread_pool_free(g_steal_pointer(&merge_pool), FALSE, TRUE);
-
-    for (int i = 0; i < merge_me->len; i++) {
-        DynamicArraySortContext *c = &g_array_index(merge_me, DynamicArraySortContext, i);
-        if (c && c->dest) {
-            g_clear_pointer(&c->dest, darray_unref);
+    for (uint32_t i = 0; i < num_runs; ++i) {
+        uint32_t *run_bounds = bounds + i * (num_ranges + 1);
+        run_bounds[0] = 0;
+        for (uint32_t j = 1; j < num_ranges; ++j) {
+            void *splitter = samples->data[(uint64_t)j * samples->num_items / num_ranges];
+            run_bounds[j] = run_lower_bound(runs[i], run_bounds[j - 1], splitter, comp_func, data);
         }
+        run_bounds[num_ranges] = runs[i]->num_items;
     }
-    g_clear_pointer(&merge_me, g_array_unref);
-
-    return merge_sorted(g_steal_pointer(&merged_data), comp_func, comp_data, cancellable);
 }
 
-static int
+static uint32_t
 get_ideal_thread_count() {
-    // int num_processors = 1;
-    const int num_processors = (int)g_get_num_processors();
-
-    const int e = floor(log2(num_processors));
-    const int num_threads = (int)pow(2, e);
-    return MIN(num_threads, MAX_SORT_THREADS);
+    return MIN(g_get_num_processors(), MAX_SORT_THREADS);
 }
 
 void
@@ -624,50 +721,84 @@ darray_sort_multi_threaded(DynamicArray *array,
                            DynamicArrayCompareDataFunc comp_func,
                            GCancellable *cancellable,
                            void *data) {
-    const int num_threads = get_ideal_thread_count();
-    if (num_threads < 2 || num_threads > array->num_items) {
+    darray_sort_multi_threaded_with_num_threads(array, comp_func, cancellable, data, get_ideal_thread_count());
+}
+
+void
+darray_sort_multi_threaded_with_num_threads(DynamicArray *array,
+                                            DynamicArrayCompareDataFunc comp_func,
+                                            GCancellable *cancellable,
+                                            void *data,
+                                            uint32_t num_threads) {
+    g_assert(array);
+    num_threads = MIN(MIN(num_threads, MAX_SORT_THREADS), array->num_items / MIN_ITEMS_PER_SORT_THREAD);
+    if (num_threads < 2) {
         return darray_sort(array, comp_func, cancellable, data);
     }
 
-    g_debug("[sort] sorting with %d threads", num_threads);
-
-    const int num_items_per_thread = (int)(array->num_items / num_threads);
-    GThreadPool *sort_pool = g_thread_pool_new(sort_thread, cancellable, num_threads, FALSE, NULL);
-
-    g_autoptr(GArray) sort_ctx_array = g_array_sized_new(TRUE, TRUE, sizeof(DynamicArraySortContext), num_threads);
-
-    int start = 0;
-    for (int i = 0; i < num_threads; ++i) {
-        DynamicArraySortContext sort_ctx;
-        sort_ctx.dest = new_array_from_data(array->data + start,
-                                            i == num_threads - 1 ? array->num_items - start : num_items_per_thread);
-        sort_ctx.comp_func = comp_func;
-        sort_ctx.user_data = data;
-        start += num_items_per_thread;
-        g_array_insert_val(sort_ctx_array, i, sort_ctx);
-        g_thread_pool_push(sort_pool, &g_array_index(sort_ctx_array, DynamicArraySortContext, i), NULL);
+    g_debug("[sort] sorting with %u threads", num_threads);
+
+    // Sort one run per thread first
+    const uint32_t num_items = array->num_items;
+    const uint32_t num_items_per_run = num_items / num_threads;
+    DynamicArray *runs[MAX_SORT_THREADS] = {NULL};
+    SortTask tasks[MAX_SORT_THREADS] = {};
+    for (uint32_t i = 0; i < num_threads; ++i) {
+        runs[i] = darray_get_range(array,
+                                   i * num_items_per_run,
+                                   i == num_threads - 1 ? UINT32_MAX : num_items_per_run);
+        tasks[i].comp_func = comp_func;
+        tasks[i].comp_data = data;
+        tasks[i].run = runs[i];
+    }
+    sort_pool_run_tasks(tasks, num_threads, cancellable);
+
+    // Then split the output into one range per thread and merge the parts of all runs which belong to each range.
+    // This keeps all threads busy until the end, instead of merging pairs of runs with fewer threads in every round.
+    g_autofree uint32_t *bounds = NULL;
+    g_autofree uint32_t *run_starts = NULL;
+    g_autofree uint32_t *run_ends = NULL;
+    void **merged = NULL;
+    if (!g_cancellable_is_cancelled(cancellable)) {
+        bounds = g_new(uint32_t, num_threads * (num_threads + 1));
+        split_runs(runs, num_threads, num_threads, comp_func, data, bounds);
+
+        merged = calloc(num_items, sizeof(void *));
+        g_assert(merged);
+        run_starts = g_new(uint32_t, num_threads * num_threads);
+        run_ends = g_new(uint32_t, num_threads * num_threads);
+        uint32_t dest_offset = 0;
+        for (uint32_t i = 0; i < num_threads; ++i) {
+            SortTask *task = &tasks[i];
+            memset(task, 0, sizeof(SortTask));
+            task->comp_func = comp_func;
+            task->comp_data = data;
+            task->runs = runs;
+            task->num_runs = num_threads;
+            task->run_starts = run_starts + i * num_threads;
+            task->run_ends = run_ends + i * num_threads;
+            task->dest = merged + dest_offset;
+            for (uint32_t j = 0; j < num_threads; ++j) {
+                task->run_starts[j] = bounds[j * (num_threads + 1) + i];
+                task->run_ends[j] = bounds[j * (num_threads + 1) + i + 1];
+                dest_offset += task->run_ends[j] - task->run_starts[j];
+            }
+        }
+        g_assert(dest_offset == num_items);
+        sort_pool_run_tasks(tasks, num_threads, cancellable);
     }
-    g_thread_pool_free(g_steal_pointer(&sort_pool), FALSE, TRUE);
-
-    g_autoptr(GArray) result = merge_sorted(g_steal_pointer(&sort_ctx_array), comp_func, data, cancellable);
 
-    if (result) {
+    if (merged && !g_cancellable_is_cancelled(cancellable)) {
         // Apply results if sorting wasn't canceled
-        if (!g_cancellable_is_cancelled(cancellable)) {
-            DynamicArraySortContext *c = &g_array_index(result, DynamicArraySortContext, 0);
-            g_clear_pointer(&array->data, free);
-            array->data = g_steal_pointer(&c->dest->data);
-            array->num_items = c->dest->num_items;
-            array->max_items = c->dest->max_items;
-        }
-
-        // Make sure to clean up result array entries; in case of cancellation, there can be more than one entry
-        for (guint i = 0; i < result->len; i++) {
-            DynamicArraySortContext *ctx = &g_array_index(result, DynamicArraySortContext, i);
-            if (ctx && ctx->dest) {
-                g_clear_pointer(&ctx->dest, darray_unref);
-            }
-        }
+        g_clear_pointer(&array->data, free);
+        array->data = merged;
+        array->max_items = num_items;
+    }
+    else {
+        g_clear_pointer(&merged, free);
+    }
+    for (uint32_t i = 0; i < num_threads; ++i) {
+        g_clear_pointer(&runs[i], darray_unref);
     }
 }
 
@@ -46,6 +46,14 @@ darray_sort_multi_threaded(DynamicArray *array,
                            GCancellable *cancellable,
                            void *data);
 
+// Same as darray_sort_multi_threaded, but with at most `num_threads` threads instead of one per processor
+void
+darray_sort_multi_threaded_with_num_threads(DynamicArray *array,
+                                            DynamicArrayCompareDataFunc comp_func,
+                                            GCancellable *cancellable,
+                                            void *data,
+                                            uint32_t num_threads);
+
 void
 darray_sort(DynamicArray *array, DynamicArrayCompareDataFunc comp_func, GCancellable *cancellable, void *data);
 
@@ -77,6 +85,9 @@ darray_add_items(DynamicArray *array, void **items, uint32_t num_items);
 void
 darray_add_array(DynamicArray *dest, DynamicArray *source);
 
+void
+darray_add_array_range(DynamicArray *dest, DynamicArray *source, uint32_t start_idx, uint32_t num_items);
+
 void
 darray_add_item(DynamicArray *array, void *data);
 
@@ -91,6 +91,8 @@ static const FsearchKeyData SEARCH_SECTION[] = {
     CONF_BOOL(auto_search_in_path, true),
     CONF_BOOL(auto_match_case, true),
     CONF_BOOL(search_as_you_type, true),
+    CONF_BOOL(enable_trigram_index, false),
+    CONF_BOOL(index_content_types, false),
 };
 
 static const FsearchKeyData WINDOW_SECTION[] = {
@@ -842,7 +844,7 @@ config_cmp(FsearchConfig *c1, FsearchConfig *c2) {
     const bool includes_changed = !fsearch_database_include_manager_equal(c1->includes, c2->includes);
     const bool excludes_changed = !fsearch_database_exclude_manager_equal(c1->excludes, c2->excludes);
 
-    if (excludes_changed || includes_changed) {
+    if (excludes_changed || includes_changed || c1->index_content_types != c2->index_content_types) {
         result.database_config_changed = true;
     }
 
@@ -53,6 +53,8 @@ struct _FsearchConfig {
     bool auto_search_in_path;
     bool auto_match_case;
     bool search_as_you_type;
+    bool enable_trigram_index;
+    bool index_content_types;
 
     // Applications
     char *folder_open_cmd;
@@ -57,6 +57,14 @@ struct _FsearchDatabase {
     FsearchDatabaseIndexStore *pending_store;
     FsearchDatabaseRescanManager *rescan_manager;
 
+    // Applied to the store before every search, so it can be toggled without waiting for the worker thread
+    volatile gint trigram_index_enabled;
+
+    // The store a search is running on, so the rows of the partial results it publishes can be looked up while the
+    // search holds `mutex`
+    FsearchDatabaseIndexStore *search_store;
+    GMutex search_store_mutex;
+
     GMutex mutex;
 
     bool disposed;
@@ -78,6 +86,7 @@ typedef enum FsearchDatabaseSignalType {
     SIGNAL_SCAN_FINISHED,
     SIGNAL_SEARCH_STARTED,
     SIGNAL_SEARCH_FINISHED,
+    SIGNAL_SEARCH_PROGRESS,
     SIGNAL_SORT_STARTED,
     SIGNAL_SORT_FINISHED,
     SIGNAL_SELECTION_CHANGED,
@@ -173,6 +182,8 @@ signal_type_to_name(FsearchDatabaseSignalType type) {
         return "SIGNAL_SEARCH_STARTED";
     case SIGNAL_SEARCH_FINISHED:
         return "SIGNAL_SEARCH_FINISHED";
+    case SIGNAL_SEARCH_PROGRESS:
+        return "SIGNAL_SEARCH_PROGRESS";
     case SIGNAL_SORT_STARTED:
         return "SIGNAL_SORT_STARTED";
     case SIGNAL_SORT_FINISHED:
@@ -301,6 +312,17 @@ signal_emit_search_finished(FsearchDatabase *self, guint id, FsearchDatabaseSear
                 (GDestroyNotify)fsearch_database_search_info_unref);
 }
 
+static void
+signal_emit_search_progress(FsearchDatabase *self, FsearchDatabaseSearchInfo *info) {
+    signal_emit(self,
+                SIGNAL_SEARCH_PROGRESS,
+                GUINT_TO_POINTER(fsearch_database_search_info_get_id(info)),
+                info,
+                2,
+                NULL,
+                (GDestroyNotify)fsearch_database_search_info_unref);
+}
+
 static void
 signal_emit_sort_finished(FsearchDatabase *self, guint id, FsearchDatabaseSearchInfo *info) {
     signal_emit(self,
@@ -379,6 +401,8 @@ database_get_info(FsearchDatabase *self) {
     g_autoptr(FsearchDatabaseExcludeManager) exclude_manager = database_get_exclude_manager(self);
     return fsearch_database_info_new(include_manager,
                                      exclude_manager,
+                                     self->store ? fsearch_database_index_store_get_flags(self->store)
+                                                 : DATABASE_INDEX_PROPERTY_FLAG_NONE,
                                      database_get_num_files(self),
                                      database_get_num_folders(self));
 }
@@ -444,6 +468,7 @@ database_search(FsearchDatabase *self, FsearchDatabaseWork *work) {
     g_autoptr(FsearchQuery) query = fsearch_database_work_search_get_query(work);
     FsearchDatabaseIndexProperty sort_order = fsearch_database_work_search_get_sort_order(work);
     const GtkSortType sort_type = fsearch_database_work_search_get_sort_type(work);
+    const uint32_t limit = fsearch_database_work_search_get_limit(work);
     g_autoptr(GCancellable) cancellable = fsearch_database_work_get_cancellable(work);
 
     signal_emit(self, SIGNAL_SEARCH_STARTED, GUINT_TO_POINTER(id), NULL, 1, NULL, NULL);
@@ -451,7 +476,23 @@ database_search(FsearchDatabase *self, FsearchDatabaseWork *work) {
     g_autoptr(GMutexLocker) locker = fsearch_database_index_store_get_locker(self->store);
     g_assert_nonnull(locker);
 
-    const bool result = fsearch_database_index_store_search(self->store, id, query, sort_order, sort_type, cancellable);
+    fsearch_database_index_store_set_trigram_index_enabled(self->store, g_atomic_int_get(&self->trigram_index_enabled));
+
+    g_mutex_lock(&self->search_store_mutex);
+    self->search_store = fsearch_database_index_store_ref(self->store);
+    g_mutex_unlock(&self->search_store_mutex);
+
+    const bool result = fsearch_database_index_store_search(self->store,
+                                                            id,
+                                                            query,
+                                                            sort_order,
+                                                            sort_type,
+                                                            limit,
+                                                            cancellable);
+
+    g_mutex_lock(&self->search_store_mutex);
+    g_clear_pointer(&self->search_store, fsearch_database_index_store_unref);
+    g_mutex_unlock(&self->search_store_mutex);
 
     signal_emit_search_finished(self, id, fsearch_database_index_store_get_search_info(self->store, id));
 
@@ -482,6 +523,9 @@ index_store_event_cb(FsearchDatabaseIndexStore *store,
     case FSEARCH_DATABASE_INDEX_STORE_EVENT_APPLY_FINISHED:
         signal_emit_apply_finished(self);
         break;
+    case FSEARCH_DATABASE_INDEX_STORE_EVENT_SEARCH_PROGRESS:
+        signal_emit_search_progress(self, (FsearchDatabaseSearchInfo *)data);
+        break;
     default:
         g_assert_not_reached();
     }
@@ -610,6 +654,14 @@ database_set_store(FsearchDatabase *self, FsearchDatabaseIndexStore *store) {
     if (self->rescan_manager) {
         fsearch_database_rescan_manager_notify_new_config(self->rescan_manager, include_manager);
     }
+
+    if (self->store) {
+        // Gets the trigram index built right away, instead of only once the next search applies the setting
+        g_autoptr(GMutexLocker) locker = fsearch_database_index_store_get_locker(self->store);
+        g_assert_nonnull(locker);
+        fsearch_database_index_store_set_trigram_index_enabled(self->store,
+                                                               g_atomic_int_get(&self->trigram_index_enabled));
+    }
 }
 
 static void
@@ -1112,6 +1164,7 @@ fsearch_database_finalize(GObject *object) {
 
     g_mutex_clear(&self->mutex);
     g_mutex_clear(&self->scan_mutex);
+    g_mutex_clear(&self->search_store_mutex);
 
     G_OBJECT_CLASS(fsearch_database_parent_class)->finalize(object);
 }
@@ -1236,6 +1289,17 @@ fsearch_database_class_init(FsearchDatabaseClass *klass) {
                                                    2,
                                                    G_TYPE_UINT,
                                                    FSEARCH_TYPE_DATABASE_SEARCH_INFO);
+    signals[SIGNAL_SEARCH_PROGRESS] = g_signal_new("search-progress",
+                                                   G_TYPE_FROM_CLASS(klass),
+                                                   G_SIGNAL_RUN_LAST,
+                                                   0,
+                                                   NULL,
+                                                   NULL,
+                                                   NULL,
+                                                   G_TYPE_NONE,
+                                                   2,
+                                                   G_TYPE_UINT,
+                                                   FSEARCH_TYPE_DATABASE_SEARCH_INFO);
     signals[SIGNAL_SORT_STARTED] = g_signal_new("sort-started",
                                                 G_TYPE_FROM_CLASS(klass),
                                                 G_SIGNAL_RUN_LAST,
@@ -1324,6 +1388,7 @@ static void
 fsearch_database_init(FsearchDatabase *self) {
     g_mutex_init(&self->mutex);
     g_mutex_init(&self->scan_mutex);
+    g_mutex_init(&self->search_store_mutex);
     self->cancellable = g_cancellable_new();
 #if GLIB_CHECK_VERSION(2, 70, 0)
     self->io_pool = g_thread_pool_new_full(io_thread_cb, self, (GDestroyNotify)fsearch_database_work_unref, 1, TRUE, NULL);
@@ -1392,6 +1457,12 @@ fsearch_database_cancel_scan(FsearchDatabase *self) {
     }
 }
 
+void
+fsearch_database_set_trigram_index_enabled(FsearchDatabase *self, bool enabled) {
+    g_return_if_fail(self);
+    g_atomic_int_set(&self->trigram_index_enabled, enabled ? 1 : 0);
+}
+
 FsearchResult
 fsearch_database_try_get_search_info(FsearchDatabase *self, uint32_t view_id, FsearchDatabaseSearchInfo **info_out) {
     g_return_val_if_fail(self, FSEARCH_RESULT_FAILED);
@@ -1421,6 +1492,29 @@ fsearch_database_try_get_search_info(FsearchDatabase *self, uint32_t view_id, Fs
     return res;
 }
 
+// Rows of the partial results a running search published can be looked up while the search keeps the database busy
+static FsearchResult
+database_try_get_streaming_item_info(FsearchDatabase *self,
+                                     uint32_t view_id,
+                                     uint32_t idx,
+                                     FsearchDatabaseEntryInfoFlags flags,
+                                     FsearchDatabaseEntryInfo **info_out) {
+    g_mutex_lock(&self->search_store_mutex);
+    g_autoptr(FsearchDatabaseIndexStore) store = self->search_store ? fsearch_database_index_store_ref(self->search_store)
+                                                                    : NULL;
+    g_mutex_unlock(&self->search_store_mutex);
+
+    if (!store) {
+        return FSEARCH_RESULT_DB_BUSY;
+    }
+    FsearchDatabaseEntryInfo *info = fsearch_database_index_store_get_streaming_entry_info(store, idx, view_id, flags);
+    if (!info) {
+        return FSEARCH_RESULT_DB_BUSY;
+    }
+    *info_out = info;
+    return FSEARCH_RESULT_SUCCESS;
+}
+
 FsearchResult
 fsearch_database_try_get_item_info(FsearchDatabase *self,
                                    uint32_t view_id,
@@ -1431,7 +1525,7 @@ fsearch_database_try_get_item_info(FsearchDatabase *self,
     g_return_val_if_fail(info_out, FSEARCH_RESULT_FAILED);
 
     if (!g_mutex_trylock(&self->mutex)) {
-        return FSEARCH_RESULT_DB_BUSY;
+        return database_try_get_streaming_item_info(self, view_id, idx, flags, info_out);
     }
 
     g_return_val_if_fail(self->store, FSEARCH_RESULT_FAILED);
@@ -1483,7 +1577,8 @@ fsearch_database_rescan_blocking(FsearchDatabase *self) {
     database_rescan_sync(self,
                          self->include_manager,
                          self->exclude_manager,
-                         DATABASE_INDEX_PROPERTY_FLAG_DEFAULT);
+                         self->store ? fsearch_database_index_store_get_flags(self->store)
+                                     : DATABASE_INDEX_PROPERTY_FLAG_DEFAULT);
 
     return FSEARCH_RESULT_SUCCESS;
 }
@@ -24,6 +24,11 @@ fsearch_database_queue_work(FsearchDatabase *self, FsearchDatabaseWork *work);
 void
 fsearch_database_cancel_scan(FsearchDatabase *self);
 
+// Whether substring searches may use a trigram index (see fsearch_database_index_store_set_trigram_index_enabled()).
+// Takes effect with the next search.
+void
+fsearch_database_set_trigram_index_enabled(FsearchDatabase *self, bool enabled);
+
 FsearchResult
 fsearch_database_try_get_search_info(FsearchDatabase *self, uint32_t view_id, FsearchDatabaseSearchInfo **info_out);
 
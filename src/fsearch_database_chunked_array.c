@@ -371,6 +371,43 @@ fsearch_database_chunked_array_find(FsearchDatabaseChunkedArray *self, FsearchDa
     return NULL;
 }
 
+bool
+fsearch_database_chunked_array_get_ranks(FsearchDatabaseChunkedArray *self, DynamicArray *entries, uint32_t *ranks_out) {
+    g_return_val_if_fail(self, false);
+    g_return_val_if_fail(entries, false);
+    g_return_val_if_fail(ranks_out, false);
+
+    const uint32_t num_entries = darray_get_num_items(entries);
+    if (num_entries == 0) {
+        return true;
+    }
+    if (self->num_entries == 0) {
+        return false;
+    }
+
+    // The rank of an entry is its position in its chunk plus the number of entries in all chunks before it
+    const uint32_t num_chunks = darray_get_num_items(self->chunks);
+    g_autofree uint32_t *chunk_offsets = g_new(uint32_t, num_chunks);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < num_chunks; ++i) {
+        chunk_offsets[i] = offset;
+        offset += darray_get_num_items(darray_get_item(self->chunks, i));
+    }
+
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        FsearchDatabaseEntry *entry = darray_get_item(entries, i);
+        uint32_t chunk_idx = 0;
+        DynamicArray *chunk = get_chunk_for_entry(self, entry, &chunk_idx);
+        uint32_t entry_idx = 0;
+        if (!darray_binary_search_with_data(chunk, entry, self->entry_comp_func, self->compare_context, &entry_idx)
+            || darray_get_item(chunk, entry_idx) != entry) {
+            return false;
+        }
+        ranks_out[i] = chunk_offsets[chunk_idx] + entry_idx;
+    }
+    return true;
+}
+
 FsearchDatabaseEntry *
 fsearch_database_chunked_array_find_slow(FsearchDatabaseChunkedArray *self, FsearchDatabaseEntry *entry) {
     for (uint32_t i = 0; i < darray_get_num_items(self->chunks); ++i) {
@@ -605,6 +642,16 @@ fsearch_database_chunked_array_get_entry(FsearchDatabaseChunkedArray *self, uint
     return NULL;
 }
 
+void
+fsearch_database_chunked_array_set_entry_free_func(FsearchDatabaseChunkedArray *self, GDestroyNotify entry_free_func) {
+    g_return_if_fail(self);
+
+    self->entry_free_func = entry_free_func;
+    for (uint32_t i = 0; i < darray_get_num_items(self->chunks); ++i) {
+        darray_set_free_func(darray_get_item(self->chunks, i), entry_free_func);
+    }
+}
+
 uint32_t
 fsearch_database_chunked_array_get_num_entries(FsearchDatabaseChunkedArray *self) {
     g_return_val_if_fail(self, 0);
@@ -61,6 +61,14 @@ fsearch_database_chunked_array_find(FsearchDatabaseChunkedArray *self, FsearchDa
 FsearchDatabaseEntry *
 fsearch_database_chunked_array_get_entry(FsearchDatabaseChunkedArray *self, uint32_t idx);
 
+// Looks up the position of every entry of `entries` in the sorted array and stores it in `ranks_out`, which must have
+// room for all of them. Takes O(log n) comparisons per entry. Returns false if any of the entries isn't in the array.
+bool
+fsearch_database_chunked_array_get_ranks(FsearchDatabaseChunkedArray *self, DynamicArray *entries, uint32_t *ranks_out);
+
+void
+fsearch_database_chunked_array_set_entry_free_func(FsearchDatabaseChunkedArray *self, GDestroyNotify entry_free_func);
+
 uint32_t
 fsearch_database_chunked_array_get_num_entries(FsearchDatabaseChunkedArray *self);
 
@@ -17,14 +17,21 @@
 #include <sys/types.h>
 #include <time.h>
 
+// Folders also store their rank in path order. It's not an index property, so it uses a bit above the range of
+// FsearchDatabaseIndexPropertyFlags and never ends up in the database file.
+#define DATABASE_ENTRY_ATTRIBUTE_FLAG_PATH_RANK (1 << 30)
+
 #define DATABASE_INDEX_PROPERTY_FLAG_FOLDER_DEFAULTS                                                                   \
-    (DATABASE_INDEX_PROPERTY_FLAG_NUM_FOLDERS | DATABASE_INDEX_PROPERTY_FLAG_NUM_FILES)
+    (DATABASE_INDEX_PROPERTY_FLAG_NUM_FOLDERS | DATABASE_INDEX_PROPERTY_FLAG_NUM_FILES                                 \
+     | DATABASE_ENTRY_ATTRIBUTE_FLAG_PATH_RANK)
 
 typedef struct FsearchDatabaseEntry {
     FsearchDatabaseEntry *parent;
 
     uint32_t attribute_flags;
     uint16_t flags;
+    // Number of ancestors, updated whenever the parent gets set. Paths are limited to PATH_MAX, so it can't overflow.
+    uint16_t depth;
     // Make sure the attributes member is aligned to its largest data type
     alignas(int64_t) uint8_t attributes[];
 } FsearchDatabaseEntry;
@@ -54,7 +61,6 @@ void
 db_entry_compare_context_free(FsearchDatabaseEntryCompareContext *ctx) {
     g_return_if_fail(ctx);
 
-    g_clear_pointer(&ctx->file_type_table, g_hash_table_unref);
     g_clear_pointer(&ctx->entry_to_file_type_table, g_hash_table_unref);
     g_clear_pointer(&ctx, free);
 }
@@ -64,7 +70,6 @@ db_entry_compare_context_new(FsearchDatabaseSortOrderChain chain) {
     FsearchDatabaseEntryCompareContext *ctx = calloc(1, sizeof(FsearchDatabaseEntryCompareContext));
     g_assert(ctx);
 
-    ctx->file_type_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
     ctx->entry_to_file_type_table = g_hash_table_new(NULL, NULL);
     ctx->chain = chain;
     return ctx;
@@ -90,6 +95,16 @@ db_entry_is_sibling(FsearchDatabaseEntry *entry, FsearchDatabaseEntry *maybe_sib
 
 bool
 db_entry_is_descendant(FsearchDatabaseEntry *entry, FsearchDatabaseEntry *maybe_ancestor) {
+    if (entry && maybe_ancestor) {
+        // Only the ancestor of `entry` at the same depth can be `maybe_ancestor`
+        if (entry->depth <= maybe_ancestor->depth) {
+            return false;
+        }
+        for (uint32_t i = entry->depth - maybe_ancestor->depth; i > 0; --i) {
+            entry = entry->parent;
+        }
+        return entry == maybe_ancestor;
+    }
     while (entry) {
         if (entry->parent == maybe_ancestor) {
             return true;
@@ -185,6 +200,36 @@ db_entry_get_size(FsearchDatabaseEntry *entry) {
     return size;
 }
 
+uint64_t
+db_entry_get_numeric_sort_key(FsearchDatabaseEntry *entry, FsearchDatabaseIndexProperty property) {
+    switch (property) {
+    case DATABASE_INDEX_PROPERTY_NUM_FILES:
+    case DATABASE_INDEX_PROPERTY_NUM_FOLDERS: {
+        uint32_t count = 0;
+        db_entry_get_attribute(entry, property, &count, sizeof(count));
+        return count;
+    }
+    case DATABASE_INDEX_PROPERTY_SIZE:
+    case DATABASE_INDEX_PROPERTY_MODIFICATION_TIME:
+    case DATABASE_INDEX_PROPERTY_ACCESS_TIME:
+    case DATABASE_INDEX_PROPERTY_STATUS_CHANGE_TIME: {
+        int64_t value = 0;
+        db_entry_get_attribute(entry, property, &value, sizeof(value));
+        // Flipping the sign bit moves negative values in front of the positive ones
+        return (uint64_t)value ^ ((uint64_t)1 << 63);
+    }
+    default:
+        return 0;
+    }
+}
+
+GQuark
+db_entry_get_content_type(FsearchDatabaseEntry *entry) {
+    uint32_t content_type = 0;
+    db_entry_get_attribute(entry, DATABASE_INDEX_PROPERTY_FILETYPE, &content_type, sizeof(content_type));
+    return content_type;
+}
+
 const char *
 db_entry_get_extension(FsearchDatabaseEntry *entry) {
     if (G_UNLIKELY(!entry)) {
@@ -242,17 +287,35 @@ db_entry_get_type(FsearchDatabaseEntry *entry) {
     return DATABASE_ENTRY_TYPE_NONE;
 }
 
+static void
+entry_free_memory(FsearchDatabaseEntry *entry) {
+    if (entry->flags & FSEARCH_DATABASE_ENTRY_FLAG_ARENA) {
+        fsearch_database_entry_arena_release(entry);
+    }
+    else {
+        free(entry);
+    }
+}
+
 void
 db_entry_free_no_unparent(FsearchDatabaseEntry *entry) {
     g_return_if_fail(entry);
-    g_clear_pointer(&entry, free);
+    g_clear_pointer(&entry, entry_free_memory);
+}
+
+void
+db_entry_free_outside_arena(FsearchDatabaseEntry *entry) {
+    g_return_if_fail(entry);
+    if (!(entry->flags & FSEARCH_DATABASE_ENTRY_FLAG_ARENA)) {
+        g_clear_pointer(&entry, free);
+    }
 }
 
 void
 db_entry_free(FsearchDatabaseEntry *entry) {
     g_return_if_fail(entry);
     db_entry_set_parent(entry, NULL);
-    g_clear_pointer(&entry, free);
+    g_clear_pointer(&entry, entry_free_memory);
 }
 
 void
@@ -273,15 +336,16 @@ db_entry_get_deep_copy(FsearchDatabaseEntry *entry) {
     g_assert_nonnull(copy);
 
     memcpy(copy, entry, entry_size);
+    // The copy is a standalone allocation, no matter where the original lives
+    copy->flags &= ~FSEARCH_DATABASE_ENTRY_FLAG_ARENA;
 
     copy->parent = entry->parent ? db_entry_get_deep_copy(entry->parent) : NULL;
     return copy;
 }
 
-void
-db_entry_append_content_type(FsearchDatabaseEntry *entry, GString *str) {
-    g_autoptr(GString) path = db_entry_get_path_full(entry);
-    g_autoptr(GFile) file = g_file_new_for_path(path->str);
+GQuark
+db_entry_query_content_type(const char *path) {
+    g_autoptr(GFile) file = g_file_new_for_path(path);
     g_autoptr(GError) error = NULL;
     g_autoptr(GFileInfo) info = g_file_query_info(file,
                                                   G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
@@ -292,7 +356,25 @@ db_entry_append_content_type(FsearchDatabaseEntry *entry, GString *str) {
     if (info) {
         content_type = g_file_info_get_content_type(info);
     }
-    g_string_append(str, content_type ? content_type : "unknown");
+    return g_quark_from_string(content_type ? content_type : "unknown");
+}
+
+// Searches for content types only run on multiple threads when they're indexed. Entries whose content type isn't known
+// yet are then still looked up one at a time.
+static GMutex content_type_query_lock;
+
+void
+db_entry_append_content_type(FsearchDatabaseEntry *entry, GString *str) {
+    GQuark content_type = db_entry_get_content_type(entry);
+    if (content_type == 0) {
+        g_autoptr(GString) path = db_entry_get_path_full(entry);
+        g_mutex_lock(&content_type_query_lock);
+        content_type = db_entry_query_content_type(path->str);
+        g_mutex_unlock(&content_type_query_lock);
+        // Remember it, if the entry has room for it, so the next search doesn't have to access the file system again
+        db_entry_set_content_type(entry, content_type);
+    }
+    g_string_append(str, g_quark_to_string(content_type));
 }
 
 uint8_t
@@ -319,12 +401,46 @@ db_entry_get_attribute_flags(FsearchDatabaseEntry *entry) {
 
 uint32_t
 db_entry_get_depth(FsearchDatabaseEntry *entry) {
+    return entry ? entry->depth : 0;
+}
+
+void
+db_entry_update_depth(FsearchDatabaseEntry *entry) {
+    g_return_if_fail(entry);
     uint32_t depth = 0;
-    while (entry && entry->parent) {
-        entry = entry->parent;
+    for (FsearchDatabaseEntry *parent = entry->parent; parent; parent = parent->parent) {
         depth++;
     }
-    return depth;
+    entry->depth = depth;
+}
+
+static inline size_t
+entry_get_path_rank_offset(uint32_t attribute_flags) {
+    // The rank is stored right in front of the name
+    size_t offset = 0;
+    db_entry_get_attribute_offset(attribute_flags & ~DATABASE_ENTRY_ATTRIBUTE_FLAG_PATH_RANK,
+                                  DATABASE_INDEX_PROPERTY_NAME,
+                                  &offset);
+    return offset;
+}
+
+uint32_t
+db_entry_get_path_rank(FsearchDatabaseEntry *entry) {
+    if (G_UNLIKELY(!entry) || !(entry->attribute_flags & DATABASE_ENTRY_ATTRIBUTE_FLAG_PATH_RANK)) {
+        return 0;
+    }
+    uint32_t rank = 0;
+    memcpy(&rank, entry->attributes + entry_get_path_rank_offset(entry->attribute_flags), sizeof(rank));
+    return rank;
+}
+
+void
+db_entry_set_path_rank(FsearchDatabaseEntry *entry, uint32_t rank) {
+    g_return_if_fail(entry);
+    if (!(entry->attribute_flags & DATABASE_ENTRY_ATTRIBUTE_FLAG_PATH_RANK)) {
+        return;
+    }
+    memcpy(entry->attributes + entry_get_path_rank_offset(entry->attribute_flags), &rank, sizeof(rank));
 }
 
 static FsearchDatabaseEntry *
@@ -336,20 +452,48 @@ db_entry_get_parent_nth(FsearchDatabaseEntry *entry, uint32_t nth) {
     return entry;
 }
 
-static void
-sort_entry_by_path_recursive(FsearchDatabaseEntry *entry_1, FsearchDatabaseEntry *entry_2, size_t name_offset, int *res) {
-    if (G_UNLIKELY(!entry_1 || !entry_2)) {
-        return;
+// Compares the full paths of two distinct folders of the same depth
+static int
+compare_folders_of_same_depth(FsearchDatabaseEntry *a, FsearchDatabaseEntry *b) {
+    while (a->parent != b->parent) {
+        // Neither folder is an ancestor of the other, so their ranks are all it takes
+        const uint32_t rank_a = db_entry_get_path_rank(a);
+        const uint32_t rank_b = db_entry_get_path_rank(b);
+        if (rank_a && rank_b) {
+            return rank_a < rank_b ? -1 : 1;
+        }
+        a = a->parent;
+        b = b->parent;
+    }
+    // `a` and `b` are the first path elements which differ
+    return db_entry_compare_entries_by_name(&a, &b);
+}
+
+// Compares the full paths of two folders, NULL stands for the empty path of a root's parent
+static int
+compare_folders_by_full_path(FsearchDatabaseEntry *a, FsearchDatabaseEntry *b) {
+    if (a == b) {
+        return 0;
     }
-    if (entry_1->parent) {
-        sort_entry_by_path_recursive(entry_1->parent, entry_2->parent, name_offset, res);
+    if (!a || !b) {
+        return a ? 1 : -1;
     }
-    if (*res != 0) {
-        return;
+    const uint32_t rank_a = db_entry_get_path_rank(a);
+    const uint32_t rank_b = db_entry_get_path_rank(b);
+    if (rank_a && rank_b) {
+        return rank_a < rank_b ? -1 : 1;
+    }
+
+    if (a->depth > b->depth) {
+        FsearchDatabaseEntry *ancestor_a = db_entry_get_parent_nth(a, a->depth - b->depth);
+        // If `b` is an ancestor of `a`, the shorter path comes first
+        return ancestor_a == b ? 1 : compare_folders_of_same_depth(ancestor_a, b);
     }
-    const char *name_1 = db_entry_get_attribute_name_for_offset(entry_1, name_offset);
-    const char *name_2 = db_entry_get_attribute_name_for_offset(entry_2, name_offset);
-    *res = fsearch_file_utils_cmp_paths(name_1, name_2);
+    else if (a->depth < b->depth) {
+        FsearchDatabaseEntry *ancestor_b = db_entry_get_parent_nth(b, b->depth - a->depth);
+        return ancestor_b == a ? -1 : compare_folders_of_same_depth(a, ancestor_b);
+    }
+    return compare_folders_of_same_depth(a, b);
 }
 
 int
@@ -365,22 +509,47 @@ db_entry_compare_entries_by_size(FsearchDatabaseEntry **a, FsearchDatabaseEntry
     return 0;
 }
 
+// Descriptions of all content types which were sorted by so far. There are only a few hundred content types and
+// looking up their description is expensive, so they're shared by all sorts and kept around.
+static GMutex content_type_descriptions_lock;
+static GHashTable *content_type_descriptions;
+
+static const char *
+get_content_type_description(GQuark content_type) {
+    g_mutex_lock(&content_type_descriptions_lock);
+    if (!content_type_descriptions) {
+        content_type_descriptions = g_hash_table_new(NULL, NULL);
+    }
+    const char *description = g_hash_table_lookup(content_type_descriptions, GUINT_TO_POINTER(content_type));
+    if (!description) {
+        g_autofree char *d = content_type ? g_content_type_get_description(g_quark_to_string(content_type)) : NULL;
+        description = g_intern_string(d ? d : "Unknown Type");
+        g_hash_table_insert(content_type_descriptions, GUINT_TO_POINTER(content_type), (gpointer)description);
+    }
+    g_mutex_unlock(&content_type_descriptions_lock);
+    return description;
+}
+
 static const char *
-get_file_type(FsearchDatabaseEntry *entry, GHashTable *file_type_table, GHashTable *entry_table) {
-    char *cached_type = g_hash_table_lookup(entry_table, entry);
+get_file_type(FsearchDatabaseEntry *entry, GHashTable *entry_table) {
+    if (db_entry_is_folder(entry)) {
+        return "Folder";
+    }
+    // Entries with an indexed content type don't need to be guessed (and cached) again for every sort
+    const GQuark content_type = db_entry_get_content_type(entry);
+    if (content_type != 0) {
+        return get_content_type_description(content_type);
+    }
+
+    const char *cached_type = g_hash_table_lookup(entry_table, entry);
     if (cached_type) {
         return cached_type;
     }
 
     const char *name = db_entry_get_name_raw_for_display(entry);
-    g_autofree char *type = fsearch_file_utils_get_file_type_non_localized(name,
-                                                                           db_entry_is_folder(entry) ? TRUE : FALSE);
-    cached_type = g_hash_table_lookup(file_type_table, type);
-    if (!cached_type) {
-        g_hash_table_add(file_type_table, type);
-        cached_type = g_steal_pointer(&type);
-    }
-    g_hash_table_insert(entry_table, entry, cached_type);
+    g_autofree char *guessed_type = name ? g_content_type_guess(name, NULL, 0, NULL) : NULL;
+    cached_type = get_content_type_description(guessed_type ? g_quark_from_string(guessed_type) : 0);
+    g_hash_table_insert(entry_table, entry, (gpointer)cached_type);
     return cached_type;
 }
 
@@ -388,8 +557,8 @@ int
 db_entry_compare_entries_by_type(FsearchDatabaseEntry **a, FsearchDatabaseEntry **b, gpointer data) {
     FsearchDatabaseEntryCompareContext *comp_ctx = data;
 
-    const char *file_type_a = get_file_type(*a, comp_ctx->file_type_table, comp_ctx->entry_to_file_type_table);
-    const char *file_type_b = get_file_type(*b, comp_ctx->file_type_table, comp_ctx->entry_to_file_type_table);
+    const char *file_type_a = get_file_type(*a, comp_ctx->entry_to_file_type_table);
+    const char *file_type_b = get_file_type(*b, comp_ctx->entry_to_file_type_table);
 
     return strcmp(file_type_a, file_type_b);
 }
@@ -414,6 +583,14 @@ compare_entries_by_property(FsearchDatabaseEntry **a,
         return db_entry_compare_entries_by_modification_time(a, b);
     case DATABASE_INDEX_PROPERTY_FILETYPE:
         return db_entry_compare_entries_by_type(a, b, ctx);
+    case DATABASE_INDEX_PROPERTY_ACCESS_TIME:
+    case DATABASE_INDEX_PROPERTY_STATUS_CHANGE_TIME:
+    case DATABASE_INDEX_PROPERTY_NUM_FILES:
+    case DATABASE_INDEX_PROPERTY_NUM_FOLDERS: {
+        const uint64_t key_a = db_entry_get_numeric_sort_key(*a, property);
+        const uint64_t key_b = db_entry_get_numeric_sort_key(*b, property);
+        return key_a < key_b ? -1 : key_a > key_b ? 1 : 0;
+    }
     default:
         return 0;
     }
@@ -451,110 +628,47 @@ db_entry_compare_entries_by_position(FsearchDatabaseEntry **a, FsearchDatabaseEn
 
 int
 db_entry_compare_entries_by_full_path(FsearchDatabaseEntry **a, FsearchDatabaseEntry **b) {
-    if (db_entry_is_sibling(*a, *b)) {
-        // same parent hence same path -> sort by name
-        return db_entry_compare_entries_by_name(a, b);
-    }
     FsearchDatabaseEntry *entry_a = *a;
     FsearchDatabaseEntry *entry_b = *b;
-    const uint32_t a_n_path_elements = db_entry_get_depth(entry_a) + 1;
-    const uint32_t b_n_path_elements = db_entry_get_depth(entry_b) + 1;
-
-    const char *a_path[a_n_path_elements];
-    const char *b_path[b_n_path_elements];
-    FsearchDatabaseEntry *tmp = (FsearchDatabaseEntry *)entry_a;
-    for (uint32_t i = 0; i < a_n_path_elements; i++) {
-        a_path[a_n_path_elements - i - 1] = db_entry_get_name_raw(tmp);
-        tmp = tmp->parent;
+    if (entry_a->parent == entry_b->parent) {
+        // same parent hence same path -> sort by name
+        return db_entry_compare_entries_by_name(a, b);
     }
-    tmp = (FsearchDatabaseEntry *)entry_b;
-    for (uint32_t i = 0; i < b_n_path_elements; i++) {
-        b_path[b_n_path_elements - i - 1] = db_entry_get_name_raw(tmp);
-        tmp = tmp->parent;
+    if (db_entry_is_folder(entry_a) && db_entry_is_folder(entry_b)) {
+        return compare_folders_by_full_path(entry_a, entry_b);
     }
 
-    const uint32_t limit = MIN(a_n_path_elements, b_n_path_elements);
-    for (uint32_t i = 0; i < limit; ++i) {
-        const int res = fsearch_file_utils_cmp_paths(a_path[i], b_path[i]);
-        if (res != 0) {
-            return res;
+    // Bring both entries to the same depth. If one of them is an ancestor of the other, the shorter path comes first.
+    if (entry_a->depth > entry_b->depth) {
+        entry_a = db_entry_get_parent_nth(entry_a, entry_a->depth - entry_b->depth);
+        if (entry_a == entry_b) {
+            return 1;
         }
     }
-    if (a_n_path_elements < b_n_path_elements) {
-        return -1;
-    }
-    else if (a_n_path_elements > b_n_path_elements) {
-        return 1;
+    else if (entry_a->depth < entry_b->depth) {
+        entry_b = db_entry_get_parent_nth(entry_b, entry_b->depth - entry_a->depth);
+        if (entry_a == entry_b) {
+            return -1;
+        }
     }
-    else {
-        return 0;
+    if (entry_a->parent == entry_b->parent) {
+        return db_entry_compare_entries_by_name(&entry_a, &entry_b);
     }
+    // The paths differ before the last element, which is decided by the parents alone
+    return compare_folders_by_full_path(entry_a->parent, entry_b->parent);
 }
 
 int
 db_entry_compare_entries_by_path(FsearchDatabaseEntry **a, FsearchDatabaseEntry **b) {
-    FsearchDatabaseEntry *entry_a = *a;
-    FsearchDatabaseEntry *entry_b = *b;
-    const uint32_t a_depth = db_entry_get_depth(entry_a);
-    const uint32_t b_depth = db_entry_get_depth(entry_b);
-
-#if (0)
-    const char *a_path[a_depth];
-    const char *b_path[b_depth];
-    FsearchDatabaseEntry *tmp = (FsearchDatabaseEntry *)entry_a->parent;
-    for (uint32_t i = 0; i < a_depth; i++) {
-        a_path[a_depth - i - 1] = tmp->name;
-        tmp = (FsearchDatabaseEntry *)tmp->parent;
-    }
-    tmp = (FsearchDatabaseEntry *)entry_b->parent;
-    for (uint32_t i = 0; i < b_depth; i++) {
-        b_path[b_depth - i - 1] = tmp->name;
-        tmp = (FsearchDatabaseEntry *)tmp->parent;
-    }
-
-    const uint32_t limit = MIN(a_depth, b_depth);
-    for (uint32_t i = 0; i < limit; ++i) {
-        const int res = fsearch_file_utils_cmp_paths(a_path[i], b_path[i]);
-        if (res != 0) {
-            return res;
-        }
-    }
-    if (a_depth < b_depth) {
-        return -1;
-    }
-    else if (a_depth > b_depth) {
-        return 1;
-    }
-    else {
-        return db_entry_compare_entries_by_name(a, b);
-    }
-#endif
-
-    size_t name_offset = 0;
-    FsearchDatabaseEntry *folder_ref = entry_a->parent ? entry_a->parent : entry_b->parent;
-    const uint32_t folder_flags = folder_ref ? folder_ref->attribute_flags
-                                             : (entry_a->attribute_flags | DATABASE_INDEX_PROPERTY_FLAG_FOLDER_DEFAULTS);
-    if (!db_entry_get_attribute_offset(folder_flags, DATABASE_INDEX_PROPERTY_NAME, &name_offset)) {
-        return 0;
-    }
+    return compare_folders_by_full_path((*a)->parent, (*b)->parent);
+}
 
-    int res = 0;
-    if (a_depth == b_depth) {
-        sort_entry_by_path_recursive(entry_a->parent, entry_b->parent, name_offset, &res);
-        return res;
-    }
-    else if (a_depth > b_depth) {
-        const uint32_t diff = a_depth - b_depth;
-        FsearchDatabaseEntry *parent_a = db_entry_get_parent_nth(entry_a->parent, diff);
-        sort_entry_by_path_recursive(parent_a, entry_b->parent, name_offset, &res);
-        return res == 0 ? 1 : res;
-    }
-    else {
-        const uint32_t diff = b_depth - a_depth;
-        FsearchDatabaseEntry *parent_b = db_entry_get_parent_nth(entry_b->parent, diff);
-        sort_entry_by_path_recursive(entry_a->parent, parent_b, name_offset, &res);
-        return res == 0 ? -1 : res;
-    }
+int
+db_entry_compare_path_with_folder(FsearchDatabaseEntry *entry, FsearchDatabaseEntry *folder) {
+    g_assert(entry);
+    g_assert(folder);
+    // Same as db_entry_compare_entries_by_path with a child of `folder` on the right side
+    return compare_folders_by_full_path(entry->parent, folder);
 }
 
 static void
@@ -603,6 +717,12 @@ db_entry_set_mtime(FsearchDatabaseEntry *entry, time_t mtime) {
     db_entry_set_attribute(entry, DATABASE_INDEX_PROPERTY_MODIFICATION_TIME, &mtime, sizeof(mtime));
 }
 
+void
+db_entry_set_content_type(FsearchDatabaseEntry *entry, GQuark content_type) {
+    uint32_t val = content_type;
+    db_entry_set_attribute(entry, DATABASE_INDEX_PROPERTY_FILETYPE, &val, sizeof(val));
+}
+
 void
 db_entry_set_size(FsearchDatabaseEntry *entry, off_t size) {
     off_t old_size = 0;
@@ -677,6 +797,12 @@ db_entry_set_parent_no_update(FsearchDatabaseEntry *entry, FsearchDatabaseEntry
     entry->parent = parent;
 }
 
+static inline void
+entry_set_parent_and_depth(FsearchDatabaseEntry *entry, FsearchDatabaseEntry *parent) {
+    entry->parent = parent;
+    entry->depth = parent ? parent->depth + 1 : 0;
+}
+
 void
 db_entry_increment_childcount(FsearchDatabaseEntry *entry, FsearchDatabaseEntryType type) {
     if (!entry) {
@@ -716,7 +842,7 @@ db_entry_set_parent_update_childcount(FsearchDatabaseEntry *entry, FsearchDataba
             increment_num_files(parent);
         }
     }
-    entry->parent = parent;
+    entry_set_parent_and_depth(entry, parent);
 }
 
 void
@@ -751,7 +877,7 @@ db_entry_set_parent(FsearchDatabaseEntry *entry, FsearchDatabaseEntry *parent) {
         db_entry_get_attribute(entry, DATABASE_INDEX_PROPERTY_SIZE, &size, sizeof(size));
         db_entry_update_folder_size(parent, size);
     }
-    entry->parent = parent;
+    entry_set_parent_and_depth(entry, parent);
 }
 
 bool
@@ -798,6 +924,15 @@ db_entry_get_attribute_offset(FsearchDatabaseIndexPropertyFlags attribute_flags,
         }
         offset_tmp += sizeof(int32_t);
     }
+    if ((attribute_flags & DATABASE_INDEX_PROPERTY_FLAG_FILETYPE) != 0) {
+        if (attribute == DATABASE_INDEX_PROPERTY_FILETYPE) {
+            goto out;
+        }
+        offset_tmp += sizeof(uint32_t);
+    }
+    if ((attribute_flags & DATABASE_ENTRY_ATTRIBUTE_FLAG_PATH_RANK) != 0) {
+        offset_tmp += sizeof(uint32_t);
+    }
     if (attribute == DATABASE_INDEX_PROPERTY_NAME) {
         goto out;
     }
@@ -846,21 +981,35 @@ entry_get_size_for_flags(FsearchDatabaseIndexPropertyFlags attribute_flags, cons
     if ((attribute_flags & DATABASE_INDEX_PROPERTY_FLAG_NUM_FOLDERS) != 0) {
         size += sizeof(int32_t);
     }
+    if ((attribute_flags & DATABASE_INDEX_PROPERTY_FLAG_FILETYPE) != 0) {
+        size += sizeof(uint32_t);
+    }
+    if ((attribute_flags & DATABASE_ENTRY_ATTRIBUTE_FLAG_PATH_RANK) != 0) {
+        size += sizeof(uint32_t);
+    }
     return size;
 }
 
 FsearchDatabaseEntry *
-db_entry_new(FsearchDatabaseIndexPropertyFlags attribute_flags,
-             const char *name,
-             FsearchDatabaseEntry *parent,
-             FsearchDatabaseEntryType type) {
+db_entry_new_in_arena(FsearchDatabaseEntryArena *arena,
+                      FsearchDatabaseIndexPropertyFlags attribute_flags,
+                      const char *name,
+                      FsearchDatabaseEntry *parent,
+                      FsearchDatabaseEntryType type) {
     if (type == DATABASE_ENTRY_TYPE_FOLDER) {
         attribute_flags = attribute_flags | DATABASE_INDEX_PROPERTY_FLAG_FOLDER_DEFAULTS;
     }
     const size_t name_len = name ? strlen(name) : 0;
     const size_t entry_size = entry_get_size_for_flags(attribute_flags, name, name_len);
-    FsearchDatabaseEntry *entry = calloc(1, entry_size);
-    g_assert_nonnull(entry);
+    FsearchDatabaseEntry *entry = arena ? fsearch_database_entry_arena_alloc(arena, entry_size) : NULL;
+    if (entry) {
+        entry->flags |= FSEARCH_DATABASE_ENTRY_FLAG_ARENA;
+    }
+    else {
+        // No arena, or the entry is too large for it
+        entry = calloc(1, entry_size);
+        g_assert_nonnull(entry);
+    }
 
     if (type == DATABASE_ENTRY_TYPE_FOLDER) {
         entry->flags |= FSEARCH_DATABASE_ENTRY_FLAG_TYPE_FOLDER;
@@ -878,6 +1027,9 @@ db_entry_new(FsearchDatabaseIndexPropertyFlags attribute_flags,
     if (db_entry_get_attribute_offset(attribute_flags, DATABASE_INDEX_PROPERTY_NAME, &name_offset)) {
         memcpy(entry->attributes + name_offset, name, name_len + 1);
     }
+    if (!name || g_str_is_ascii(name)) {
+        entry->flags |= FSEARCH_DATABASE_ENTRY_FLAG_NAME_ASCII;
+    }
 
     if (parent) {
         // set parent must happen after entry->type was set, so best set it at the end
@@ -886,6 +1038,14 @@ db_entry_new(FsearchDatabaseIndexPropertyFlags attribute_flags,
     return entry;
 }
 
+FsearchDatabaseEntry *
+db_entry_new(FsearchDatabaseIndexPropertyFlags attribute_flags,
+             const char *name,
+             FsearchDatabaseEntry *parent,
+             FsearchDatabaseEntryType type) {
+    return db_entry_new_in_arena(NULL, attribute_flags, name, parent, type);
+}
+
 FsearchDatabaseEntry *
 db_entry_get_dummy_for_name_and_parent(FsearchDatabaseEntry *parent, const char *name, FsearchDatabaseEntryType type) {
     g_return_val_if_fail(name, NULL);
@@ -893,25 +1053,24 @@ db_entry_get_dummy_for_name_and_parent(FsearchDatabaseEntry *parent, const char
     FsearchDatabaseEntry *entry = db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE, name, NULL, type);
 
     // Don't update parent state (we don't want the parent to change its size or child counts)
-    db_entry_set_parent_no_update(entry, parent);
+    entry_set_parent_and_depth(entry, parent);
     return entry;
 }
 
-FsearchDatabaseEntry *
-db_entry_new_with_attributes(FsearchDatabaseIndexPropertyFlags attribute_flags,
-                             const char *name,
-                             FsearchDatabaseEntry *parent,
-                             FsearchDatabaseEntryType type,
-                             ...) {
-    va_list args;
-    va_start(args, type);
-
+static FsearchDatabaseEntry *
+entry_new_with_attributes_valist(FsearchDatabaseEntryArena *arena,
+                                 FsearchDatabaseIndexPropertyFlags attribute_flags,
+                                 const char *name,
+                                 FsearchDatabaseEntry *parent,
+                                 FsearchDatabaseEntryType type,
+                                 va_list args) {
     // Set Parent to NULL. We will set the parent anyway after setting all the attributes
-    FsearchDatabaseEntry *entry = db_entry_new(attribute_flags, name, NULL, type);
+    FsearchDatabaseEntry *entry = db_entry_new_in_arena(arena, attribute_flags, name, NULL, type);
 
     FsearchDatabaseIndexProperty attribute = va_arg(args, int);
     while (attribute != DATABASE_INDEX_PROPERTY_NONE) {
         int32_t attribute_val_i32 = 0;
+        uint32_t attribute_val_u32 = 0;
         int64_t attribute_val_i64 = 0;
         switch (attribute) {
         case DATABASE_INDEX_PROPERTY_SIZE:
@@ -927,11 +1086,14 @@ db_entry_new_with_attributes(FsearchDatabaseIndexPropertyFlags attribute_flags,
             attribute_val_i32 = va_arg(args, int32_t);
             db_entry_set_attribute(entry, attribute, &attribute_val_i32, sizeof(int32_t));
             break;
+        case DATABASE_INDEX_PROPERTY_FILETYPE:
+            attribute_val_u32 = va_arg(args, uint32_t);
+            db_entry_set_attribute(entry, attribute, &attribute_val_u32, sizeof(uint32_t));
+            break;
         case DATABASE_INDEX_PROPERTY_NONE:
         case DATABASE_INDEX_PROPERTY_NAME:
         case DATABASE_INDEX_PROPERTY_PATH:
         case DATABASE_INDEX_PROPERTY_PATH_FULL:
-        case DATABASE_INDEX_PROPERTY_FILETYPE:
         case DATABASE_INDEX_PROPERTY_EXTENSION:
         case NUM_DATABASE_INDEX_PROPERTIES:
             g_assert_not_reached();
@@ -939,8 +1101,6 @@ db_entry_new_with_attributes(FsearchDatabaseIndexPropertyFlags attribute_flags,
         attribute = va_arg(args, int);
     }
 
-    va_end(args);
-
     // Set parent at the end after all properties have ben set. This ensures that the entry has the correct size
     // and the parent entry size is updated properly
     if (parent) {
@@ -950,6 +1110,35 @@ db_entry_new_with_attributes(FsearchDatabaseIndexPropertyFlags attribute_flags,
     return entry;
 }
 
+FsearchDatabaseEntry *
+db_entry_new_with_attributes(FsearchDatabaseIndexPropertyFlags attribute_flags,
+                             const char *name,
+                             FsearchDatabaseEntry *parent,
+                             FsearchDatabaseEntryType type,
+                             ...) {
+    va_list args;
+    va_start(args, type);
+    FsearchDatabaseEntry *entry = entry_new_with_attributes_valist(NULL, attribute_flags, name, parent, type, args);
+    va_end(args);
+
+    return entry;
+}
+
+FsearchDatabaseEntry *
+db_entry_new_with_attributes_in_arena(FsearchDatabaseEntryArena *arena,
+                                      FsearchDatabaseIndexPropertyFlags attribute_flags,
+                                      const char *name,
+                                      FsearchDatabaseEntry *parent,
+                                      FsearchDatabaseEntryType type,
+                                      ...) {
+    va_list args;
+    va_start(args, type);
+    FsearchDatabaseEntry *entry = entry_new_with_attributes_valist(arena, attribute_flags, name, parent, type, args);
+    va_end(args);
+
+    return entry;
+}
+
 bool
 db_entry_get_attribute_name(FsearchDatabaseEntry *entry, const char **name) {
     g_return_val_if_fail(entry, false);
@@ -1011,6 +1200,23 @@ db_entry_get_flags(FsearchDatabaseEntry *entry) {
     return entry->flags;
 }
 
+bool
+db_entry_name_is_ascii(FsearchDatabaseEntry *entry) {
+    g_return_val_if_fail(entry, false);
+    return (entry->flags & FSEARCH_DATABASE_ENTRY_FLAG_NAME_ASCII) != 0;
+}
+
+bool
+db_entry_path_is_ascii(FsearchDatabaseEntry *entry) {
+    g_return_val_if_fail(entry, false);
+    for (FsearchDatabaseEntry *e = entry->parent; e; e = e->parent) {
+        if (!(e->flags & FSEARCH_DATABASE_ENTRY_FLAG_NAME_ASCII)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void
 db_entry_set_unmonitored_fanotify(FsearchDatabaseEntry *entry) {
     g_return_if_fail(entry);
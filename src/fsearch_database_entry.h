@@ -5,6 +5,7 @@
 #include <stdint.h>
 
 #include "fsearch_array.h"
+#include "fsearch_database_entry_arena.h"
 #include "fsearch_database_entry_flags.h"
 #include "fsearch_database_index_properties.h"
 
@@ -18,7 +19,6 @@ typedef enum {
 typedef struct FsearchDatabaseEntry FsearchDatabaseEntry;
 
 typedef struct FsearchDatabaseEntryCompareContext {
-    GHashTable *file_type_table;
     GHashTable *entry_to_file_type_table;
     FsearchDatabaseSortOrderChain chain;
 } FsearchDatabaseEntryCompareContext;
@@ -58,15 +58,24 @@ db_entry_set_mtime(FsearchDatabaseEntry *entry, time_t mtime);
 void
 db_entry_set_size(FsearchDatabaseEntry *entry, off_t size);
 
+// Content types are only stored in entries which have the FILETYPE attribute, 0 means it's not known yet
+void
+db_entry_set_content_type(FsearchDatabaseEntry *entry, GQuark content_type);
+
 void
 db_entry_set_mark(FsearchDatabaseEntry *entry, uint8_t mark);
 
 void
 db_entry_set_name(FsearchDatabaseEntry *entry, const char *name);
 
+// Only sets the parent pointer: neither the parent's state nor the depth of `entry` get updated
 void
 db_entry_set_parent_no_update(FsearchDatabaseEntry *entry, FsearchDatabaseEntry *parent);
 
+// Recomputes the depth of `entry` from its ancestors, e.g. after db_entry_set_parent_no_update()
+void
+db_entry_update_depth(FsearchDatabaseEntry *entry);
+
 void
 db_entry_increment_childcount(FsearchDatabaseEntry *entry, FsearchDatabaseEntryType type);
 
@@ -88,6 +97,14 @@ db_entry_get_idx(FsearchDatabaseEntry *entry);
 uint32_t
 db_entry_get_depth(FsearchDatabaseEntry *entry);
 
+// Folders can be given a rank in the order of their full paths, which turns most path comparisons into a single integer
+// comparison. 0 means unranked; ranks are only comparable when they were assigned together.
+uint32_t
+db_entry_get_path_rank(FsearchDatabaseEntry *entry);
+
+void
+db_entry_set_path_rank(FsearchDatabaseEntry *entry, uint32_t rank);
+
 GString *
 db_entry_get_path(FsearchDatabaseEntry *entry);
 
@@ -109,6 +126,14 @@ db_entry_get_mtime(FsearchDatabaseEntry *entry);
 off_t
 db_entry_get_size(FsearchDatabaseEntry *entry);
 
+// Returns the value of the numeric `property` (size, a time or a child count) of `entry` as an unsigned key which
+// orders the same way as the value itself. Entries which don't store `property` get the key of the value 0.
+uint64_t
+db_entry_get_numeric_sort_key(FsearchDatabaseEntry *entry, FsearchDatabaseIndexProperty property);
+
+GQuark
+db_entry_get_content_type(FsearchDatabaseEntry *entry);
+
 const char *
 db_entry_get_extension(FsearchDatabaseEntry *entry);
 
@@ -130,6 +155,11 @@ db_entry_get_type(FsearchDatabaseEntry *entry);
 void
 db_entry_free_no_unparent(FsearchDatabaseEntry *entry);
 
+// Frees `entry` without unparenting it, but only if it wasn't allocated from an arena. Meant for dropping all entries
+// of an arena which is about to be freed as a whole.
+void
+db_entry_free_outside_arena(FsearchDatabaseEntry *entry);
+
 void
 db_entry_free(FsearchDatabaseEntry *entry);
 
@@ -145,6 +175,10 @@ db_entry_get_dummy_for_name_and_parent(FsearchDatabaseEntry *parent, const char
 void
 db_entry_append_content_type(FsearchDatabaseEntry *entry, GString *str);
 
+// Accesses the file system, so it's best called without holding any lock
+GQuark
+db_entry_query_content_type(const char *path);
+
 int
 db_entry_compare_entries_by_extension(FsearchDatabaseEntry **a, FsearchDatabaseEntry **b);
 
@@ -163,6 +197,12 @@ db_entry_compare_entries_by_position(FsearchDatabaseEntry **a, FsearchDatabaseEn
 int
 db_entry_compare_entries_by_path(FsearchDatabaseEntry **a, FsearchDatabaseEntry **b);
 
+// Compares the path of `entry` with the full path of `folder`, in the same order as db_entry_compare_entries_by_path.
+// Returns 0 for the children of `folder` and a positive value for all its other descendants, which makes it usable
+// to look up the range of a folder's children in an array sorted by path.
+int
+db_entry_compare_path_with_folder(FsearchDatabaseEntry *entry, FsearchDatabaseEntry *folder);
+
 int
 db_entry_compare_entries_by_full_path(FsearchDatabaseEntry **a, FsearchDatabaseEntry **b);
 
@@ -187,6 +227,22 @@ db_entry_new_with_attributes(FsearchDatabaseIndexPropertyFlags attribute_flags,
                              FsearchDatabaseEntryType type,
                              ...);
 
+// Same as db_entry_new / db_entry_new_with_attributes, but the entry is carved from `arena` when possible
+FsearchDatabaseEntry *
+db_entry_new_in_arena(FsearchDatabaseEntryArena *arena,
+                      FsearchDatabaseIndexPropertyFlags attribute_flags,
+                      const char *name,
+                      FsearchDatabaseEntry *parent,
+                      FsearchDatabaseEntryType type);
+
+FsearchDatabaseEntry *
+db_entry_new_with_attributes_in_arena(FsearchDatabaseEntryArena *arena,
+                                      FsearchDatabaseIndexPropertyFlags attribute_flags,
+                                      const char *name,
+                                      FsearchDatabaseEntry *parent,
+                                      FsearchDatabaseEntryType type,
+                                      ...);
+
 bool
 db_entry_get_attribute_name(FsearchDatabaseEntry *entry, const char **name);
 
@@ -242,4 +298,12 @@ db_entry_is_monitored_inotify(FsearchDatabaseEntry *entry);
 FsearchDatabaseEntryFlags
 db_entry_get_flags(FsearchDatabaseEntry *entry);
 
+// Whether the name of the entry is pure ASCII (determined once when the entry is created)
+bool
+db_entry_name_is_ascii(FsearchDatabaseEntry *entry);
+
+// Whether the names of all ancestors of the entry, i.e. the path it's located in, are pure ASCII
+bool
+db_entry_path_is_ascii(FsearchDatabaseEntry *entry);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(FsearchDatabaseEntry, db_entry_free)
\ No newline at end of file
@@ -0,0 +1,188 @@
+#define G_LOG_DOMAIN "fsearch-database-entry-arena"
+
+#include "fsearch_database_entry_arena.h"
+
+#include <glib.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Slabs are aligned to their size, so the slab (and arena) an entry belongs to can be found from its address alone
+#define SLAB_SIZE (64 * 1024)
+#define SLOT_ALIGNMENT 16
+// Entries hold a single file name (at most NAME_MAX bytes) plus a few attributes, so this covers all of them
+// except root folders with long paths, which fall back to malloc
+#define MAX_SLOT_SIZE 512
+#define NUM_SIZE_CLASSES (MAX_SLOT_SIZE / SLOT_ALIGNMENT)
+
+typedef struct FsearchDatabaseEntrySlab {
+    FsearchDatabaseEntryArena *arena;
+    struct FsearchDatabaseEntrySlab *next;
+    uint32_t size_class;
+} FsearchDatabaseEntrySlab;
+
+#define SLAB_HEADER_SIZE ((sizeof(FsearchDatabaseEntrySlab) + SLOT_ALIGNMENT - 1) & ~((size_t)SLOT_ALIGNMENT - 1))
+
+typedef struct {
+    // Slab new slots get carved from
+    FsearchDatabaseEntrySlab *slabs;
+    uint8_t *slab_pos;
+    uint8_t *slab_end;
+
+    // Released slots, linked through their first bytes
+    void *free_list;
+} FsearchDatabaseEntrySizeClass;
+
+struct FsearchDatabaseEntryArena {
+    FsearchDatabaseEntrySizeClass size_classes[NUM_SIZE_CLASSES];
+
+    size_t num_bytes;
+
+    GMutex mutex;
+
+    volatile gint ref_count;
+};
+
+static inline uint32_t
+size_class_for_size(size_t size) {
+    return (uint32_t)((size + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT) - 1;
+}
+
+static inline size_t
+slot_size_for_size_class(uint32_t size_class) {
+    return (size_t)(size_class + 1) * SLOT_ALIGNMENT;
+}
+
+static void
+arena_free(FsearchDatabaseEntryArena *arena) {
+    g_return_if_fail(arena);
+
+    for (uint32_t i = 0; i < NUM_SIZE_CLASSES; ++i) {
+        FsearchDatabaseEntrySlab *slab = arena->size_classes[i].slabs;
+        while (slab) {
+            FsearchDatabaseEntrySlab *next = slab->next;
+            free(slab);
+            slab = next;
+        }
+    }
+    g_debug("[entry_arena] freed %zu bytes", arena->num_bytes);
+
+    g_mutex_clear(&arena->mutex);
+    g_clear_pointer(&arena, free);
+}
+
+static bool
+size_class_add_slab(FsearchDatabaseEntryArena *arena, uint32_t size_class) {
+    FsearchDatabaseEntrySlab *slab = aligned_alloc(SLAB_SIZE, SLAB_SIZE);
+    if (!slab) {
+        return false;
+    }
+    slab->arena = arena;
+    slab->size_class = size_class;
+
+    FsearchDatabaseEntrySizeClass *sc = &arena->size_classes[size_class];
+    slab->next = sc->slabs;
+    sc->slabs = slab;
+    sc->slab_pos = (uint8_t *)slab + SLAB_HEADER_SIZE;
+    sc->slab_end = (uint8_t *)slab + SLAB_SIZE;
+
+    arena->num_bytes += SLAB_SIZE;
+
+    return true;
+}
+
+FsearchDatabaseEntryArena *
+fsearch_database_entry_arena_new(void) {
+    FsearchDatabaseEntryArena *arena = calloc(1, sizeof(FsearchDatabaseEntryArena));
+    g_assert(arena);
+
+    g_mutex_init(&arena->mutex);
+    arena->ref_count = 1;
+
+    return arena;
+}
+
+FsearchDatabaseEntryArena *
+fsearch_database_entry_arena_ref(FsearchDatabaseEntryArena *arena) {
+    g_return_val_if_fail(arena != NULL, NULL);
+    g_return_val_if_fail(g_atomic_int_get(&arena->ref_count) > 0, NULL);
+
+    g_atomic_int_inc(&arena->ref_count);
+
+    return arena;
+}
+
+void
+fsearch_database_entry_arena_unref(FsearchDatabaseEntryArena *arena) {
+    g_return_if_fail(arena != NULL);
+    g_return_if_fail(g_atomic_int_get(&arena->ref_count) > 0);
+
+    if (g_atomic_int_dec_and_test(&arena->ref_count)) {
+        g_clear_pointer(&arena, arena_free);
+    }
+}
+
+void *
+fsearch_database_entry_arena_alloc(FsearchDatabaseEntryArena *arena, size_t size) {
+    g_return_val_if_fail(arena, NULL);
+
+    if (size == 0 || size > MAX_SLOT_SIZE) {
+        return NULL;
+    }
+
+    const uint32_t size_class = size_class_for_size(size);
+    const size_t slot_size = slot_size_for_size_class(size_class);
+    FsearchDatabaseEntrySizeClass *sc = &arena->size_classes[size_class];
+
+    g_mutex_lock(&arena->mutex);
+
+    void *slot = NULL;
+    if (sc->free_list) {
+        slot = sc->free_list;
+        sc->free_list = *(void **)slot;
+    }
+    else {
+        if ((size_t)(sc->slab_end - sc->slab_pos) < slot_size && !size_class_add_slab(arena, size_class)) {
+            g_mutex_unlock(&arena->mutex);
+            return NULL;
+        }
+        slot = sc->slab_pos;
+        sc->slab_pos += slot_size;
+    }
+
+    g_mutex_unlock(&arena->mutex);
+
+    memset(slot, 0, slot_size);
+    return slot;
+}
+
+void
+fsearch_database_entry_arena_release(void *mem) {
+    g_return_if_fail(mem);
+
+    FsearchDatabaseEntrySlab *slab = (FsearchDatabaseEntrySlab *)((uintptr_t)mem & ~((uintptr_t)SLAB_SIZE - 1));
+    FsearchDatabaseEntryArena *arena = slab->arena;
+    FsearchDatabaseEntrySizeClass *sc = &arena->size_classes[slab->size_class];
+
+    g_mutex_lock(&arena->mutex);
+    *(void **)mem = sc->free_list;
+    sc->free_list = mem;
+    g_mutex_unlock(&arena->mutex);
+}
+
+bool
+fsearch_database_entry_arena_is_exclusive(FsearchDatabaseEntryArena *arena) {
+    g_return_val_if_fail(arena, false);
+    return g_atomic_int_get(&arena->ref_count) == 1;
+}
+
+size_t
+fsearch_database_entry_arena_get_num_bytes(FsearchDatabaseEntryArena *arena) {
+    g_return_val_if_fail(arena, 0);
+
+    g_mutex_lock(&arena->mutex);
+    const size_t num_bytes = arena->num_bytes;
+    g_mutex_unlock(&arena->mutex);
+
+    return num_bytes;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+G_BEGIN_DECLS
+
+// Slab allocator for FsearchDatabaseEntry's. Entries are carved from large slabs, grouped into size
+// classes, so they don't pay for a malloc header each and can all be released at once by dropping the arena.
+typedef struct FsearchDatabaseEntryArena FsearchDatabaseEntryArena;
+
+FsearchDatabaseEntryArena *
+fsearch_database_entry_arena_new(void);
+
+FsearchDatabaseEntryArena *
+fsearch_database_entry_arena_ref(FsearchDatabaseEntryArena *arena);
+
+// Frees all slabs, and with them every entry which was allocated from the arena and not released yet
+void
+fsearch_database_entry_arena_unref(FsearchDatabaseEntryArena *arena);
+
+// Returns zeroed memory of at least `size` bytes, or NULL if `size` is too large to be served by the arena
+void *
+fsearch_database_entry_arena_alloc(FsearchDatabaseEntryArena *arena, size_t size);
+
+// Hands memory returned by fsearch_database_entry_arena_alloc back to the arena it came from
+void
+fsearch_database_entry_arena_release(void *mem);
+
+// Whether the caller holds the only reference, i.e. whether dropping it frees the arena
+bool
+fsearch_database_entry_arena_is_exclusive(FsearchDatabaseEntryArena *arena);
+
+size_t
+fsearch_database_entry_arena_get_num_bytes(FsearchDatabaseEntryArena *arena);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FsearchDatabaseEntryArena, fsearch_database_entry_arena_unref)
+
+G_END_DECLS
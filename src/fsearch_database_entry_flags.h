@@ -7,4 +7,8 @@ typedef enum FsearchDatabaseEntryFlags {
     FSEARCH_DATABASE_ENTRY_FLAG_MONITORED_INOTIFY = 1 << 3,
     FSEARCH_DATABASE_ENTRY_FLAG_MONITORED_FANOTIFY = 1 << 4,
     FSEARCH_DATABASE_ENTRY_FLAG_MONITORED_FAILED = 1 << 5,
+    // Entry memory belongs to a FsearchDatabaseEntryArena
+    FSEARCH_DATABASE_ENTRY_FLAG_ARENA = 1 << 6,
+    // Name is pure ASCII, so case folding it doesn't need ICU
+    FSEARCH_DATABASE_ENTRY_FLAG_NAME_ASCII = 1 << 7,
 } FsearchDatabaseEntryFlags;
\ No newline at end of file
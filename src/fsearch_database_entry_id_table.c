@@ -0,0 +1,249 @@
+#define G_LOG_DOMAIN "fsearch-database-entry-id-table"
+
+#include "fsearch_database_entry_id_table.h"
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct FsearchDatabaseEntryIdTable {
+    // ID -> entry, NULL for IDs which aren't in use. The first slot is reserved for ID 0.
+    FsearchDatabaseEntry **entries;
+    uint32_t num_ids;
+    uint32_t max_ids;
+
+    // IDs of removed entries, handed out again before new ones
+    GArray *free_ids;
+
+    // Entry -> ID, as an open addressing hash set of IDs keyed by the address of their entry. 0 marks empty slots.
+    // Only the IDs are stored, the entries they belong to are looked up in `entries`.
+    uint32_t *slots;
+    uint32_t num_slots;
+
+    uint32_t num_entries;
+};
+
+// Batches which make up at least that fraction of the table get their IDs sorted by marking them in a bitmap over all
+// IDs, instead of comparing them
+#define SORT_IDS_BITMAP_FRACTION 32
+
+static uint32_t
+id_table_slot_for_entry(FsearchDatabaseEntryIdTable *table, FsearchDatabaseEntry *entry) {
+    // Fibonacci hashing, entries are aligned so their lower address bits carry no information
+    const uint64_t hash = (uint64_t)(uintptr_t)entry * UINT64_C(0x9e3779b97f4a7c15);
+    return (uint32_t)(hash >> 32) & (table->num_slots - 1);
+}
+
+// Returns the slot which holds the ID of `entry`, or the empty slot where it would go
+static uint32_t
+id_table_find_slot(FsearchDatabaseEntryIdTable *table, FsearchDatabaseEntry *entry) {
+    const uint32_t mask = table->num_slots - 1;
+    uint32_t slot = id_table_slot_for_entry(table, entry);
+    while (table->slots[slot] != 0 && table->entries[table->slots[slot]] != entry) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static void
+id_table_resize_slots(FsearchDatabaseEntryIdTable *table, uint32_t num_slots) {
+    g_free(table->slots);
+    table->slots = g_new0(uint32_t, num_slots);
+    table->num_slots = num_slots;
+    for (uint32_t id = 1; id < table->num_ids; ++id) {
+        if (table->entries[id]) {
+            table->slots[id_table_find_slot(table, table->entries[id])] = id;
+        }
+    }
+}
+
+// Empties `slot` and moves the IDs of the following probe sequence up, so lookups never stop early at the hole
+static void
+id_table_clear_slot(FsearchDatabaseEntryIdTable *table, uint32_t slot) {
+    const uint32_t mask = table->num_slots - 1;
+    uint32_t hole = slot;
+    for (uint32_t next = (hole + 1) & mask; table->slots[next] != 0; next = (next + 1) & mask) {
+        const uint32_t home = id_table_slot_for_entry(table, table->entries[table->slots[next]]);
+        // The ID can only fill the hole if its home slot isn't cyclically within (hole, next]
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            table->slots[hole] = table->slots[next];
+            hole = next;
+        }
+    }
+    table->slots[hole] = 0;
+}
+
+static uint32_t
+id_table_lookup(FsearchDatabaseEntryIdTable *table, FsearchDatabaseEntry *entry) {
+    return table->slots[id_table_find_slot(table, entry)];
+}
+
+static uint32_t
+id_table_next_id(FsearchDatabaseEntryIdTable *table) {
+    if (table->free_ids->len > 0) {
+        const uint32_t id = g_array_index(table->free_ids, uint32_t, table->free_ids->len - 1);
+        g_array_set_size(table->free_ids, table->free_ids->len - 1);
+        return id;
+    }
+    if (table->num_ids == table->max_ids) {
+        table->max_ids = MAX(1024, table->max_ids * 2);
+        table->entries = g_renew(FsearchDatabaseEntry *, table->entries, table->max_ids);
+    }
+    return table->num_ids++;
+}
+
+static gint
+compare_ids(gconstpointer a, gconstpointer b) {
+    const uint32_t id_a = *(const uint32_t *)a;
+    const uint32_t id_b = *(const uint32_t *)b;
+    return id_a < id_b ? -1 : id_a > id_b ? 1 : 0;
+}
+
+FsearchDatabaseEntryIdTable *
+fsearch_database_entry_id_table_new(void) {
+    FsearchDatabaseEntryIdTable *table = g_new0(FsearchDatabaseEntryIdTable, 1);
+    table->free_ids = g_array_new(FALSE, FALSE, sizeof(uint32_t));
+    // ID 0 is reserved for entries without an ID
+    table->max_ids = 1024;
+    table->entries = g_new0(FsearchDatabaseEntry *, table->max_ids);
+    table->num_ids = 1;
+    table->num_slots = 2048;
+    table->slots = g_new0(uint32_t, table->num_slots);
+    return table;
+}
+
+void
+fsearch_database_entry_id_table_free(FsearchDatabaseEntryIdTable *table) {
+    g_return_if_fail(table);
+
+    g_clear_pointer(&table->slots, g_free);
+    g_clear_pointer(&table->entries, g_free);
+    g_clear_pointer(&table->free_ids, g_array_unref);
+    g_free(table);
+}
+
+void
+fsearch_database_entry_id_table_add(FsearchDatabaseEntryIdTable *table, DynamicArray *entries) {
+    g_return_if_fail(table);
+    if (!entries) {
+        return;
+    }
+
+    const uint32_t num_entries = darray_get_num_items(entries);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        FsearchDatabaseEntry *entry = darray_get_item(entries, i);
+        const uint32_t slot = id_table_find_slot(table, entry);
+        if (table->slots[slot] != 0) {
+            continue;
+        }
+        const uint32_t id = id_table_next_id(table);
+        table->entries[id] = entry;
+        table->slots[slot] = id;
+        table->num_entries++;
+        // Keep the load factor below 3/4
+        if (table->num_entries >= table->num_slots / 4 * 3) {
+            id_table_resize_slots(table, table->num_slots * 2);
+        }
+    }
+}
+
+void
+fsearch_database_entry_id_table_remove(FsearchDatabaseEntryIdTable *table, DynamicArray *entries) {
+    g_return_if_fail(table);
+    if (!entries) {
+        return;
+    }
+
+    const uint32_t num_entries = darray_get_num_items(entries);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        FsearchDatabaseEntry *entry = darray_get_item(entries, i);
+        const uint32_t slot = id_table_find_slot(table, entry);
+        const uint32_t id = table->slots[slot];
+        if (id == 0) {
+            continue;
+        }
+        id_table_clear_slot(table, slot);
+        table->entries[id] = NULL;
+        g_array_append_val(table->free_ids, id);
+        table->num_entries--;
+    }
+}
+
+FsearchDatabaseEntry *
+fsearch_database_entry_id_table_get_entry(FsearchDatabaseEntryIdTable *table, uint32_t id) {
+    g_return_val_if_fail(table, NULL);
+    return id < table->num_ids ? table->entries[id] : NULL;
+}
+
+uint32_t
+fsearch_database_entry_id_table_get_id(FsearchDatabaseEntryIdTable *table, FsearchDatabaseEntry *entry) {
+    g_return_val_if_fail(table, 0);
+    return entry ? id_table_lookup(table, entry) : 0;
+}
+
+DynamicArray *
+fsearch_database_entry_id_table_get_entries(FsearchDatabaseEntryIdTable *table, GArray *ids) {
+    g_return_val_if_fail(table, NULL);
+    g_return_val_if_fail(ids, NULL);
+
+    DynamicArray *entries = darray_new(ids->len);
+    for (uint32_t i = 0; i < ids->len; ++i) {
+        const uint32_t id = g_array_index(ids, uint32_t, i);
+        FsearchDatabaseEntry *entry = id < table->num_ids ? table->entries[id] : NULL;
+        if (entry) {
+            darray_add_item(entries, entry);
+        }
+    }
+    return entries;
+}
+
+GArray *
+fsearch_database_entry_id_table_get_sorted_ids(FsearchDatabaseEntryIdTable *table, DynamicArray *entries) {
+    g_return_val_if_fail(table, NULL);
+    g_return_val_if_fail(entries, NULL);
+
+    const uint32_t num_entries = darray_get_num_items(entries);
+    GArray *ids = g_array_sized_new(FALSE, FALSE, sizeof(uint32_t), num_entries);
+
+    if (num_entries < table->num_ids / SORT_IDS_BITMAP_FRACTION) {
+        for (uint32_t i = 0; i < num_entries; ++i) {
+            const uint32_t id = id_table_lookup(table, darray_get_item(entries, i));
+            if (id != 0) {
+                g_array_append_val(ids, id);
+            }
+        }
+        g_array_sort(ids, compare_ids);
+        return ids;
+    }
+
+    // Large batches (like all entries of the store) are cheaper to sort in a single pass over all IDs
+    const uint32_t num_words = (table->num_ids + 63) / 64;
+    g_autofree uint64_t *bitmap = g_new0(uint64_t, num_words);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        const uint32_t id = id_table_lookup(table, darray_get_item(entries, i));
+        if (id != 0) {
+            bitmap[id / 64] |= (uint64_t)1 << (id % 64);
+        }
+    }
+    for (uint32_t w = 0; w < num_words; ++w) {
+        uint64_t word = bitmap[w];
+        while (word) {
+            const uint32_t id = w * 64 + (uint32_t)__builtin_ctzll(word);
+            g_array_append_val(ids, id);
+            word &= word - 1;
+        }
+    }
+    return ids;
+}
+
+uint32_t
+fsearch_database_entry_id_table_get_num_entries(FsearchDatabaseEntryIdTable *table) {
+    g_return_val_if_fail(table, 0);
+    return table->num_entries;
+}
+
+uint32_t
+fsearch_database_entry_id_table_get_num_ids(FsearchDatabaseEntryIdTable *table) {
+    g_return_val_if_fail(table, 0);
+    return table->num_ids;
+}
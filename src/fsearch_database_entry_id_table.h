@@ -0,0 +1,58 @@
+#pragma once
+
+#include "fsearch_array.h"
+#include "fsearch_database_entry.h"
+
+#include <glib.h>
+#include <stdint.h>
+
+G_BEGIN_DECLS
+
+// Hands out dense 32-bit IDs to entries, so indices can store those instead of 64-bit pointers and resolve them back
+// through the table. Entries don't store their ID, the table looks it up by the entry's address. Only indices which
+// use IDs pay for that, and entries can be part of several tables. IDs of removed entries get handed out again, 0 is
+// never handed out and stands for entries without an ID.
+//
+// Not thread safe, callers need to serialize all access.
+typedef struct FsearchDatabaseEntryIdTable FsearchDatabaseEntryIdTable;
+
+FsearchDatabaseEntryIdTable *
+fsearch_database_entry_id_table_new(void);
+
+void
+fsearch_database_entry_id_table_free(FsearchDatabaseEntryIdTable *table);
+
+// Gives every entry of `entries` which isn't part of the table yet an ID
+void
+fsearch_database_entry_id_table_add(FsearchDatabaseEntryIdTable *table, DynamicArray *entries);
+
+// Releases the IDs of `entries`, entries which aren't part of the table are skipped
+void
+fsearch_database_entry_id_table_remove(FsearchDatabaseEntryIdTable *table, DynamicArray *entries);
+
+// Returns the entry with `id`, or NULL if the ID isn't in use
+FsearchDatabaseEntry *
+fsearch_database_entry_id_table_get_entry(FsearchDatabaseEntryIdTable *table, uint32_t id);
+
+// Returns the ID of `entry`, or 0 if it isn't part of the table
+uint32_t
+fsearch_database_entry_id_table_get_id(FsearchDatabaseEntryIdTable *table, FsearchDatabaseEntry *entry);
+
+// Returns the entries with `ids` (uint32_t) in the same order. IDs which aren't in use are skipped.
+DynamicArray *
+fsearch_database_entry_id_table_get_entries(FsearchDatabaseEntryIdTable *table, GArray *ids);
+
+// Returns the IDs (uint32_t) of `entries` in ascending order, entries which aren't part of the table are skipped
+GArray *
+fsearch_database_entry_id_table_get_sorted_ids(FsearchDatabaseEntryIdTable *table, DynamicArray *entries);
+
+uint32_t
+fsearch_database_entry_id_table_get_num_entries(FsearchDatabaseEntryIdTable *table);
+
+// All IDs which were handed out so far are smaller than that
+uint32_t
+fsearch_database_entry_id_table_get_num_ids(FsearchDatabaseEntryIdTable *table);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FsearchDatabaseEntryIdTable, fsearch_database_entry_id_table_free)
+
+G_END_DECLS
@@ -25,6 +25,7 @@ typedef enum {
     ENTRY_INFO_ID_INDEX,
     ENTRY_INFO_ID_EXTENSION,
     ENTRY_INFO_ID_HIGHLIGHTS,
+    ENTRY_INFO_ID_CONTENT_TYPE,
     ENTRY_INFO_ID_TYPE,
     NUM_ENTRY_INFO_IDS,
 } FsearchDatabaseEntryInfoID;
@@ -115,6 +116,9 @@ num_flags_set(FsearchDatabaseEntryInfoFlags flags) {
     if (flags & FSEARCH_DATABASE_ENTRY_INFO_FLAG_HIGHLIGHTS) {
         num_flags++;
     }
+    if (flags & FSEARCH_DATABASE_ENTRY_INFO_FLAG_CONTENT_TYPE) {
+        num_flags++;
+    }
     return num_flags;
 }
 
@@ -241,6 +245,12 @@ fsearch_database_entry_info_new(FsearchDatabaseEntry *entry,
         g_clear_pointer(&match_data, fsearch_query_match_data_free);
         g_array_append_val(info->infos, val);
     }
+    if (flags & FSEARCH_DATABASE_ENTRY_INFO_FLAG_CONTENT_TYPE) {
+        FsearchDatabaseEntryInfoValue val = {0};
+        val.id = ENTRY_INFO_ID_CONTENT_TYPE;
+        val.uint = db_entry_get_content_type(entry);
+        g_array_append_val(info->infos, val);
+    }
 
     FsearchDatabaseEntryInfoValue val = {0};
     val.id = ENTRY_INFO_ID_TYPE;
@@ -331,6 +341,15 @@ fsearch_database_entry_info_get_highlights(FsearchDatabaseEntryInfo *info) {
     return val->highlights;
 }
 
+GQuark
+fsearch_database_entry_info_get_content_type(FsearchDatabaseEntryInfo *info) {
+    g_return_val_if_fail(info, 0);
+    g_return_val_if_fail(info->flags & FSEARCH_DATABASE_ENTRY_INFO_FLAG_CONTENT_TYPE, 0);
+    FsearchDatabaseEntryInfoValue *val = get_value(info, ENTRY_INFO_ID_CONTENT_TYPE);
+    g_return_val_if_fail(val, 0);
+    return val->uint;
+}
+
 FsearchDatabaseEntryType
 fsearch_database_entry_info_get_entry_type(FsearchDatabaseEntryInfo *info) {
     g_return_val_if_fail(info, 0);
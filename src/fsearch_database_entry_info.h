@@ -25,13 +25,15 @@ typedef enum {
     FSEARCH_DATABASE_ENTRY_INFO_FLAG_INDEX = 1 << 9,
     FSEARCH_DATABASE_ENTRY_INFO_FLAG_EXTENSION = 1 << 10,
     FSEARCH_DATABASE_ENTRY_INFO_FLAG_HIGHLIGHTS = 1 << 11,
+    FSEARCH_DATABASE_ENTRY_INFO_FLAG_CONTENT_TYPE = 1 << 12,
 } FsearchDatabaseEntryInfoFlags;
 
 #define FSEARCH_DATABASE_ENTRY_INFO_FLAG_ALL                                                                               \
     (FSEARCH_DATABASE_ENTRY_INFO_FLAG_NAME | FSEARCH_DATABASE_ENTRY_INFO_FLAG_PATH | FSEARCH_DATABASE_ENTRY_INFO_FLAG_SIZE \
      | FSEARCH_DATABASE_ENTRY_INFO_FLAG_MODIFICATION_TIME | FSEARCH_DATABASE_ENTRY_INFO_FLAG_PATH_FULL                     \
      | FSEARCH_DATABASE_ENTRY_INFO_FLAG_SELECTED | FSEARCH_DATABASE_ENTRY_INFO_FLAG_INDEX                                  \
-     | FSEARCH_DATABASE_ENTRY_INFO_FLAG_EXTENSION | FSEARCH_DATABASE_ENTRY_INFO_FLAG_HIGHLIGHTS)
+     | FSEARCH_DATABASE_ENTRY_INFO_FLAG_EXTENSION | FSEARCH_DATABASE_ENTRY_INFO_FLAG_HIGHLIGHTS                            \
+     | FSEARCH_DATABASE_ENTRY_INFO_FLAG_CONTENT_TYPE)
 
 GType
 fsearch_database_entry_info_get_type(void);
@@ -76,6 +78,10 @@ fsearch_database_entry_info_get_index(FsearchDatabaseEntryInfo *info);
 GHashTable *
 fsearch_database_entry_info_get_highlights(FsearchDatabaseEntryInfo *info);
 
+// The indexed content type of the entry, or 0 if it isn't known (yet)
+GQuark
+fsearch_database_entry_info_get_content_type(FsearchDatabaseEntryInfo *info);
+
 FsearchDatabaseEntryType
 fsearch_database_entry_info_get_entry_type(FsearchDatabaseEntryInfo *info);
 
@@ -0,0 +1,171 @@
+#define G_LOG_DOMAIN "fsearch-database-extension-index"
+
+#include "fsearch_database_extension_index.h"
+
+#include "fsearch_database_entry.h"
+#include "fsearch_database_entry_id_table.h"
+#include "fsearch_database_posting_list.h"
+
+#include <glib.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+    FsearchDatabasePostingList list;
+    // ASCII lower case, also the key of the list in the index
+    char *extension;
+} ExtensionPostingList;
+
+struct FsearchDatabaseExtensionIndex {
+    // extension -> ExtensionPostingList
+    GHashTable *lists;
+
+    // Resolves the IDs in the posting lists, owned by the caller
+    FsearchDatabaseEntryIdTable *entry_ids;
+};
+
+static void
+posting_list_free(ExtensionPostingList *list) {
+    g_return_if_fail(list);
+    fsearch_database_posting_list_clear(&list->list);
+    g_clear_pointer(&list->extension, g_free);
+    g_free(list);
+}
+
+static gint
+compare_ids(gconstpointer a, gconstpointer b) {
+    const uint32_t id_a = *(const uint32_t *)a;
+    const uint32_t id_b = *(const uint32_t *)b;
+    return id_a < id_b ? -1 : id_a > id_b ? 1 : 0;
+}
+
+static ExtensionPostingList *
+extension_index_lookup(FsearchDatabaseExtensionIndex *index, const char *extension, GString *buffer) {
+    g_string_assign(buffer, extension);
+    g_string_ascii_down(buffer);
+    return g_hash_table_lookup(index->lists, buffer->str);
+}
+
+static void
+extension_index_update(FsearchDatabaseExtensionIndex *index, DynamicArray *entries, bool remove) {
+    if (!entries || darray_get_num_items(entries) == 0) {
+        return;
+    }
+
+    // Batches need to be sorted by ID
+    g_autoptr(GArray) ids = fsearch_database_entry_id_table_get_sorted_ids(index->entry_ids, entries);
+
+    g_autoptr(GPtrArray) touched_lists = g_ptr_array_new();
+    g_autoptr(GString) buffer = g_string_sized_new(16);
+
+    for (uint32_t i = 0; i < ids->len; ++i) {
+        const uint32_t id = g_array_index(ids, uint32_t, i);
+        FsearchDatabaseEntry *entry = fsearch_database_entry_id_table_get_entry(index->entry_ids, id);
+        // Folders don't have an extension
+        const char *extension = db_entry_get_extension(entry);
+        if (!extension) {
+            continue;
+        }
+        ExtensionPostingList *list = extension_index_lookup(index, extension, buffer);
+        if (!list) {
+            if (remove) {
+                g_warning("[extension_index] failed to remove entry: %s", db_entry_get_name_raw_for_display(entry));
+                continue;
+            }
+            list = g_new0(ExtensionPostingList, 1);
+            list->extension = g_strdup(buffer->str);
+            g_hash_table_insert(index->lists, list->extension, list);
+        }
+        if (fsearch_database_posting_list_add_to_batch(&list->list, id)) {
+            g_ptr_array_add(touched_lists, list);
+        }
+    }
+
+    for (uint32_t i = 0; i < touched_lists->len; ++i) {
+        ExtensionPostingList *list = g_ptr_array_index(touched_lists, i);
+        if (remove) {
+            fsearch_database_posting_list_subtract_batch(&list->list);
+        }
+        else {
+            fsearch_database_posting_list_merge_batch(&list->list);
+        }
+        fsearch_database_posting_list_clear_batch(&list->list);
+
+        if (list->list.num_entries == 0) {
+            g_hash_table_remove(index->lists, list->extension);
+        }
+    }
+}
+
+FsearchDatabaseExtensionIndex *
+fsearch_database_extension_index_new(FsearchDatabaseEntryIdTable *entry_ids, DynamicArray *entries) {
+    g_return_val_if_fail(entry_ids, NULL);
+
+    FsearchDatabaseExtensionIndex *index = g_new0(FsearchDatabaseExtensionIndex, 1);
+    index->entry_ids = entry_ids;
+    index->lists = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, (GDestroyNotify)posting_list_free);
+
+    extension_index_update(index, entries, false);
+
+    return index;
+}
+
+void
+fsearch_database_extension_index_free(FsearchDatabaseExtensionIndex *index) {
+    g_return_if_fail(index);
+
+    g_clear_pointer(&index->lists, g_hash_table_unref);
+    g_free(index);
+}
+
+void
+fsearch_database_extension_index_add(FsearchDatabaseExtensionIndex *index, DynamicArray *entries) {
+    g_return_if_fail(index);
+    extension_index_update(index, entries, false);
+}
+
+void
+fsearch_database_extension_index_remove(FsearchDatabaseExtensionIndex *index, DynamicArray *entries) {
+    g_return_if_fail(index);
+    extension_index_update(index, entries, true);
+}
+
+GArray *
+fsearch_database_extension_index_get_ids(FsearchDatabaseExtensionIndex *index,
+                                         GPtrArray *extensions,
+                                         uint32_t max_entries) {
+    g_return_val_if_fail(index, NULL);
+    g_return_val_if_fail(extensions, NULL);
+
+    g_autoptr(GString) buffer = g_string_sized_new(16);
+    g_autoptr(GPtrArray) lists = g_ptr_array_new();
+    uint32_t num_entries = 0;
+    for (uint32_t i = 0; i < extensions->len; ++i) {
+        ExtensionPostingList *list = extension_index_lookup(index, g_ptr_array_index(extensions, i), buffer);
+        // Extensions which only differ in case share a list
+        if (list && !g_ptr_array_find(lists, list, NULL)) {
+            g_ptr_array_add(lists, list);
+            num_entries += list->list.num_entries;
+        }
+    }
+    if (num_entries > max_entries) {
+        return NULL;
+    }
+
+    // Every entry has only one extension, so the lists don't overlap and only need to be brought into one order
+    GArray *ids = g_array_sized_new(FALSE, FALSE, sizeof(uint32_t), num_entries);
+    for (uint32_t i = 0; i < lists->len; ++i) {
+        ExtensionPostingList *list = g_ptr_array_index(lists, i);
+        g_array_append_vals(ids, list->list.ids, list->list.num_entries);
+    }
+    if (lists->len > 1) {
+        g_array_sort(ids, compare_ids);
+    }
+    return ids;
+}
+
+uint32_t
+fsearch_database_extension_index_get_num_extensions(FsearchDatabaseExtensionIndex *index) {
+    g_return_val_if_fail(index, 0);
+    return g_hash_table_size(index->lists);
+}
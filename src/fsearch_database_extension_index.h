@@ -0,0 +1,44 @@
+#pragma once
+
+#include "fsearch_array.h"
+#include "fsearch_database_entry_id_table.h"
+
+#include <glib.h>
+#include <stdint.h>
+
+G_BEGIN_DECLS
+
+// Inverted index from every (ASCII case folded) file extension to the entries with that extension.
+// Like the trigram index it only narrows down the entries which can possibly match, the candidates still need to be
+// matched against the query. Entries are stored by their ID in `entry_ids`, so they must have one before they're
+// added and keep it until they're removed.
+//
+// Not thread safe, callers need to serialize all access.
+typedef struct FsearchDatabaseExtensionIndex FsearchDatabaseExtensionIndex;
+
+FsearchDatabaseExtensionIndex *
+fsearch_database_extension_index_new(FsearchDatabaseEntryIdTable *entry_ids, DynamicArray *entries);
+
+void
+fsearch_database_extension_index_free(FsearchDatabaseExtensionIndex *index);
+
+void
+fsearch_database_extension_index_add(FsearchDatabaseExtensionIndex *index, DynamicArray *entries);
+
+// Entries must still be valid (i.e. have the same name as when they were added) while they're being removed
+void
+fsearch_database_extension_index_remove(FsearchDatabaseExtensionIndex *index, DynamicArray *entries);
+
+// Returns the IDs (uint32_t, in ascending order) of all entries with one of `extensions` (const char *), or NULL if
+// that would be more than `max_entries` entries.
+GArray *
+fsearch_database_extension_index_get_ids(FsearchDatabaseExtensionIndex *index,
+                                         GPtrArray *extensions,
+                                         uint32_t max_entries);
+
+uint32_t
+fsearch_database_extension_index_get_num_extensions(FsearchDatabaseExtensionIndex *index);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FsearchDatabaseExtensionIndex, fsearch_database_extension_index_free)
+
+G_END_DECLS
@@ -5,6 +5,7 @@
 #include "fsearch_array.h"
 #include "fsearch_database_chunked_array.h"
 #include "fsearch_database_entry.h"
+#include "fsearch_database_entry_arena.h"
 #include "fsearch_database_exclude.h"
 #include "fsearch_database_exclude_manager.h"
 #include "fsearch_database_include.h"
@@ -28,7 +29,7 @@
 #include <unistd.h>
 
 #define DATABASE_MAJOR_VERSION 6
-#define DATABASE_MINOR_VERSION 0
+#define DATABASE_MINOR_VERSION 1
 #define DATABASE_MAGIC_NUMBER "FSDB"
 #define DATABASE_CHECKSUM_SIZE 16
 
@@ -162,7 +163,9 @@ cursor_read(DatabaseFileReadCursor *cursor, void *dest, size_t size) {
 
 static void
 database_file_load_entry(DatabaseFileReadCursor *cursor,
+                         FsearchDatabaseEntryArena *arena,
                          FsearchDatabaseIndexPropertyFlags index_flags,
+                         GArray *content_types,
                          GString *previous_entry_name,
                          FsearchDatabaseEntry **entry_out,
                          FsearchDatabaseEntryType type) {
@@ -193,7 +196,7 @@ database_file_load_entry(DatabaseFileReadCursor *cursor,
         cursor->ptr += name_len;
     }
 
-    *entry_out = db_entry_new(index_flags, previous_entry_name->str, NULL, type);
+    *entry_out = db_entry_new_in_arena(arena, index_flags, previous_entry_name->str, NULL, type);
     if ((index_flags & DATABASE_INDEX_PROPERTY_FLAG_SIZE) != 0) {
         // size: size of file/folder
         int64_t size = 0;
@@ -209,6 +212,17 @@ database_file_load_entry(DatabaseFileReadCursor *cursor,
 
         db_entry_set_mtime(*entry_out, (time_t)mtime);
     }
+
+    if ((index_flags & DATABASE_INDEX_PROPERTY_FLAG_FILETYPE) != 0) {
+        // content_type_idx: position in the content type table, 0 if the content type wasn't known yet
+        uint32_t content_type_idx = 0;
+        cursor_read(cursor, &content_type_idx, sizeof(content_type_idx));
+        if (content_type_idx >= content_types->len) {
+            cursor->error = true;
+            return;
+        }
+        db_entry_set_content_type(*entry_out, g_array_index(content_types, GQuark, content_type_idx));
+    }
 }
 
 static bool
@@ -278,7 +292,9 @@ database_file_load_add_to_index_array(GHashTable *index_table, FsearchDatabaseEn
 
 static bool
 database_file_load_folders(FILE *fp,
+                           FsearchDatabaseEntryArena *arena,
                            FsearchDatabaseIndexPropertyFlags index_flags,
+                           GArray *content_types,
                            DynamicArray *folders,
                            uint32_t num_folders,
                            uint64_t folder_block_size) {
@@ -299,7 +315,13 @@ database_file_load_folders(FILE *fp,
     for (idx = 0; idx < num_folders; idx++) {
         g_autoptr(FsearchDatabaseEntry) folder = NULL;
 
-        database_file_load_entry(&cursor, index_flags, previous_entry_name, &folder, DATABASE_ENTRY_TYPE_FOLDER);
+        database_file_load_entry(&cursor,
+                                 arena,
+                                 index_flags,
+                                 content_types,
+                                 previous_entry_name,
+                                 &folder,
+                                 DATABASE_ENTRY_TYPE_FOLDER);
         // parent_idx: index of parent folder
         uint32_t parent_idx = 0;
         cursor_read(&cursor, &parent_idx, sizeof(parent_idx));
@@ -343,7 +365,9 @@ database_file_load_folders(FILE *fp,
 
 static bool
 database_file_load_files(FILE *fp,
+                         FsearchDatabaseEntryArena *arena,
                          FsearchDatabaseIndexPropertyFlags index_flags,
+                         GArray *content_types,
                          DynamicArray *folders,
                          DynamicArray *files,
                          uint32_t num_files,
@@ -366,7 +390,13 @@ database_file_load_files(FILE *fp,
     uint32_t idx = 0;
     for (idx = 0; idx < num_files; idx++) {
         g_autoptr(FsearchDatabaseEntry) entry = NULL;
-        database_file_load_entry(&cursor, index_flags, previous_entry_name, &entry, DATABASE_ENTRY_TYPE_FILE);
+        database_file_load_entry(&cursor,
+                                 arena,
+                                 index_flags,
+                                 content_types,
+                                 previous_entry_name,
+                                 &entry,
+                                 DATABASE_ENTRY_TYPE_FILE);
 
         // parent_idx: index of parent folder
         uint32_t parent_idx = 0;
@@ -646,6 +676,28 @@ database_file_load_excludes(FILE *fp, FsearchDatabaseExcludeManager *exclude_man
     return true;
 }
 
+static bool
+database_file_load_content_types(FILE *fp, GArray *content_types, GChecksum *checksum) {
+    uint32_t num_content_types = 0;
+    if (!database_file_read_element(&num_content_types, sizeof(num_content_types), fp, checksum)) {
+        g_debug("[db_load] failed to read number of content types");
+        return false;
+    }
+    // Index 0 stands for entries whose content type wasn't known yet
+    const GQuark unknown = 0;
+    g_array_append_val(content_types, unknown);
+    for (uint32_t i = 0; i < num_content_types; ++i) {
+        g_autofree char *content_type = database_file_read_string(fp, 1024, checksum);
+        if (!content_type || content_type[0] == '\0') {
+            g_debug("[db_load] failed to read content type");
+            return false;
+        }
+        const GQuark quark = g_quark_from_string(content_type);
+        g_array_append_val(content_types, quark);
+    }
+    return true;
+}
+
 // endregion
 
 // region Database-File-Write
@@ -653,6 +705,7 @@ database_file_load_excludes(FILE *fp, FsearchDatabaseExcludeManager *exclude_man
 static void
 database_file_save_entry(DatabaseFileWriteCursor *cursor,
                          FsearchDatabaseIndexPropertyFlags index_flags,
+                         GHashTable *content_types,
                          FsearchDatabaseEntry *entry,
                          uint32_t parent_idx,
                          GString *previous_entry_name,
@@ -690,6 +743,14 @@ database_file_save_entry(DatabaseFileWriteCursor *cursor,
         cursor_write(cursor, &mtime, sizeof(mtime));
     }
 
+    if ((index_flags & DATABASE_INDEX_PROPERTY_FLAG_FILETYPE) != 0) {
+        // content_type_idx: position in the content type table, 0 if the content type isn't known yet
+        const GQuark content_type = db_entry_get_content_type(entry);
+        const gpointer content_type_pos = g_hash_table_lookup(content_types, GUINT_TO_POINTER(content_type));
+        const uint32_t content_type_idx = GPOINTER_TO_UINT(content_type_pos);
+        cursor_write(cursor, &content_type_idx, sizeof(content_type_idx));
+    }
+
     // parent_idx: index of parent folder
     cursor_write(cursor, &parent_idx, sizeof(parent_idx));
 }
@@ -712,6 +773,7 @@ database_file_save_header(DatabaseFileWriteCursor *cursor) {
 static void
 database_file_save_files(DatabaseFileWriteCursor *cursor,
                          FsearchDatabaseIndexPropertyFlags index_flags,
+                         GHashTable *content_types,
                          DynamicArray *files,
                          uint32_t num_files,
                          FsearchDatabaseEntry **real_parents_of_files) {
@@ -723,7 +785,7 @@ database_file_save_files(DatabaseFileWriteCursor *cursor,
 
         FsearchDatabaseEntry *real_parent = real_parents_of_files[i];
         const uint32_t parent_idx = db_entry_get_encoded_index(real_parent);
-        database_file_save_entry(cursor, index_flags, entry, parent_idx, name_prev, name_new);
+        database_file_save_entry(cursor, index_flags, content_types, entry, parent_idx, name_prev, name_new);
         if (cursor->error) {
             return;
         }
@@ -806,6 +868,7 @@ database_file_save_sorted_arrays(DatabaseFileWriteCursor *cursor,
 static void
 database_file_save_folders(DatabaseFileWriteCursor *cursor,
                            FsearchDatabaseIndexPropertyFlags index_flags,
+                           GHashTable *content_types,
                            DynamicArray *folders,
                            uint32_t num_folders,
                            FsearchDatabaseEntry **real_parents_of_folders) {
@@ -817,7 +880,7 @@ database_file_save_folders(DatabaseFileWriteCursor *cursor,
 
         FsearchDatabaseEntry *real_parent = real_parents_of_folders[i];
         const uint32_t parent_idx = real_parent ? db_entry_get_encoded_index(real_parent) : i;
-        database_file_save_entry(cursor, index_flags, entry, parent_idx, name_prev, name_new);
+        database_file_save_entry(cursor, index_flags, content_types, entry, parent_idx, name_prev, name_new);
         if (cursor->error) {
             return;
         }
@@ -920,6 +983,29 @@ database_file_save_excludes(DatabaseFileWriteCursor *cursor, FsearchDatabaseInde
     cursor_write(cursor, &exclude_hidden, sizeof(exclude_hidden));
 }
 
+static void
+content_types_add(GHashTable *content_types, GPtrArray *content_type_table, DynamicArray *entries) {
+    for (uint32_t i = 0; i < darray_get_num_items(entries); ++i) {
+        const GQuark content_type = db_entry_get_content_type(darray_get_item(entries, i));
+        if (content_type == 0 || g_hash_table_contains(content_types, GUINT_TO_POINTER(content_type))) {
+            continue;
+        }
+        g_ptr_array_add(content_type_table, (gpointer)g_quark_to_string(content_type));
+        // Index 0 is reserved for entries whose content type isn't known yet
+        g_hash_table_insert(content_types, GUINT_TO_POINTER(content_type), GUINT_TO_POINTER(content_type_table->len));
+    }
+}
+
+static void
+database_file_save_content_types(DatabaseFileWriteCursor *cursor, GPtrArray *content_type_table) {
+    const uint32_t num_content_types = content_type_table->len;
+    cursor_write(cursor, &num_content_types, sizeof(num_content_types));
+    for (uint32_t i = 0; i < num_content_types; ++i) {
+        const char *content_type = g_ptr_array_index(content_type_table, i);
+        cursor_write_string(cursor, content_type, strlen(content_type));
+    }
+}
+
 // endregion
 
 bool
@@ -943,6 +1029,10 @@ fsearch_database_file_save(FsearchDatabaseIndexStore *store, const char *file_pa
     g_auto(EncodedEntryIndices) encoded_folders = {0};
     g_auto(EncodedEntryIndices) encoded_files = {0};
 
+    // content type -> its position in the content type table
+    g_autoptr(GHashTable) content_types = g_hash_table_new(NULL, NULL);
+    g_autoptr(GPtrArray) content_type_table = g_ptr_array_new();
+
     g_debug("[db_save] trying to open temporary database file: %s", file_tmp_path->str);
 
     g_autoptr(FILE) fp = file_open_locked(file_tmp_path->str, "wb");
@@ -1015,6 +1105,17 @@ fsearch_database_file_save(FsearchDatabaseIndexStore *store, const char *file_pa
         goto save_fail;
     }
 
+    if ((index_flags & DATABASE_INDEX_PROPERTY_FLAG_FILETYPE) != 0) {
+        g_debug("[db_save] saving content types...");
+        content_types_add(content_types, content_type_table, folders);
+        content_types_add(content_types, content_type_table, files);
+        database_file_save_content_types(&cursor, content_type_table);
+        if (cursor.error == true) {
+            g_debug("[db_save] failed saving content types");
+            goto save_fail;
+        }
+    }
+
     // Set checksum to NULL. For performance reasons we don't want to compute the checksum of the larger arrays.
     // It also must be set to NULL before writing placeholder data for folder and file block sizes and checksum itself
     cursor.checksum = NULL;
@@ -1050,13 +1151,18 @@ fsearch_database_file_save(FsearchDatabaseIndexStore *store, const char *file_pa
 
     g_debug("[db_save] saving folders...");
     uint64_t current_cursor_size = cursor.bytes_written;
-    database_file_save_folders(&cursor, index_flags, folders, num_folders, encoded_folders.real_parents);
+    database_file_save_folders(&cursor,
+                               index_flags,
+                               content_types,
+                               folders,
+                               num_folders,
+                               encoded_folders.real_parents);
     folder_block_size = cursor.bytes_written - current_cursor_size;
 
     if (!cursor.error) {
         g_debug("[db_save] saving files...");
         current_cursor_size = cursor.bytes_written;
-        database_file_save_files(&cursor, index_flags, files, num_files, encoded_files.real_parents);
+        database_file_save_files(&cursor, index_flags, content_types, files, num_files, encoded_files.real_parents);
         file_block_size = cursor.bytes_written - current_cursor_size;
     }
 
@@ -1139,6 +1245,8 @@ fsearch_database_file_load_config(const char *file_path,
     g_autoptr(FsearchDatabaseIncludeManager) include_manager = fsearch_database_include_manager_new();
     g_autoptr(FsearchDatabaseExcludeManager) exclude_manager = fsearch_database_exclude_manager_new();
 
+    g_autoptr(GArray) content_types = g_array_new(FALSE, FALSE, sizeof(GQuark));
+
     g_autoptr(GChecksum) checksum = g_checksum_new(G_CHECKSUM_MD5);
 
     if (!database_file_load_header(fp, checksum)) {
@@ -1179,6 +1287,12 @@ fsearch_database_file_load_config(const char *file_path,
     }
     g_debug("[db_load] load %d folders, %d files", num_folders, num_files);
 
+    if ((index_flags & DATABASE_INDEX_PROPERTY_FLAG_FILETYPE) != 0
+        && !database_file_load_content_types(fp, content_types, checksum)) {
+        g_debug("[db_load] failed to load content types");
+        goto load_fail;
+    }
+
     uint64_t folder_block_size = 0;
     if (!database_file_read_element(&folder_block_size, sizeof(folder_block_size), fp, checksum)) {
         g_debug("[db_load] failed to read folder block size");
@@ -1237,6 +1351,9 @@ fsearch_database_file_load(const char *file_path,
         return false;
     }
 
+    // All entries of the database get allocated in one arena, which is shared by the indices they end up in.
+    // Declared first, so it's released only after the arrays below have dropped their entries.
+    g_autoptr(FsearchDatabaseEntryArena) arena = fsearch_database_entry_arena_new();
     g_autoptr(DynamicArray) folders = NULL;
     g_autoptr(DynamicArray) files = NULL;
     DynamicArray *sorted_folders[NUM_DATABASE_INDEX_PROPERTIES] = {NULL};
@@ -1254,6 +1371,8 @@ fsearch_database_file_load(const char *file_path,
                                                                     NULL,
                                                                     (GDestroyNotify)darray_unref);
 
+    g_autoptr(GArray) content_types = g_array_new(FALSE, FALSE, sizeof(GQuark));
+
     g_autoptr(GChecksum) checksum = g_checksum_new(G_CHECKSUM_MD5);
 
     if (!database_file_load_header(fp, checksum)) {
@@ -1302,6 +1421,12 @@ fsearch_database_file_load(const char *file_path,
     }
     g_debug("[db_load] load %d folders, %d files", num_folders, num_files);
 
+    if ((index_flags & DATABASE_INDEX_PROPERTY_FLAG_FILETYPE) != 0
+        && !database_file_load_content_types(fp, content_types, checksum)) {
+        g_debug("[db_load] failed to load content types");
+        goto load_fail;
+    }
+
     uint64_t folder_block_size = 0;
     if (!database_file_read_element(&folder_block_size, sizeof(folder_block_size), fp, checksum)) {
         g_debug("[db_load] failed to read folder block size");
@@ -1337,7 +1462,7 @@ fsearch_database_file_load(const char *file_path,
         status_cb(_("Loading folders…"));
     }
     // load folders
-    if (!database_file_load_folders(fp, index_flags, folders, num_folders, folder_block_size)) {
+    if (!database_file_load_folders(fp, arena, index_flags, content_types, folders, num_folders, folder_block_size)) {
         g_debug("[db_load] failed to load folders");
         goto load_fail;
     }
@@ -1348,13 +1473,17 @@ fsearch_database_file_load(const char *file_path,
         db_entry_set_parent_no_update(folder, parent);
         db_entry_increment_childcount(parent, DATABASE_ENTRY_TYPE_FOLDER);
     }
+    // Parents aren't necessarily loaded before their children, so depths can only be determined once all are linked
+    for (uint32_t i = 0; i < num_folders; i++) {
+        db_entry_update_depth(darray_get_item(folders, i));
+    }
 
     if (status_cb) {
         status_cb(_("Loading files…"));
     }
     // load files
     files = darray_new_full(num_files, (GDestroyNotify)db_entry_free_no_unparent);
-    if (!database_file_load_files(fp, index_flags, folders, files, num_files, file_block_size)) {
+    if (!database_file_load_files(fp, arena, index_flags, content_types, folders, files, num_files, file_block_size)) {
         g_debug("[db_load] failed to load files");
         goto load_fail;
     }
@@ -1396,6 +1525,7 @@ fsearch_database_file_load(const char *file_path,
                                                                               exclude_manager,
                                                                               folder_array_index,
                                                                               file_array_index,
+                                                                              arena,
                                                                               index_flags);
         g_ptr_array_add(indices, index);
     }
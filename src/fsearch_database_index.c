@@ -5,6 +5,7 @@
 #include "fsearch_array.h"
 #include "fsearch_database_chunked_array.h"
 #include "fsearch_database_entry.h"
+#include "fsearch_database_entry_arena.h"
 #include "fsearch_database_exclude_manager.h"
 #include "fsearch_database_include.h"
 #include "fsearch_database_index_event.h"
@@ -34,6 +35,9 @@ struct _FsearchDatabaseIndex {
     FsearchDatabaseChunkedArray *folder_chunks;
     FsearchDatabaseChunkedArray *file_chunks;
 
+    // All entries of the index get allocated from here
+    FsearchDatabaseEntryArena *arena;
+
     FsearchDatabaseIndexPropertyFlags flags;
 
     GMainContext *monitor_ctx;
@@ -582,6 +586,8 @@ process_create_event(FsearchDatabaseIndex *self, FsearchFolderMonitorEvent *even
                            event->watched_entry,
                            folders,
                            files,
+                           self->arena,
+                           self->flags,
                            self->exclude_manager,
                            self->fanotify_monitor,
                            self->inotify_monitor,
@@ -594,15 +600,16 @@ process_create_event(FsearchDatabaseIndex *self, FsearchFolderMonitorEvent *even
         }
     }
     else {
-        FsearchDatabaseEntry *entry = db_entry_new_with_attributes(DATABASE_INDEX_PROPERTY_FLAG_DEFAULT,
-                                                                   event->name->str,
-                                                                   event->watched_entry,
-                                                                   DATABASE_ENTRY_TYPE_FILE,
-                                                                   DATABASE_INDEX_PROPERTY_SIZE,
-                                                                   size,
-                                                                   DATABASE_INDEX_PROPERTY_MODIFICATION_TIME,
-                                                                   mtime,
-                                                                   DATABASE_INDEX_PROPERTY_NONE);
+        FsearchDatabaseEntry *entry = db_entry_new_with_attributes_in_arena(self->arena,
+                                                                            self->flags,
+                                                                            event->name->str,
+                                                                            event->watched_entry,
+                                                                            DATABASE_ENTRY_TYPE_FILE,
+                                                                            DATABASE_INDEX_PROPERTY_SIZE,
+                                                                            size,
+                                                                            DATABASE_INDEX_PROPERTY_MODIFICATION_TIME,
+                                                                            mtime,
+                                                                            DATABASE_INDEX_PROPERTY_NONE);
         fsearch_database_chunked_array_insert(self->file_chunks, entry);
 
         files = darray_new(1);
@@ -700,6 +707,8 @@ process_attrib_event(FsearchDatabaseIndex *self, FsearchFolderMonitorEvent *even
     propagate_event(self, FSEARCH_DATABASE_INDEX_EVENT_ENTRY_DELETED, folders, files, affected_sort_orders, false);
     db_entry_set_mtime(entry, mtime);
     db_entry_set_size(entry, size);
+    // The content might have changed its type as well, it gets determined again in the background
+    db_entry_set_content_type(entry, 0);
     propagate_event(self, FSEARCH_DATABASE_INDEX_EVENT_ENTRY_CREATED, folders, files, affected_sort_orders, false);
     stats_add(stats ? &stats->attributes_changed : NULL, 1);
 }
@@ -907,8 +916,21 @@ index_free(FsearchDatabaseIndex *self) {
 
     g_clear_pointer(&self->event_queue, g_async_queue_unref);
 
+    if (self->arena && fsearch_database_entry_arena_is_exclusive(self->arena)) {
+        // The arena is about to be dropped as a whole, so only the entries which were too large for it (e.g. root
+        // folders with long paths) need to be freed one by one
+        if (self->file_chunks) {
+            fsearch_database_chunked_array_set_entry_free_func(self->file_chunks,
+                                                               (GDestroyNotify)db_entry_free_outside_arena);
+        }
+        if (self->folder_chunks) {
+            fsearch_database_chunked_array_set_entry_free_func(self->folder_chunks,
+                                                               (GDestroyNotify)db_entry_free_outside_arena);
+        }
+    }
     g_clear_pointer(&self->file_chunks, fsearch_database_chunked_array_unref);
     g_clear_pointer(&self->folder_chunks, fsearch_database_chunked_array_unref);
+    g_clear_pointer(&self->arena, fsearch_database_entry_arena_unref);
 
     g_mutex_clear(&self->mutex);
 
@@ -930,6 +952,7 @@ fsearch_database_index_new(FsearchDatabaseInclude *include,
     self->include = fsearch_database_include_ref(include);
     self->exclude_manager = g_object_ref(exclude_manager);
     self->flags = flags;
+    self->arena = fsearch_database_entry_arena_new();
 
     self->needs_root_reappear_poll = false;
 
@@ -959,6 +982,7 @@ fsearch_database_index_new_with_content(FsearchDatabaseInclude *include,
                                         FsearchDatabaseExcludeManager *exclude_manager,
                                         DynamicArray *folders,
                                         DynamicArray *files,
+                                        FsearchDatabaseEntryArena *arena,
                                         FsearchDatabaseIndexPropertyFlags flags) {
     FsearchDatabaseIndex *self = g_new0(FsearchDatabaseIndex, 1);
     g_assert(self);
@@ -968,6 +992,9 @@ fsearch_database_index_new_with_content(FsearchDatabaseInclude *include,
     self->include = fsearch_database_include_ref(include);
     self->exclude_manager = g_object_ref(exclude_manager);
     self->flags = flags;
+    // `folders` and `files` may have been allocated from an arena shared with other indices (e.g. when they were
+    // loaded from the same database file). Keep it alive for as long as we own entries in it.
+    self->arena = arena ? fsearch_database_entry_arena_ref(arena) : fsearch_database_entry_arena_new();
     self->needs_root_reappear_poll = false;
 
     self->folder_chunks = fsearch_database_chunked_array_new(folders,
@@ -1119,6 +1146,8 @@ fsearch_database_index_scan(FsearchDatabaseIndex *self, GCancellable *cancellabl
                         NULL,
                         folders,
                         files,
+                        self->arena,
+                        self->flags,
                         self->exclude_manager,
                         self->fanotify_monitor,
                         self->inotify_monitor,
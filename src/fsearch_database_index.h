@@ -1,6 +1,7 @@
 #pragma once
 
 #include "fsearch_array.h"
+#include "fsearch_database_entry_arena.h"
 #include "fsearch_database_exclude_manager.h"
 #include "fsearch_database_include.h"
 #include "fsearch_database_index_event.h"
@@ -43,6 +44,7 @@ fsearch_database_index_new_with_content(FsearchDatabaseInclude *include,
                                         FsearchDatabaseExcludeManager *exclude_manager,
                                         DynamicArray *folders,
                                         DynamicArray *files,
+                                        FsearchDatabaseEntryArena *arena,
                                         FsearchDatabaseIndexPropertyFlags flags);
 
 void
@@ -129,6 +129,20 @@ fsearch_database_index_property_is_set(FsearchDatabaseIndexPropertyFlags flags,
     return (target_flag != 0) && ((flags & target_flag) != 0);
 }
 
+static inline bool
+fsearch_database_sort_order_chain_equal(const FsearchDatabaseSortOrderChain *chain_1,
+                                        const FsearchDatabaseSortOrderChain *chain_2) {
+    if (chain_1->length != chain_2->length) {
+        return false;
+    }
+    for (uint32_t i = 0; i < chain_1->length; ++i) {
+        if (chain_1->properties[i] != chain_2->properties[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // Whether an update touching `affected_sort_orders` can affect the position of any entry
 // currently ordered by `chain` -- i.e. whether any level of the chain (not just the primary
 // property) is among the affected properties.
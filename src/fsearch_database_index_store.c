@@ -5,18 +5,23 @@
 #include "fsearch_array.h"
 #include "fsearch_database_chunked_array.h"
 #include "fsearch_database_entry.h"
+#include "fsearch_database_entry_id_table.h"
 #include "fsearch_database_entry_info.h"
+#include "fsearch_database_extension_index.h"
 #include "fsearch_database_exclude_manager.h"
 #include "fsearch_database_include.h"
 #include "fsearch_database_include_manager.h"
 #include "fsearch_database_index.h"
 #include "fsearch_database_index_event.h"
 #include "fsearch_database_index_properties.h"
+#include "fsearch_database_posting_list.h"
 #include "fsearch_database_search_info.h"
 #include "fsearch_database_search_view.h"
 #include "fsearch_database_sort.h"
+#include "fsearch_database_trigram_index.h"
 #include "fsearch_query.h"
 #include "fsearch_query_match_data.h"
+#include "fsearch_query_node.h"
 #include "fsearch_selection_type.h"
 
 #include <gio/gio.h>
@@ -27,8 +32,34 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+#include <strings.h>
 
 #define THRESHOLD_FOR_PARALLEL_SEARCH 1000
+// Number of entries search threads claim at once. Small enough that a slow region (deep paths, expensive
+// query nodes) gets spread over all threads, large enough to keep the atomic claim counter out of the way.
+#define SEARCH_BLOCK_SIZE 8192
+// The inverted indices (trigrams and extensions) are only used when they narrow a search down to at most that many
+// candidates (or a fraction of all entries for smaller indices), otherwise matching and sorting the candidates gets
+// slower than a parallel scan
+#define INDEX_MAX_CANDIDATES 100000
+#define INDEX_MAX_CANDIDATES_FRACTION 16
+// A slice of the size or modification time index which isn't in the order of the search has its matches sorted
+// afterwards, which only pays off when the slice is at most that fraction of all entries
+#define RANGE_MAX_UNSORTED_SLICE_FRACTION 16
+// Scans of at least that many entries publish their results in stages, so the first matches in sort order show up
+// before the whole index got searched. The first stage is small to get them out quickly, every following stage is
+// STREAMING_STAGE_GROWTH times as large, which keeps the number of (copied) partial results low.
+#define THRESHOLD_FOR_STREAMING_SEARCH 262144
+#define STREAMING_FIRST_STAGE_SIZE 65536
+#define STREAMING_STAGE_GROWTH 4
+// When content types are indexed, they get determined on a thread of their own in batches of that many entries, with a
+// short break after each of them. The file system is accessed without holding the store lock.
+#define CONTENT_TYPE_BATCH_SIZE 256
+#define CONTENT_TYPE_BATCH_INTERVAL_MS 100
+// The trigram indices get built in the background in slices of that many entries, so the worker thread only holds the
+// store lock briefly and searches, which scan until the indices are ready, don't have to wait for the whole build
+#define TRIGRAM_BUILD_SLICE_SIZE 32768
 
 typedef struct {
     GThread *thread;
@@ -48,6 +79,31 @@ struct FsearchDatabaseIndexStore {
     FsearchDatabaseChunkedArray *file_chunks[NUM_DATABASE_INDEX_PROPERTIES];
     FsearchDatabaseChunkedArray *folder_chunks[NUM_DATABASE_INDEX_PROPERTIES];
 
+    // Optional trigram indices over the names of all entries, to answer substring searches without a full scan.
+    // They're built in the background once they got enabled, searches scan until they're ready.
+    FsearchDatabaseTrigramIndex *file_trigrams;
+    FsearchDatabaseTrigramIndex *folder_trigrams;
+    bool trigram_index_enabled;
+    // The trigram build in progress on the worker thread. First every entry gets an ID, going through the folders and
+    // files in name order. Then the new indices get filled in ID order. They already get the updates of all entries
+    // whose ID is below `trigram_build_next_id`, the build adds all others.
+    GSource *worker_trigram_build_source;
+    FsearchDatabaseTrigramIndex *building_file_trigrams;
+    FsearchDatabaseTrigramIndex *building_folder_trigrams;
+    uint32_t trigram_build_folder_position;
+    uint32_t trigram_build_file_position;
+    uint32_t trigram_build_next_id;
+    int64_t trigram_build_start_time;
+
+    // Extension indices over all entries, to answer ext: queries (and filters made up of them) without a full scan.
+    // They're built on demand by the first search which can use them and kept up to date afterwards.
+    FsearchDatabaseExtensionIndex *file_extensions;
+    FsearchDatabaseExtensionIndex *folder_extensions;
+
+    // The trigram and extension indices store entries by the IDs they got from here. Created along with the first of
+    // them and only freed with all of them.
+    FsearchDatabaseEntryIdTable *entry_ids;
+
     // Include/Exclude configuration
     FsearchDatabaseIncludeManager *include_manager;
     FsearchDatabaseExcludeManager *exclude_manager;
@@ -68,20 +124,76 @@ struct FsearchDatabaseIndexStore {
     FsearchDatabaseThreadContext worker;
     GSource *worker_index_root_reappear_poll_source;
 
+    // Determines the content types of all entries in the background, if FILETYPE is indexed. The file system lookups
+    // are slow, so they don't run on the worker thread, which has to keep up with file system events. The thread
+    // waits on `content_type_cond` (with the store lock) until there's something to do or it has to quit.
+    GThread *content_type_thread;
+    GCond content_type_cond;
+    bool content_type_thread_quit;
+    // The entries whose content types are being looked up right now, without holding the lock. Entries which get
+    // removed meanwhile are dropped from it, so their results get discarded.
+    GHashTable *content_type_batch;
+    // Position of the next content type batch in the folders and files sorted by name
+    uint32_t content_type_folder_position;
+    uint32_t content_type_file_position;
+    // Whether there might be entries whose content type isn't known yet, and whether the current pass over all entries
+    // found any of them
+    bool content_types_pending;
+    bool content_types_found;
+
     bool is_sorted;
     bool running;
 
     GMutex mutex;
 
+    // Partial results of the search in progress. A search holds `mutex` the whole time, so nothing in the index can
+    // change while it's set and it can be read with only `streaming_mutex` held.
+    FsearchDatabaseSearchView *streaming_view;
+    GMutex streaming_mutex;
+
     volatile gint ref_count;
 };
 
+typedef struct {
+    uint32_t start_chunk;
+    uint32_t end_chunk;
+    // Where the block's matches ended up: `num_results` entries starting at `results_offset` in `results`
+    DynamicArray *results;
+    uint32_t results_offset;
+    uint32_t num_results;
+    bool finished;
+    // Whether the block's search got stopped before it reached its end
+    bool stopped;
+} IndexStoreSearchBlock;
+
+typedef struct {
+    DynamicArray *chunks;
+    IndexStoreSearchBlock *blocks;
+    uint32_t num_blocks;
+    // Blocks get claimed from the end of the index to its start
+    bool reverse;
+    // Position (in claim order) of the next block up for grabs
+    volatile gint next_block;
+    // Set by the first thread to notice the cancellation (or that the limit was reached), so the others can stop
+    // without asking the cancellable
+    volatile gint cancelled;
+
+    // Only the first `limit` matches in claim order are needed, 0 if all of them are
+    uint32_t limit;
+    // Number of blocks (in claim order) which are finished without any unfinished block before them and their matches
+    uint32_t num_leading_blocks;
+    uint32_t num_leading_results;
+    GMutex leading_blocks_mutex;
+} IndexStoreSearchContext;
+
 typedef enum {
     INDEX_STORE_WORKER_POOL_DATA_TYPE_SEARCH = 0,
     INDEX_STORE_WORKER_POOL_DATA_TYPE_ADD_ENTRIES,
     INDEX_STORE_WORKER_POOL_DATA_TYPE_REMOVE_ENTRIES,
     INDEX_STORE_WORKER_POOL_DATA_TYPE_ADD_TO_RESULTS,
     INDEX_STORE_WORKER_POOL_DATA_TYPE_REMOVE_FROM_RESULTS,
+    INDEX_STORE_WORKER_POOL_DATA_TYPE_SORT_BY_NAME,
+    INDEX_STORE_WORKER_POOL_DATA_TYPE_BUILD_INDEX,
     NUM_INDEX_STORE_WORKER_POOL_DATA_TYPES,
 } IndexStoreWorkerPoolDataType;
 
@@ -92,10 +204,9 @@ typedef struct {
         struct {
             FsearchQuery *query;
             GCancellable *cancellable;
-            DynamicArray *in;
+            IndexStoreSearchContext *ctx;
+            // Per thread buffer for the matches of all blocks this thread claimed
             DynamicArray *out;
-            uint32_t in_start_idx;
-            uint32_t in_end_idx;
             int32_t thread_id;
         } search;
 
@@ -112,6 +223,18 @@ typedef struct {
             FsearchDatabaseIndexPropertyFlags affected_sort_orders;
             bool marked;
         } update_results;
+
+        struct {
+            // In name order, unless it's a SORT_BY_NAME task
+            DynamicArray *entries;
+            FsearchDatabaseIndexProperty property;
+            FsearchDatabaseEntryType entry_type;
+            GCancellable *cancellable;
+            // The result of a SORT_BY_NAME task
+            DynamicArray *sorted_entries;
+            // The result of a BUILD_INDEX task
+            FsearchDatabaseChunkedArray *chunks;
+        } build_index;
     };
 } IndexStoreWorkerPoolData;
 
@@ -161,10 +284,40 @@ index_store_monitor_thread_func(gpointer user_data) {
     return NULL;
 }
 
+static void
+index_store_trigram_build_stop(FsearchDatabaseIndexStore *store) {
+    g_return_if_fail(store);
+    if (store->worker_trigram_build_source) {
+        g_source_destroy(store->worker_trigram_build_source);
+        g_clear_pointer(&store->worker_trigram_build_source, g_source_unref);
+    }
+    g_clear_pointer(&store->building_file_trigrams, fsearch_database_trigram_index_free);
+    g_clear_pointer(&store->building_folder_trigrams, fsearch_database_trigram_index_free);
+}
+
+static void
+index_store_trigram_indices_free(FsearchDatabaseIndexStore *store) {
+    g_return_if_fail(store);
+    index_store_trigram_build_stop(store);
+    g_clear_pointer(&store->file_trigrams, fsearch_database_trigram_index_free);
+    g_clear_pointer(&store->folder_trigrams, fsearch_database_trigram_index_free);
+}
+
+static void
+index_store_extension_indices_free(FsearchDatabaseIndexStore *store) {
+    g_return_if_fail(store);
+    g_clear_pointer(&store->file_extensions, fsearch_database_extension_index_free);
+    g_clear_pointer(&store->folder_extensions, fsearch_database_extension_index_free);
+}
+
 static void
 index_store_sorted_entries_free(FsearchDatabaseIndexStore *store) {
     g_return_if_fail(store);
 
+    index_store_trigram_indices_free(store);
+    index_store_extension_indices_free(store);
+    g_clear_pointer(&store->entry_ids, fsearch_database_entry_id_table_free);
+
     for (uint32_t i = 0; i < NUM_DATABASE_INDEX_PROPERTIES; ++i) {
         if (store->file_chunks[i]) {
             g_clear_pointer(&store->file_chunks[i], fsearch_database_chunked_array_unref);
@@ -175,6 +328,153 @@ index_store_sorted_entries_free(FsearchDatabaseIndexStore *store) {
     }
 }
 
+static DynamicArray *
+index_store_sort_by_name(DynamicArray *entries, GCancellable *cancellable) {
+    // Sorting by path before sorting by name leaves entries with the same name in path order
+    g_autoptr(DynamicArray) entries_by_path = fsearch_database_sort_entries_by_property(entries,
+                                                                                        DATABASE_INDEX_PROPERTY_PATH,
+                                                                                        cancellable);
+    return fsearch_database_sort_entries_by_property(entries_by_path, DATABASE_INDEX_PROPERTY_NAME, cancellable);
+}
+
+// Builds the index of `property` from `entries`, which must be in name order. The chains of all other indices continue
+// with name, so a stable sort by `property` alone completes them.
+static FsearchDatabaseChunkedArray *
+index_store_build_index(DynamicArray *entries,
+                        FsearchDatabaseIndexProperty property,
+                        FsearchDatabaseEntryType entry_type,
+                        GCancellable *cancellable) {
+    g_autoptr(DynamicArray) sorted = property == DATABASE_INDEX_PROPERTY_NAME
+                                       ? darray_ref(entries)
+                                       : fsearch_database_sort_entries_by_property(entries, property, cancellable);
+    return fsearch_database_chunked_array_new(sorted,
+                                              TRUE,
+                                              fsearch_database_sort_order_chain_for_property(property),
+                                              entry_type,
+                                              cancellable,
+                                              NULL);
+}
+
+// Ranks `folders` in the order of their full paths, so path comparisons of their contents get cheap
+static void
+index_store_rank_folders(DynamicArray *folders, GCancellable *cancellable) {
+    if (!folders || darray_get_num_items(folders) == 0) {
+        return;
+    }
+    g_autoptr(GTimer) timer = g_timer_new();
+    g_autoptr(DynamicArray) sorted_folders = darray_copy_borrowed(folders);
+    darray_sort_multi_threaded(sorted_folders,
+                               (DynamicArrayCompareDataFunc)db_entry_compare_entries_by_full_path,
+                               cancellable,
+                               NULL);
+    if (g_cancellable_is_cancelled(cancellable)) {
+        return;
+    }
+    // Ranks are only comparable when all of them get assigned at once, which is the case here
+    const uint32_t num_folders = darray_get_num_items(sorted_folders);
+    for (uint32_t i = 0; i < num_folders; ++i) {
+        db_entry_set_path_rank(darray_get_item(sorted_folders, i), i + 1);
+    }
+    g_debug("[index_store] ranked %u folders in %.3f ms", num_folders, g_timer_elapsed(timer, NULL) * 1000.0);
+}
+
+static void
+index_store_rank_folders_locked(FsearchDatabaseIndexStore *store) {
+    // Every fast sort index holds all folders, so any of them will do
+    for (uint32_t i = 0; i < NUM_DATABASE_INDEX_PROPERTIES; ++i) {
+        if (store->folder_chunks[i]) {
+            g_autoptr(DynamicArray) folders = fsearch_database_chunked_array_get_joined(store->folder_chunks[i]);
+            index_store_rank_folders(folders, NULL);
+            return;
+        }
+    }
+}
+
+static IndexStoreWorkerPoolData *
+index_store_enqueue_build_task(FsearchDatabaseIndexStore *store,
+                               IndexStoreWorkerPoolDataType type,
+                               DynamicArray *entries,
+                               FsearchDatabaseIndexProperty property,
+                               FsearchDatabaseEntryType entry_type,
+                               GCancellable *cancellable) {
+    IndexStoreWorkerPoolData *pool_data = g_new0(IndexStoreWorkerPoolData, 1);
+    pool_data->type = type;
+    pool_data->build_index.entries = entries;
+    pool_data->build_index.property = property;
+    pool_data->build_index.entry_type = entry_type;
+    pool_data->build_index.cancellable = cancellable;
+
+    g_thread_pool_push(store->worker_pool, pool_data, NULL);
+    return pool_data;
+}
+
+static void
+index_store_collect_workers(FsearchDatabaseIndexStore *store, uint32_t num_workers) {
+    for (uint32_t i = 0; i < num_workers; ++i) {
+        IndexStoreWorkerPoolData *pool_data = g_async_queue_pop(store->worker_pool_collect_queue);
+        g_assert_nonnull(pool_data);
+    }
+}
+
+// Builds the fast sort indices of all files and folders. Only the name order gets sorted from scratch, all other
+// indices are derived from it. The sorts of both entry types and then all ten indices run concurrently on the worker
+// pool, so building them takes about as long as the slowest of them instead of all of them together.
+static void
+index_store_build_indices(FsearchDatabaseIndexStore *store,
+                          DynamicArray *files,
+                          DynamicArray *folders,
+                          GCancellable *cancellable) {
+    g_autoptr(GTimer) timer = g_timer_new();
+
+    const FsearchDatabaseEntryType entry_types[] = {DATABASE_ENTRY_TYPE_FOLDER, DATABASE_ENTRY_TYPE_FILE};
+    DynamicArray *entries[] = {folders, files};
+    FsearchDatabaseChunkedArray **chunks[] = {store->folder_chunks, store->file_chunks};
+    const FsearchDatabaseIndexProperty properties[] = {
+        DATABASE_INDEX_PROPERTY_NAME,
+        DATABASE_INDEX_PROPERTY_PATH,
+        DATABASE_INDEX_PROPERTY_SIZE,
+        DATABASE_INDEX_PROPERTY_MODIFICATION_TIME,
+        DATABASE_INDEX_PROPERTY_EXTENSION,
+    };
+
+    IndexStoreWorkerPoolData *sort_tasks[G_N_ELEMENTS(entry_types)] = {NULL};
+    for (uint32_t i = 0; i < G_N_ELEMENTS(entry_types); ++i) {
+        sort_tasks[i] = index_store_enqueue_build_task(store,
+                                                       INDEX_STORE_WORKER_POOL_DATA_TYPE_SORT_BY_NAME,
+                                                       entries[i],
+                                                       DATABASE_INDEX_PROPERTY_NAME,
+                                                       entry_types[i],
+                                                       cancellable);
+    }
+    index_store_collect_workers(store, G_N_ELEMENTS(sort_tasks));
+
+    IndexStoreWorkerPoolData *build_tasks[G_N_ELEMENTS(entry_types)][G_N_ELEMENTS(properties)] = {{NULL}};
+    for (uint32_t i = 0; i < G_N_ELEMENTS(entry_types); ++i) {
+        for (uint32_t j = 0; j < G_N_ELEMENTS(properties); ++j) {
+            build_tasks[i][j] = index_store_enqueue_build_task(store,
+                                                               INDEX_STORE_WORKER_POOL_DATA_TYPE_BUILD_INDEX,
+                                                               sort_tasks[i]->build_index.sorted_entries,
+                                                               properties[j],
+                                                               entry_types[i],
+                                                               cancellable);
+        }
+    }
+    index_store_collect_workers(store, G_N_ELEMENTS(entry_types) * G_N_ELEMENTS(properties));
+
+    for (uint32_t i = 0; i < G_N_ELEMENTS(entry_types); ++i) {
+        for (uint32_t j = 0; j < G_N_ELEMENTS(properties); ++j) {
+            chunks[i][properties[j]] = build_tasks[i][j]->build_index.chunks;
+            g_free(build_tasks[i][j]);
+        }
+        g_clear_pointer(&sort_tasks[i]->build_index.sorted_entries, darray_unref);
+        g_free(sort_tasks[i]);
+    }
+
+    g_debug("[index_store] built %u indices in %.3f ms",
+            (uint32_t)(G_N_ELEMENTS(entry_types) * G_N_ELEMENTS(properties)),
+            g_timer_elapsed(timer, NULL) * 1000.0);
+}
+
 static void
 index_store_unlock_all_indices(FsearchDatabaseIndexStore *store) {
     g_return_if_fail(store);
@@ -224,32 +524,93 @@ index_store_has_index_with_same_path(const FsearchDatabaseIndexStore *store,
     return false;
 }
 
+static bool
+index_store_search_block(FsearchQuery *query,
+                         FsearchQueryMatchData *match_data,
+                         IndexStoreSearchContext *ctx,
+                         IndexStoreSearchBlock *block,
+                         DynamicArray *results,
+                         GCancellable *cancellable) {
+    block->results = results;
+    block->results_offset = darray_get_num_items(results);
+
+    for (uint32_t c = block->start_chunk; c <= block->end_chunk; c++) {
+        if (G_UNLIKELY(g_cancellable_is_cancelled(cancellable))) {
+            g_atomic_int_set(&ctx->cancelled, 1);
+        }
+        DynamicArray *chunk = darray_get_item(ctx->chunks, c);
+        const uint32_t num_items = darray_get_num_items(chunk);
+        for (uint32_t i = 0; i < num_items; i++) {
+            if (G_UNLIKELY(g_atomic_int_get(&ctx->cancelled))) {
+                block->num_results = darray_get_num_items(results) - block->results_offset;
+                block->stopped = true;
+                return false;
+            }
+            FsearchDatabaseEntry *entry = darray_get_item(chunk, i);
+            fsearch_query_match_data_set_entry(match_data, entry);
+            if (fsearch_query_match(query, match_data)) {
+                darray_add_item(results, entry);
+            }
+        }
+    }
+    block->num_results = darray_get_num_items(results) - block->results_offset;
+    return true;
+}
+
+static IndexStoreSearchBlock *
+search_context_get_block(IndexStoreSearchContext *ctx, uint32_t position) {
+    return &ctx->blocks[ctx->reverse ? ctx->num_blocks - 1 - position : position];
+}
+
+// Blocks are claimed in order, so once the leading finished blocks have more than `limit` matches, nothing the other
+// threads are still working on can make it into the results anymore. Waiting for one match past the limit tells a
+// search which got cut off apart from one which happens to have exactly `limit` matches.
+static void
+search_context_finish_block(IndexStoreSearchContext *ctx, IndexStoreSearchBlock *block) {
+    g_mutex_lock(&ctx->leading_blocks_mutex);
+    block->finished = true;
+    while (ctx->num_leading_blocks < ctx->num_blocks) {
+        IndexStoreSearchBlock *next = search_context_get_block(ctx, ctx->num_leading_blocks);
+        if (!next->finished) {
+            break;
+        }
+        ctx->num_leading_results += next->num_results;
+        ctx->num_leading_blocks++;
+    }
+    if (ctx->num_leading_results > ctx->limit) {
+        g_atomic_int_set(&ctx->cancelled, 1);
+    }
+    g_mutex_unlock(&ctx->leading_blocks_mutex);
+}
+
 static void
 index_store_search_worker(FsearchQuery *query,
-                          DynamicArray *entries,
+                          IndexStoreSearchContext *ctx,
                           DynamicArray *results,
                           int32_t thread_id,
-                          uint32_t start_idx,
-                          uint32_t end_idx,
                           GCancellable *cancellable) {
-    g_assert(entries);
-    g_assert(start_idx <= end_idx);
-    g_assert(end_idx < darray_get_num_items(entries));
+    g_assert(ctx);
+    g_assert(results);
 
     FsearchQueryMatchData *match_data = fsearch_query_match_data_new(NULL, NULL);
 
     fsearch_query_match_data_set_thread_id(match_data, thread_id);
 
-    for (uint32_t i = start_idx; i <= end_idx; i++) {
-        if (G_UNLIKELY(g_cancellable_is_cancelled(cancellable))) {
+    // Keep claiming blocks until they're all gone, so threads which got cheap blocks help out with the rest
+    while (true) {
+        const uint32_t position = (uint32_t)g_atomic_int_add(&ctx->next_block, 1);
+        if (position >= ctx->num_blocks) {
             break;
         }
-        FsearchDatabaseEntry *entry = darray_get_item(entries, i);
-        fsearch_query_match_data_set_entry(match_data, entry);
-        if (fsearch_query_match(query, match_data)) {
-            darray_add_item(results, entry);
+        IndexStoreSearchBlock *block = search_context_get_block(ctx, position);
+        if (!index_store_search_block(query, match_data, ctx, block, results, cancellable)) {
+            break;
+        }
+        if (ctx->limit > 0) {
+            search_context_finish_block(ctx, block);
         }
     }
+
     g_clear_pointer(&match_data, fsearch_query_match_data_free);
 }
 
@@ -327,6 +688,23 @@ index_store_enqueue_add_entries(FsearchDatabaseChunkedArray *chunks,
     g_thread_pool_push(pool, pool_data, NULL);
 }
 
+// The entries of `entries` which the trigram build in progress already went past, i.e. which need to be updated in the
+// new indices by the caller
+static DynamicArray *
+index_store_get_trigram_built_entries_locked(FsearchDatabaseIndexStore *store, DynamicArray *entries) {
+    // store->mutex must already be held by the caller
+    const uint32_t num_entries = darray_get_num_items(entries);
+    DynamicArray *built = darray_new(num_entries);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        FsearchDatabaseEntry *entry = darray_get_item(entries, i);
+        const uint32_t id = fsearch_database_entry_id_table_get_id(store->entry_ids, entry);
+        if (id != 0 && id < store->trigram_build_next_id) {
+            darray_add_item(built, entry);
+        }
+    }
+    return built;
+}
+
 void
 index_store_add_entries_locked(FsearchDatabaseIndexStore *store,
                                DynamicArray *files,
@@ -334,6 +712,9 @@ index_store_add_entries_locked(FsearchDatabaseIndexStore *store,
                                FsearchDatabaseIndexPropertyFlags affected_sort_orders) {
     g_return_if_fail(store);
 
+    store->content_types_pending = true;
+    g_cond_signal(&store->content_type_cond);
+
     uint32_t num_workers = 0;
 
     IndexStoreAddRemoveContext ctx = {
@@ -365,6 +746,34 @@ index_store_add_entries_locked(FsearchDatabaseIndexStore *store,
         g_assert_nonnull(pool_data);
         collected_wrokers++;
     }
+
+    // Entries which only changed their size or modification time don't affect the trigram and extension indices
+    if (fsearch_database_index_property_is_set(affected_sort_orders, DATABASE_INDEX_PROPERTY_NAME)) {
+        if (store->entry_ids) {
+            fsearch_database_entry_id_table_add(store->entry_ids, files);
+            fsearch_database_entry_id_table_add(store->entry_ids, folders);
+        }
+        if (files && store->file_trigrams) {
+            fsearch_database_trigram_index_add(store->file_trigrams, files);
+        }
+        if (folders && store->folder_trigrams) {
+            fsearch_database_trigram_index_add(store->folder_trigrams, folders);
+        }
+        if (files && store->building_file_trigrams) {
+            g_autoptr(DynamicArray) built_files = index_store_get_trigram_built_entries_locked(store, files);
+            fsearch_database_trigram_index_add(store->building_file_trigrams, built_files);
+        }
+        if (folders && store->building_folder_trigrams) {
+            g_autoptr(DynamicArray) built_folders = index_store_get_trigram_built_entries_locked(store, folders);
+            fsearch_database_trigram_index_add(store->building_folder_trigrams, built_folders);
+        }
+        if (files && store->file_extensions) {
+            fsearch_database_extension_index_add(store->file_extensions, files);
+        }
+        if (folders && store->folder_extensions) {
+            fsearch_database_extension_index_add(store->folder_extensions, folders);
+        }
+    }
 }
 
 static void
@@ -418,6 +827,16 @@ index_store_remove_entries_locked(FsearchDatabaseIndexStore *store,
                                   bool marked) {
     g_return_if_fail(store);
 
+    if (store->content_type_batch) {
+        // The entries might get freed, or their content type got reset because their content changed
+        for (uint32_t i = 0; files && i < darray_get_num_items(files); ++i) {
+            g_hash_table_remove(store->content_type_batch, darray_get_item(files, i));
+        }
+        for (uint32_t i = 0; folders && i < darray_get_num_items(folders); ++i) {
+            g_hash_table_remove(store->content_type_batch, darray_get_item(folders, i));
+        }
+    }
+
     uint32_t num_workers = 0;
 
     IndexStoreAddRemoveContext ctx = {
@@ -450,6 +869,41 @@ index_store_remove_entries_locked(FsearchDatabaseIndexStore *store,
         g_assert_nonnull(pool_data);
         collected_wrokers++;
     }
+
+    if (fsearch_database_index_property_is_set(affected_sort_orders, DATABASE_INDEX_PROPERTY_NAME)) {
+        if (files && store->file_trigrams) {
+            fsearch_database_trigram_index_remove(store->file_trigrams, files);
+        }
+        if (folders && store->folder_trigrams) {
+            fsearch_database_trigram_index_remove(store->folder_trigrams, folders);
+        }
+        if (files && store->building_file_trigrams) {
+            g_autoptr(DynamicArray) built_files = index_store_get_trigram_built_entries_locked(store, files);
+            fsearch_database_trigram_index_remove(store->building_file_trigrams, built_files);
+        }
+        if (folders && store->building_folder_trigrams) {
+            g_autoptr(DynamicArray) built_folders = index_store_get_trigram_built_entries_locked(store, folders);
+            fsearch_database_trigram_index_remove(store->building_folder_trigrams, built_folders);
+        }
+        if (store->worker_trigram_build_source && !store->building_file_trigrams) {
+            // The build is still handing out IDs. Removals move the following entries towards the start, so it
+            // steps back to not skip any of them. Entries which already got an ID keep it.
+            const uint32_t num_files = files ? darray_get_num_items(files) : 0;
+            const uint32_t num_folders = folders ? darray_get_num_items(folders) : 0;
+            store->trigram_build_file_position -= MIN(store->trigram_build_file_position, num_files);
+            store->trigram_build_folder_position -= MIN(store->trigram_build_folder_position, num_folders);
+        }
+        if (files && store->file_extensions) {
+            fsearch_database_extension_index_remove(store->file_extensions, files);
+        }
+        if (folders && store->folder_extensions) {
+            fsearch_database_extension_index_remove(store->folder_extensions, folders);
+        }
+        if (store->entry_ids) {
+            fsearch_database_entry_id_table_remove(store->entry_ids, files);
+            fsearch_database_entry_id_table_remove(store->entry_ids, folders);
+        }
+    }
 }
 
 static void
@@ -463,11 +917,9 @@ index_store_worker_pool_func(gpointer pool_data, gpointer user_data) {
     switch (data->type) {
     case INDEX_STORE_WORKER_POOL_DATA_TYPE_SEARCH: {
         index_store_search_worker(data->search.query,
-                                  data->search.in,
+                                  data->search.ctx,
                                   data->search.out,
                                   data->search.thread_id,
-                                  data->search.in_start_idx,
-                                  data->search.in_end_idx,
                                   data->search.cancellable);
         g_async_queue_push(store->worker_pool_collect_queue, data);
         break;
@@ -501,6 +953,20 @@ index_store_worker_pool_func(gpointer pool_data, gpointer user_data) {
         g_async_queue_push(store->worker_pool_collect_queue, data);
         break;
     }
+    case INDEX_STORE_WORKER_POOL_DATA_TYPE_SORT_BY_NAME: {
+        data->build_index.sorted_entries = index_store_sort_by_name(data->build_index.entries,
+                                                                    data->build_index.cancellable);
+        g_async_queue_push(store->worker_pool_collect_queue, data);
+        break;
+    }
+    case INDEX_STORE_WORKER_POOL_DATA_TYPE_BUILD_INDEX: {
+        data->build_index.chunks = index_store_build_index(data->build_index.entries,
+                                                           data->build_index.property,
+                                                           data->build_index.entry_type,
+                                                           data->build_index.cancellable);
+        g_async_queue_push(store->worker_pool_collect_queue, data);
+        break;
+    }
     default:
         g_assert_not_reached();
         break;
@@ -670,10 +1136,238 @@ index_store_root_reappear_poll_cb(gpointer user_data) {
     return G_SOURCE_CONTINUE;
 }
 
+// Collects the entries of `chunked_array`, starting at `*position`, whose content type isn't known yet, until
+// `entries` holds CONTENT_TYPE_BATCH_SIZE of them
+static void
+content_type_batch_collect(FsearchDatabaseChunkedArray *chunked_array,
+                           uint32_t *position,
+                           DynamicArray *entries,
+                           GPtrArray *paths) {
+    g_autoptr(DynamicArray) chunks = fsearch_database_chunked_array_get_chunks(chunked_array);
+    uint32_t chunk_start = 0;
+    for (uint32_t i = 0; i < darray_get_num_items(chunks); ++i) {
+        DynamicArray *chunk = darray_get_item(chunks, i);
+        const uint32_t num_items = darray_get_num_items(chunk);
+        for (uint32_t j = MAX(*position, chunk_start) - chunk_start; j < num_items; ++j) {
+            if (darray_get_num_items(entries) >= CONTENT_TYPE_BATCH_SIZE) {
+                *position = chunk_start + j;
+                return;
+            }
+            FsearchDatabaseEntry *entry = darray_get_item(chunk, j);
+            if (db_entry_get_content_type(entry) == 0) {
+                darray_add_item(entries, entry);
+                g_ptr_array_add(paths, g_string_free(db_entry_get_path_full(entry), FALSE));
+            }
+        }
+        chunk_start += num_items;
+    }
+    *position = chunk_start;
+}
+
+// Determines the content types of the next batch of entries. The store lock gets released during the file system
+// lookups.
+static void
+index_store_content_type_batch_locked(FsearchDatabaseIndexStore *store) {
+    // store->mutex must already be held by the caller
+    FsearchDatabaseChunkedArray *folder_chunks = store->folder_chunks[DATABASE_INDEX_PROPERTY_NAME];
+    FsearchDatabaseChunkedArray *file_chunks = store->file_chunks[DATABASE_INDEX_PROPERTY_NAME];
+    if (!folder_chunks || !file_chunks) {
+        // Nothing to look up until entries get added
+        store->content_types_pending = false;
+        return;
+    }
+
+    g_autoptr(DynamicArray) entries = darray_new(CONTENT_TYPE_BATCH_SIZE);
+    g_autoptr(GPtrArray) paths = g_ptr_array_new_with_free_func(g_free);
+    uint32_t folder_position = store->content_type_folder_position;
+    uint32_t file_position = store->content_type_file_position;
+    content_type_batch_collect(folder_chunks, &folder_position, entries, paths);
+    content_type_batch_collect(file_chunks, &file_position, entries, paths);
+
+    const uint32_t num_entries = darray_get_num_items(entries);
+    store->content_type_batch = g_hash_table_new(NULL, NULL);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        g_hash_table_add(store->content_type_batch, darray_get_item(entries, i));
+    }
+
+    g_mutex_unlock(&store->mutex);
+    g_autofree GQuark *content_types = g_new0(GQuark, MAX(num_entries, 1));
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        content_types[i] = db_entry_query_content_type(g_ptr_array_index(paths, i));
+    }
+    g_mutex_lock(&store->mutex);
+
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        FsearchDatabaseEntry *entry = darray_get_item(entries, i);
+        if (g_hash_table_contains(store->content_type_batch, entry)) {
+            db_entry_set_content_type(entry, content_types[i]);
+        }
+    }
+    g_clear_pointer(&store->content_type_batch, g_hash_table_unref);
+    store->content_types_found |= num_entries > 0;
+
+    // The indices might have been replaced in the meantime
+    folder_chunks = store->folder_chunks[DATABASE_INDEX_PROPERTY_NAME];
+    file_chunks = store->file_chunks[DATABASE_INDEX_PROPERTY_NAME];
+    if (!folder_chunks || !file_chunks
+        || (folder_position >= fsearch_database_chunked_array_get_num_entries(folder_chunks)
+            && file_position >= fsearch_database_chunked_array_get_num_entries(file_chunks))) {
+        // End of a pass over all entries. Entries which were added during the pass might have ended up before the
+        // position, so only a pass which didn't find anything means that all content types are known.
+        if (!store->content_types_found) {
+            g_debug("[index_store] content types of all entries are known");
+            store->content_types_pending = false;
+        }
+        store->content_types_found = false;
+        folder_position = 0;
+        file_position = 0;
+    }
+    store->content_type_folder_position = folder_position;
+    store->content_type_file_position = file_position;
+}
+
+static gpointer
+index_store_content_type_thread_func(gpointer user_data) {
+    FsearchDatabaseIndexStore *store = user_data;
+
+    g_mutex_lock(&store->mutex);
+    while (!store->content_type_thread_quit) {
+        if (!store->running || !store->content_types_pending) {
+            // Gets woken up once the store is running or entries were added
+            g_cond_wait(&store->content_type_cond, &store->mutex);
+            continue;
+        }
+        index_store_content_type_batch_locked(store);
+
+        // Leave the file system (and the store lock) alone for a bit
+        const int64_t end_time = g_get_monotonic_time() + CONTENT_TYPE_BATCH_INTERVAL_MS * G_TIME_SPAN_MILLISECOND;
+        while (!store->content_type_thread_quit
+               && g_cond_wait_until(&store->content_type_cond, &store->mutex, end_time)) {
+            // Woken up early, e.g. because entries were added
+        }
+    }
+    g_mutex_unlock(&store->mutex);
+
+    return NULL;
+}
+
+// Adds the entries of `chunked_array` from `*position` on to `entries`, until it holds `max_entries` of them
+static void
+trigram_build_collect(FsearchDatabaseChunkedArray *chunked_array,
+                      uint32_t *position,
+                      DynamicArray *entries,
+                      uint32_t max_entries) {
+    g_autoptr(DynamicArray) chunks = fsearch_database_chunked_array_get_chunks(chunked_array);
+    uint32_t chunk_start = 0;
+    for (uint32_t i = 0; i < darray_get_num_items(chunks); ++i) {
+        DynamicArray *chunk = darray_get_item(chunks, i);
+        const uint32_t num_items = darray_get_num_items(chunk);
+        for (uint32_t j = MAX(*position, chunk_start) - chunk_start; j < num_items; ++j) {
+            if (darray_get_num_items(entries) >= max_entries) {
+                *position = chunk_start + j;
+                return;
+            }
+            darray_add_item(entries, darray_get_item(chunk, j));
+        }
+        chunk_start += num_items;
+    }
+    *position = chunk_start;
+}
+
+static gboolean
+index_store_trigram_build_cb(gpointer user_data) {
+    FsearchDatabaseIndexStore *store = user_data;
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&store->mutex);
+    g_assert_nonnull(locker);
+    if (g_source_is_destroyed(g_main_current_source())) {
+        // The build got stopped while this slice was waiting for the lock
+        return G_SOURCE_REMOVE;
+    }
+    FsearchDatabaseChunkedArray *folder_chunks = store->folder_chunks[DATABASE_INDEX_PROPERTY_NAME];
+    FsearchDatabaseChunkedArray *file_chunks = store->file_chunks[DATABASE_INDEX_PROPERTY_NAME];
+    if (!folder_chunks || !file_chunks) {
+        return G_SOURCE_CONTINUE;
+    }
+
+    if (!store->building_file_trigrams) {
+        g_autoptr(DynamicArray) entries = darray_new(TRIGRAM_BUILD_SLICE_SIZE);
+        trigram_build_collect(folder_chunks, &store->trigram_build_folder_position, entries, TRIGRAM_BUILD_SLICE_SIZE);
+        trigram_build_collect(file_chunks, &store->trigram_build_file_position, entries, TRIGRAM_BUILD_SLICE_SIZE);
+        if (darray_get_num_items(entries) > 0) {
+            fsearch_database_entry_id_table_add(store->entry_ids, entries);
+            return G_SOURCE_CONTINUE;
+        }
+        // Every entry has an ID now, new ones get theirs when they're added
+        store->building_file_trigrams = fsearch_database_trigram_index_new(store->entry_ids, NULL);
+        store->building_folder_trigrams = fsearch_database_trigram_index_new(store->entry_ids, NULL);
+        store->trigram_build_next_id = 1;
+    }
+
+    const uint32_t num_ids = fsearch_database_entry_id_table_get_num_ids(store->entry_ids);
+    const uint32_t end_id = store->trigram_build_next_id + MIN(num_ids - store->trigram_build_next_id,
+                                                               TRIGRAM_BUILD_SLICE_SIZE);
+    g_autoptr(DynamicArray) files = darray_new(TRIGRAM_BUILD_SLICE_SIZE);
+    g_autoptr(DynamicArray) folders = darray_new(1024);
+    for (uint32_t id = store->trigram_build_next_id; id < end_id; ++id) {
+        FsearchDatabaseEntry *entry = fsearch_database_entry_id_table_get_entry(store->entry_ids, id);
+        if (entry) {
+            darray_add_item(db_entry_is_folder(entry) ? folders : files, entry);
+        }
+    }
+    fsearch_database_trigram_index_add(store->building_file_trigrams, files);
+    fsearch_database_trigram_index_add(store->building_folder_trigrams, folders);
+    store->trigram_build_next_id = end_id;
+    if (end_id < num_ids) {
+        return G_SOURCE_CONTINUE;
+    }
+
+    store->file_trigrams = g_steal_pointer(&store->building_file_trigrams);
+    store->folder_trigrams = g_steal_pointer(&store->building_folder_trigrams);
+    g_clear_pointer(&store->worker_trigram_build_source, g_source_unref);
+    g_debug("[index_store] trigram index built: %u file trigrams, %u folder trigrams in %.3f ms",
+            fsearch_database_trigram_index_get_num_trigrams(store->file_trigrams),
+            fsearch_database_trigram_index_get_num_trigrams(store->folder_trigrams),
+            (double)(g_get_monotonic_time() - store->trigram_build_start_time) / 1000.0);
+    return G_SOURCE_REMOVE;
+}
+
+// Starts building the trigram indices on the worker thread, unless they're disabled, already there or being built
+static void
+index_store_trigram_build_start_locked(FsearchDatabaseIndexStore *store) {
+    // store->mutex must already be held by the caller
+    if (!store->trigram_index_enabled || !store->running || store->file_trigrams
+        || store->worker_trigram_build_source) {
+        return;
+    }
+    if (!store->entry_ids) {
+        store->entry_ids = fsearch_database_entry_id_table_new();
+    }
+    store->trigram_build_folder_position = 0;
+    store->trigram_build_file_position = 0;
+    store->trigram_build_next_id = 0;
+    store->trigram_build_start_time = g_get_monotonic_time();
+
+    store->worker_trigram_build_source = g_idle_source_new();
+    g_source_set_priority(store->worker_trigram_build_source, G_PRIORITY_LOW);
+    g_source_set_callback(store->worker_trigram_build_source, index_store_trigram_build_cb, store, NULL);
+    g_source_attach(store->worker_trigram_build_source, store->worker.ctx);
+}
+
 static void
 index_store_free(FsearchDatabaseIndexStore *store) {
     g_return_if_fail(store);
 
+    if (store->content_type_thread) {
+        g_mutex_lock(&store->mutex);
+        store->content_type_thread_quit = true;
+        g_cond_signal(&store->content_type_cond);
+        g_mutex_unlock(&store->mutex);
+        g_thread_join(g_steal_pointer(&store->content_type_thread));
+    }
+
+    index_store_trigram_build_stop(store);
+
     if (store->worker_index_root_reappear_poll_source) {
         g_source_destroy(store->worker_index_root_reappear_poll_source);
         g_clear_pointer(&store->worker_index_root_reappear_poll_source, g_source_unref);
@@ -721,6 +1415,9 @@ index_store_free(FsearchDatabaseIndexStore *store) {
     }
     g_clear_pointer(&store->monitor.ctx, g_main_context_unref);
 
+    g_clear_pointer(&store->streaming_view, fsearch_database_search_view_free);
+    g_mutex_clear(&store->streaming_mutex);
+    g_cond_clear(&store->content_type_cond);
     g_mutex_clear(&store->mutex);
 
     g_free(store);
@@ -736,6 +1433,8 @@ fsearch_database_index_store_new(FsearchDatabaseIncludeManager *include_manager,
 
     // Must be initialized before any thread/source below can lock it.
     g_mutex_init(&store->mutex);
+    g_mutex_init(&store->streaming_mutex);
+    g_cond_init(&store->content_type_cond);
     store->ref_count = 1;
 
     store->indices = g_ptr_array_new_with_free_func((GDestroyNotify)fsearch_database_index_unref);
@@ -774,6 +1473,13 @@ fsearch_database_index_store_new(FsearchDatabaseIncludeManager *include_manager,
     g_source_set_callback(store->worker_index_root_reappear_poll_source, index_store_root_reappear_poll_cb, store, NULL);
     g_source_attach(store->worker_index_root_reappear_poll_source, store->worker.ctx);
 
+    if (fsearch_database_index_property_is_set(flags, DATABASE_INDEX_PROPERTY_FILETYPE)) {
+        store->content_types_pending = true;
+        store->content_type_thread = g_thread_new("FsearchDatabaseIndexStoreContentTypes",
+                                                  index_store_content_type_thread_func,
+                                                  store);
+    }
+
     return store;
 }
 
@@ -822,7 +1528,11 @@ fsearch_database_index_store_new_with_content(GPtrArray *indices,
     store->is_sorted = true;
     g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&store->mutex);
     g_assert_nonnull(locker);
+    // Ranks aren't stored in the database file
+    index_store_rank_folders_locked(store);
     store->running = true;
+    g_cond_signal(&store->content_type_cond);
+    index_store_trigram_build_start_locked(store);
 
     return store;
 }
@@ -922,76 +1632,9 @@ fsearch_database_index_store_start(FsearchDatabaseIndexStore *store, GCancellabl
     }
 
     index_store_lock_all_indices(store);
-    store->folder_chunks[DATABASE_INDEX_PROPERTY_NAME] = fsearch_database_chunked_array_new(
-        store_folders,
-        FALSE,
-        fsearch_database_sort_order_chain_for_property(DATABASE_INDEX_PROPERTY_NAME),
-        DATABASE_ENTRY_TYPE_FOLDER,
-        cancellable,
-        NULL);
-    store->file_chunks[DATABASE_INDEX_PROPERTY_NAME] = fsearch_database_chunked_array_new(
-        store_files,
-        FALSE,
-        fsearch_database_sort_order_chain_for_property(DATABASE_INDEX_PROPERTY_NAME),
-        DATABASE_ENTRY_TYPE_FILE,
-        cancellable,
-        NULL);
-    store->folder_chunks[DATABASE_INDEX_PROPERTY_PATH] = fsearch_database_chunked_array_new(
-        store_folders,
-        FALSE,
-        fsearch_database_sort_order_chain_for_property(DATABASE_INDEX_PROPERTY_PATH),
-        DATABASE_ENTRY_TYPE_FOLDER,
-        cancellable,
-        NULL);
-    store->file_chunks[DATABASE_INDEX_PROPERTY_PATH] = fsearch_database_chunked_array_new(
-        store_files,
-        FALSE,
-        fsearch_database_sort_order_chain_for_property(DATABASE_INDEX_PROPERTY_PATH),
-        DATABASE_ENTRY_TYPE_FILE,
-        cancellable,
-        NULL);
-    store->folder_chunks[DATABASE_INDEX_PROPERTY_SIZE] = fsearch_database_chunked_array_new(
-        store_folders,
-        FALSE,
-        fsearch_database_sort_order_chain_for_property(DATABASE_INDEX_PROPERTY_SIZE),
-        DATABASE_ENTRY_TYPE_FOLDER,
-        cancellable,
-        NULL);
-    store->file_chunks[DATABASE_INDEX_PROPERTY_SIZE] = fsearch_database_chunked_array_new(
-        store_files,
-        FALSE,
-        fsearch_database_sort_order_chain_for_property(DATABASE_INDEX_PROPERTY_SIZE),
-        DATABASE_ENTRY_TYPE_FILE,
-        cancellable,
-        NULL);
-    store->folder_chunks[DATABASE_INDEX_PROPERTY_MODIFICATION_TIME] = fsearch_database_chunked_array_new(
-        store_folders,
-        FALSE,
-        fsearch_database_sort_order_chain_for_property(DATABASE_INDEX_PROPERTY_MODIFICATION_TIME),
-        DATABASE_ENTRY_TYPE_FOLDER,
-        cancellable,
-        NULL);
-    store->file_chunks[DATABASE_INDEX_PROPERTY_MODIFICATION_TIME] = fsearch_database_chunked_array_new(
-        store_files,
-        FALSE,
-        fsearch_database_sort_order_chain_for_property(DATABASE_INDEX_PROPERTY_MODIFICATION_TIME),
-        DATABASE_ENTRY_TYPE_FILE,
-        cancellable,
-        NULL);
-    store->folder_chunks[DATABASE_INDEX_PROPERTY_EXTENSION] = fsearch_database_chunked_array_new(
-        store_folders,
-        FALSE,
-        fsearch_database_sort_order_chain_for_property(DATABASE_INDEX_PROPERTY_EXTENSION),
-        DATABASE_ENTRY_TYPE_FOLDER,
-        cancellable,
-        NULL);
-    store->file_chunks[DATABASE_INDEX_PROPERTY_EXTENSION] = fsearch_database_chunked_array_new(
-        store_files,
-        FALSE,
-        fsearch_database_sort_order_chain_for_property(DATABASE_INDEX_PROPERTY_EXTENSION),
-        DATABASE_ENTRY_TYPE_FILE,
-        cancellable,
-        NULL);
+    // Ranking the folders first makes all the path comparisons of the following sorts cheap
+    index_store_rank_folders(store_folders, cancellable);
+    index_store_build_indices(store, store_files, store_folders, cancellable);
     store->is_sorted = true;
     index_store_unlock_all_indices(store);
 
@@ -1004,6 +1647,8 @@ fsearch_database_index_store_start(FsearchDatabaseIndexStore *store, GCancellabl
     g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&store->mutex);
     g_assert_nonnull(locker);
     store->running = true;
+    g_cond_signal(&store->content_type_cond);
+    index_store_trigram_build_start_locked(store);
 
     return;
 }
@@ -1112,6 +1757,9 @@ fsearch_database_index_store_replace_index(FsearchDatabaseIndexStore *store, Fse
     index_store_add_entries_locked(store, new_files, new_folders, DATABASE_INDEX_PROPERTY_FLAG_ALL);
     fsearch_database_index_unlock(new_index);
 
+    // The new folders aren't ranked yet, which would make comparing their paths slow
+    index_store_rank_folders_locked(store);
+
     // 5. Enable monitoring on the new index.
     fsearch_database_index_start_monitoring(new_index, true);
 
@@ -1186,6 +1834,26 @@ fsearch_database_index_store_unlock(FsearchDatabaseIndexStore *store) {
     g_mutex_unlock(&store->mutex);
 }
 
+void
+fsearch_database_index_store_set_trigram_index_enabled(FsearchDatabaseIndexStore *store, bool enabled) {
+    // store->mutex must already be held by the caller
+    g_return_if_fail(store);
+    store->trigram_index_enabled = enabled;
+    if (enabled) {
+        index_store_trigram_build_start_locked(store);
+    }
+    else {
+        index_store_trigram_indices_free(store);
+    }
+}
+
+bool
+fsearch_database_index_store_has_trigram_index(FsearchDatabaseIndexStore *store) {
+    // store->mutex must already be held by the caller
+    g_return_val_if_fail(store, false);
+    return store->file_trigrams && store->folder_trigrams;
+}
+
 /* Data Accessors */
 FsearchDatabaseChunkedArray *
 fsearch_database_index_store_get_files(FsearchDatabaseIndexStore *store, FsearchDatabaseIndexProperty sort_order) {
@@ -1251,6 +1919,18 @@ fsearch_database_index_store_get_search_view(FsearchDatabaseIndexStore *store, u
     return g_hash_table_lookup(store->search_results, GUINT_TO_POINTER(view_id));
 }
 
+static FsearchDatabaseEntryInfo *
+search_view_get_entry_info(FsearchDatabaseSearchView *view, uint32_t idx, FsearchDatabaseEntryInfoFlags flags) {
+    FsearchDatabaseEntry *entry = fsearch_database_search_view_get_entry_for_idx(view, idx);
+    if (!entry) {
+        return NULL;
+    }
+
+    g_autoptr(FsearchQuery) query = fsearch_database_search_view_get_query(view);
+
+    return fsearch_database_entry_info_new(entry, query, idx, fsearch_database_search_view_is_selected(view, entry), flags);
+}
+
 FsearchDatabaseEntryInfo *
 fsearch_database_index_store_get_entry_info(FsearchDatabaseIndexStore *store,
                                             uint32_t idx,
@@ -1262,15 +1942,26 @@ fsearch_database_index_store_get_entry_info(FsearchDatabaseIndexStore *store,
     if (!view) {
         return NULL;
     }
+    return search_view_get_entry_info(view, idx, flags);
+}
 
-    FsearchDatabaseEntry *entry = fsearch_database_search_view_get_entry_for_idx(view, idx);
-    if (!entry) {
-        return NULL;
-    }
+FsearchDatabaseEntryInfo *
+fsearch_database_index_store_get_streaming_entry_info(FsearchDatabaseIndexStore *store,
+                                                      uint32_t idx,
+                                                      uint32_t id,
+                                                      FsearchDatabaseEntryInfoFlags flags) {
+    g_return_val_if_fail(store, NULL);
 
-    g_autoptr(FsearchQuery) query = fsearch_database_search_view_get_query(view);
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&store->streaming_mutex);
+    g_assert_nonnull(locker);
 
-    return fsearch_database_entry_info_new(entry, query, idx, fsearch_database_search_view_is_selected(view, entry), flags);
+    FsearchDatabaseSearchView *view = store->streaming_view;
+    if (!view || fsearch_database_search_view_get_id(view) != id) {
+        return NULL;
+    }
+    // The search threads use the per thread match data of the query, so highlighting with it here could race with
+    // them. The rows get fetched again with highlights once the search finished.
+    return search_view_get_entry_info(view, idx, flags & ~FSEARCH_DATABASE_ENTRY_INFO_FLAG_HIGHLIGHTS);
 }
 
 uint32_t
@@ -1316,86 +2007,895 @@ fsearch_database_index_store_sort_results(FsearchDatabaseIndexStore *store,
     g_autoptr(FsearchDatabaseChunkedArray) folders_fast_sort_index = fsearch_database_index_store_get_folders(store,
                                                                                                               sort_order);
 
-    g_autoptr(DynamicArray) files_fast_sorted = NULL;
-    g_autoptr(DynamicArray) folders_fast_sorted = NULL;
-    if (files_fast_sort_index && folders_fast_sort_index) {
-        files_fast_sorted = fsearch_database_chunked_array_get_joined(files_fast_sort_index);
-        folders_fast_sorted = fsearch_database_chunked_array_get_joined(folders_fast_sort_index);
-    }
-    fsearch_database_search_view_sort(view, files_fast_sorted, folders_fast_sorted, sort_order, sort_type, cancellable);
+    fsearch_database_search_view_sort(view,
+                                      files_fast_sort_index,
+                                      folders_fast_sort_index,
+                                      sort_order,
+                                      sort_type,
+                                      cancellable);
 }
 
+// Sets `limited` if matches got cut off at the limit, or might have been because blocks weren't searched to their end
 static DynamicArray *
-collect_search_results(DynamicArray *pool_data_array) {
+collect_search_results(IndexStoreSearchContext *ctx, bool *limited) {
     uint32_t num_entries_found = 0;
-    for (uint32_t i = 0; i < darray_get_num_items(pool_data_array); ++i) {
-        IndexStoreWorkerPoolData *data = darray_get_item(pool_data_array, i);
-        num_entries_found += darray_get_num_items(data->search.out);
+    bool all_blocks_searched = true;
+    for (uint32_t i = 0; i < ctx->num_blocks; ++i) {
+        num_entries_found += ctx->blocks[i].num_results;
+        if (!ctx->blocks[i].results || ctx->blocks[i].stopped) {
+            all_blocks_searched = false;
+        }
     }
-    g_autoptr(DynamicArray) search_entries = darray_new(num_entries_found);
-
-    for (uint32_t i = 0; i < darray_get_num_items(pool_data_array); ++i) {
-        IndexStoreWorkerPoolData *data = darray_get_item(pool_data_array, i);
-        darray_add_array(search_entries, data->search.out);
-
-        g_clear_pointer(&data->search.out, darray_unref);
+    if (limited && ctx->limit > 0 && (num_entries_found > ctx->limit || !all_blocks_searched)) {
+        *limited = true;
     }
 
-    return g_steal_pointer(&search_entries);
-}
+    // With a limit, the leading blocks have all the matches which are needed, the ones after them (which might have
+    // been stopped partway through) get cut off
+    uint32_t num_skipped = 0;
+    uint32_t num_kept = num_entries_found;
+    if (ctx->limit > 0 && num_entries_found > ctx->limit) {
+        num_kept = ctx->limit;
+        num_skipped = ctx->reverse ? num_entries_found - ctx->limit : 0;
+    }
+    DynamicArray *search_entries = darray_new(num_kept);
 
-static inline uint32_t
-sub_or_zero_u32(uint32_t a, uint32_t b) {
-    return a > b ? a - b : 0;
-}
+    // Blocks were claimed in arbitrary order by arbitrary threads, but the blocks themselves are in index order
+    for (uint32_t i = 0; i < ctx->num_blocks; ++i) {
+        IndexStoreSearchBlock *block = &ctx->blocks[i];
+        if (!block->results || block->num_results == 0) {
+            continue;
+        }
+        uint32_t offset = block->results_offset;
+        uint32_t num_results = block->num_results;
+        if (num_skipped > 0) {
+            const uint32_t num_block_skipped = MIN(num_skipped, num_results);
+            offset += num_block_skipped;
+            num_results -= num_block_skipped;
+            num_skipped -= num_block_skipped;
+        }
+        num_results = MIN(num_results, num_kept - darray_get_num_items(search_entries));
+        if (num_results > 0) {
+            darray_add_array_range(search_entries, block->results, offset, num_results);
+        }
+    }
+
+    return search_entries;
+}
+
+static IndexStoreSearchBlock *
+split_chunks_into_blocks(DynamicArray *chunks, uint32_t *num_blocks_out) {
+    const uint32_t num_chunks = darray_get_num_items(chunks);
+    IndexStoreSearchBlock *blocks = g_new0(IndexStoreSearchBlock, num_chunks);
+
+    // Chunks are small compared to a block, so a block is made up of consecutive whole chunks
+    uint32_t num_blocks = 0;
+    uint32_t start_chunk = 0;
+    while (start_chunk < num_chunks) {
+        uint32_t end_chunk = start_chunk;
+        uint32_t num_block_entries = darray_get_num_items(darray_get_item(chunks, start_chunk));
+        while (end_chunk + 1 < num_chunks && num_block_entries < SEARCH_BLOCK_SIZE) {
+            end_chunk++;
+            num_block_entries += darray_get_num_items(darray_get_item(chunks, end_chunk));
+        }
+        blocks[num_blocks].start_chunk = start_chunk;
+        blocks[num_blocks].end_chunk = end_chunk;
+        num_blocks++;
+
+        start_chunk = end_chunk + 1;
+    }
+
+    *num_blocks_out = num_blocks;
+    return blocks;
+}
+
+// Queries which look up content types need to be searched single threaded, unless the content types are indexed. Then
+// only the lookups of the entries whose content type isn't known yet are done one at a time.
+static bool
+index_store_wants_single_threaded_search(FsearchDatabaseIndexStore *store, FsearchQuery *query) {
+    return query->wants_single_threaded_search
+        && !fsearch_database_index_property_is_set(store->flags, DATABASE_INDEX_PROPERTY_FILETYPE);
+}
 
 static DynamicArray *
-search_entries(FsearchQuery *query,
-               DynamicArray *in,
-               GThreadPool *pool,
-               GAsyncQueue *collect_queue,
-               GCancellable *cancellable) {
-    const uint32_t num_entries = darray_get_num_items(in);
+search_chunks(FsearchQuery *query,
+              DynamicArray *chunks,
+              uint32_t num_entries,
+              uint32_t limit,
+              bool reverse,
+              bool single_threaded,
+              GThreadPool *pool,
+              GAsyncQueue *collect_queue,
+              GCancellable *cancellable,
+              bool *limited) {
     if (num_entries == 0) {
         return darray_new(0);
     }
 
-    const uint32_t num_threads = (num_entries < THRESHOLD_FOR_PARALLEL_SEARCH || query->wants_single_threaded_search)
+    IndexStoreSearchContext ctx = {
+        .chunks = chunks,
+        .reverse = reverse,
+        .next_block = 0,
+        .cancelled = 0,
+        .limit = limit,
+    };
+    ctx.blocks = split_chunks_into_blocks(chunks, &ctx.num_blocks);
+    g_mutex_init(&ctx.leading_blocks_mutex);
+
+    const uint32_t num_threads = (num_entries < THRESHOLD_FOR_PARALLEL_SEARCH || single_threaded)
                                    ? 1
                                    : g_thread_pool_get_num_threads(pool);
-    const uint32_t clamped_num_threads = MIN(num_threads, num_entries);
-    const uint32_t num_items_per_thread = num_entries / clamped_num_threads;
-    g_autoptr(DynamicArray) pool_data_array = darray_new_full(clamped_num_threads, (GDestroyNotify)g_free);
-
-    uint32_t start_pos = 0;
-    uint32_t end_pos = sub_or_zero_u32(num_items_per_thread, 1);
-    const uint32_t last_end_pos = sub_or_zero_u32(num_entries, 1);
+    const uint32_t clamped_num_threads = MIN(num_threads, ctx.num_blocks);
+    const uint32_t num_entries_per_thread = num_entries / clamped_num_threads;
+    g_autoptr(DynamicArray) thread_results = darray_new_full(clamped_num_threads, (GDestroyNotify)darray_unref);
 
     for (uint32_t i = 0; i < clamped_num_threads; ++i) {
         IndexStoreWorkerPoolData *pool_data = g_new0(IndexStoreWorkerPoolData, 1);
         pool_data->type = INDEX_STORE_WORKER_POOL_DATA_TYPE_SEARCH;
-        pool_data->search.in = in;
+        pool_data->search.ctx = &ctx;
         pool_data->search.query = query;
         pool_data->search.cancellable = cancellable;
         pool_data->search.thread_id = (int32_t)i;
-        pool_data->search.in_start_idx = start_pos;
-        pool_data->search.in_end_idx = i == clamped_num_threads - 1 ? last_end_pos : end_pos;
-        pool_data->search.out = darray_new(end_pos - start_pos + 1);
+        pool_data->search.out = darray_new(num_entries_per_thread);
 
-        darray_add_item(pool_data_array, pool_data);
+        darray_add_item(thread_results, pool_data->search.out);
         g_thread_pool_push(pool, pool_data, NULL);
+    }
+
+    for (uint32_t i = 0; i < clamped_num_threads; ++i) {
+        g_autofree IndexStoreWorkerPoolData *pool_data = g_async_queue_pop(collect_queue);
+        g_assert_nonnull(pool_data);
+    }
+
+    DynamicArray *results = collect_search_results(&ctx, limited);
+    g_clear_pointer(&ctx.blocks, g_free);
+    g_mutex_clear(&ctx.leading_blocks_mutex);
+
+    return results;
+}
+
+// With a `limit`, only the first that many matches get searched for, or the last ones if `reverse` is set. `limited`
+// gets set if any matches were dropped because of it.
+static DynamicArray *
+search_entries(FsearchQuery *query,
+               FsearchDatabaseChunkedArray *chunked_array,
+               uint32_t limit,
+               bool reverse,
+               bool single_threaded,
+               GThreadPool *pool,
+               GAsyncQueue *collect_queue,
+               GCancellable *cancellable,
+               bool *limited) {
+    // Search the chunks in place instead of joining them first, which would copy every entry of the
+    // index before the first one gets matched
+    g_autoptr(DynamicArray) chunks = fsearch_database_chunked_array_get_chunks(chunked_array);
+    return search_chunks(query,
+                         chunks,
+                         fsearch_database_chunked_array_get_num_entries(chunked_array),
+                         limit,
+                         reverse,
+                         single_threaded,
+                         pool,
+                         collect_queue,
+                         cancellable,
+                         limited);
+}
+
+typedef struct {
+    FsearchDatabaseIndexStore *store;
+    uint32_t id;
+    FsearchQuery *query;
+    FsearchDatabaseSortOrderChain chain;
+    GtkSortType sort_type;
+    // Matches in the parts of the index which were searched so far, in index order
+    DynamicArray *files;
+    DynamicArray *folders;
+    uint32_t num_published;
+} IndexStoreSearchStream;
+
+static void
+index_store_publish_streaming_view(IndexStoreSearchStream *stream) {
+    FsearchDatabaseIndexStore *store = stream->store;
+
+    const uint32_t num_found = darray_get_num_items(stream->files) + darray_get_num_items(stream->folders);
+    if (num_found == stream->num_published) {
+        return;
+    }
+    stream->num_published = num_found;
+
+    FsearchDatabaseSearchView *view = fsearch_database_search_view_new(stream->id,
+                                                                       stream->query,
+                                                                       stream->files,
+                                                                       stream->folders,
+                                                                       NULL,
+                                                                       stream->chain,
+                                                                       stream->sort_type,
+                                                                       false);
+    g_mutex_lock(&store->streaming_mutex);
+    g_clear_pointer(&store->streaming_view, fsearch_database_search_view_free);
+    store->streaming_view = view;
+    g_mutex_unlock(&store->streaming_mutex);
+
+    // Only this thread modifies the view, so it's fine to read it without the streaming mutex
+    store->event_func(store,
+                      FSEARCH_DATABASE_INDEX_STORE_EVENT_SEARCH_PROGRESS,
+                      fsearch_database_search_view_get_info(view),
+                      store->event_func_data);
+}
+
+static void
+index_store_clear_streaming_view(FsearchDatabaseIndexStore *store) {
+    g_mutex_lock(&store->streaming_mutex);
+    g_clear_pointer(&store->streaming_view, fsearch_database_search_view_free);
+    g_mutex_unlock(&store->streaming_mutex);
+}
+
+// Like search_entries, but searches the index in stages of growing size and publishes the matches found so far after
+// every stage. The matches end up in `*results`, which is either the files or folders array of `stream`. Descending
+// views show the end of the index first, so they get searched from the end on.
+static void
+search_entries_streaming(IndexStoreSearchStream *stream,
+                         FsearchDatabaseChunkedArray *chunked_array,
+                         DynamicArray **results,
+                         GCancellable *cancellable) {
+    FsearchDatabaseIndexStore *store = stream->store;
+    g_autoptr(DynamicArray) chunks = fsearch_database_chunked_array_get_chunks(chunked_array);
+    const uint32_t num_chunks = darray_get_num_items(chunks);
+    const bool reverse = stream->sort_type == GTK_SORT_DESCENDING;
+
+    uint32_t stage_size = STREAMING_FIRST_STAGE_SIZE;
+    uint32_t num_searched_chunks = 0;
+    while (num_searched_chunks < num_chunks && !g_cancellable_is_cancelled(cancellable)) {
+        uint32_t num_stage_chunks = 0;
+        uint32_t num_stage_entries = 0;
+        while (num_searched_chunks + num_stage_chunks < num_chunks && num_stage_entries < stage_size) {
+            const uint32_t idx = num_searched_chunks + num_stage_chunks;
+            num_stage_entries += darray_get_num_items(darray_get_item(chunks, reverse ? num_chunks - idx - 1 : idx));
+            num_stage_chunks++;
+        }
+
+        const uint32_t start_chunk = reverse ? num_chunks - num_searched_chunks - num_stage_chunks : num_searched_chunks;
+        g_autoptr(DynamicArray) stage_chunks = darray_get_range(chunks, start_chunk, num_stage_chunks);
+        g_autoptr(DynamicArray) stage_results = search_chunks(stream->query,
+                                                              stage_chunks,
+                                                              num_stage_entries,
+                                                              0,
+                                                              false,
+                                                              index_store_wants_single_threaded_search(store,
+                                                                                                       stream->query),
+                                                              store->worker_pool,
+                                                              store->worker_pool_collect_queue,
+                                                              cancellable,
+                                                              NULL);
+        if (reverse) {
+            // The matches of this stage come before all the ones found so far
+            g_autoptr(DynamicArray) later_results = *results;
+            *results = darray_new(darray_get_num_items(stage_results) + darray_get_num_items(later_results));
+            darray_add_array(*results, stage_results);
+            darray_add_array(*results, later_results);
+        }
+        else {
+            darray_add_array(*results, stage_results);
+        }
+
+        num_searched_chunks += num_stage_chunks;
+        if (stage_size <= UINT32_MAX / STREAMING_STAGE_GROWTH) {
+            stage_size *= STREAMING_STAGE_GROWTH;
+        }
+        if (num_searched_chunks < num_chunks && !g_cancellable_is_cancelled(cancellable)) {
+            index_store_publish_streaming_view(stream);
+        }
+    }
+}
+
+typedef int64_t (*IndexStoreRangeKeyFunc)(FsearchDatabaseEntry *entry);
+
+static int64_t
+range_key_size(FsearchDatabaseEntry *entry) {
+    return db_entry_get_size(entry);
+}
+
+static int64_t
+range_key_mtime(FsearchDatabaseEntry *entry) {
+    return db_entry_get_mtime(entry);
+}
+
+// The chunks of a fast sort index with the index of the first entry of every chunk, to address its entries by
+// their position in the whole index
+typedef struct {
+    DynamicArray *chunks;
+    uint32_t *offsets;
+    uint32_t num_chunks;
+    uint32_t num_entries;
+} IndexStoreRangeIndex;
+
+static FsearchDatabaseEntry *
+range_index_get_entry(IndexStoreRangeIndex *index, uint32_t idx) {
+    // The last chunk starting at or before idx, which skips over empty chunks
+    uint32_t lo = 0;
+    uint32_t hi = index->num_chunks;
+    while (hi - lo > 1) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (index->offsets[mid] <= idx) {
+            lo = mid;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return darray_get_item(darray_get_item(index->chunks, lo), idx - index->offsets[lo]);
+}
+
+// Position of the first entry whose key is at least `key`
+static uint32_t
+range_index_lower_bound(IndexStoreRangeIndex *index, IndexStoreRangeKeyFunc key_func, int64_t key) {
+    uint32_t lo = 0;
+    uint32_t hi = index->num_entries;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (key_func(range_index_get_entry(index, mid)) < key) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Chunks holding the entries [start, end) of the index. Whole chunks are shared, only the partially covered ones at
+// the edges get copied.
+static DynamicArray *
+range_index_get_slice(IndexStoreRangeIndex *index, uint32_t start, uint32_t end) {
+    DynamicArray *slice = darray_new_full(16, (GDestroyNotify)darray_unref);
+    for (uint32_t i = 0; i < index->num_chunks; ++i) {
+        const uint32_t chunk_start = index->offsets[i];
+        const uint32_t chunk_end = index->offsets[i + 1];
+        const uint32_t slice_start = MAX(start, chunk_start);
+        const uint32_t slice_end = MIN(end, chunk_end);
+        if (slice_start >= slice_end) {
+            continue;
+        }
+        DynamicArray *chunk = darray_get_item(index->chunks, i);
+        if (slice_start == chunk_start && slice_end == chunk_end) {
+            darray_add_item(slice, darray_ref(chunk));
+        }
+        else {
+            darray_add_item(slice, darray_get_range(chunk, slice_start - chunk_start, slice_end - slice_start));
+        }
+    }
+    return slice;
+}
+
+static void
+range_index_init(IndexStoreRangeIndex *index, FsearchDatabaseChunkedArray *chunked_array) {
+    index->chunks = fsearch_database_chunked_array_get_chunks(chunked_array);
+    index->num_chunks = darray_get_num_items(index->chunks);
+    index->offsets = g_new(uint32_t, index->num_chunks + 1);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < index->num_chunks; ++i) {
+        index->offsets[i] = offset;
+        offset += darray_get_num_items(darray_get_item(index->chunks, i));
+    }
+    index->offsets[index->num_chunks] = offset;
+    index->num_entries = offset;
+}
+
+static void
+range_index_clear(IndexStoreRangeIndex *index) {
+    g_clear_pointer(&index->chunks, darray_unref);
+    g_clear_pointer(&index->offsets, g_free);
+}
+
+// Matches only the slice of the size or modification time index which a range the query requires covers, instead of
+// all entries. Returns NULL if the query has no such range or the slice is too large to be worth it.
+static DynamicArray *
+search_range_slice(FsearchDatabaseIndexStore *store,
+                   FsearchQuery *query,
+                   FsearchDatabaseChunkedArray **chunks_by_property,
+                   FsearchDatabaseIndexProperty sort_order,
+                   GCancellable *cancellable) {
+    const struct {
+        FsearchDatabaseIndexProperty property;
+        const FsearchQueryRange *range;
+        IndexStoreRangeKeyFunc key_func;
+    } candidates[] = {
+        {DATABASE_INDEX_PROPERTY_SIZE, &query->required_size_range, range_key_size},
+        {DATABASE_INDEX_PROPERTY_MODIFICATION_TIME, &query->required_mtime_range, range_key_mtime},
+    };
+
+    IndexStoreRangeIndex best_index = {0};
+    FsearchDatabaseIndexProperty best_property = DATABASE_INDEX_PROPERTY_NONE;
+    uint32_t best_start = 0;
+    uint32_t best_end = 0;
+
+    for (uint32_t i = 0; i < G_N_ELEMENTS(candidates); ++i) {
+        const FsearchQueryRange *range = candidates[i].range;
+        FsearchDatabaseChunkedArray *chunked_array = chunks_by_property[candidates[i].property];
+        if (!range->is_set || !chunked_array) {
+            continue;
+        }
+
+        IndexStoreRangeIndex index = {0};
+        range_index_init(&index, chunked_array);
+        uint32_t start = 0;
+        uint32_t end = 0;
+        if (range->start <= range->end) {
+            start = range_index_lower_bound(&index, candidates[i].key_func, range->start);
+            end = range->end == INT64_MAX ? index.num_entries
+                                          : range_index_lower_bound(&index, candidates[i].key_func, range->end + 1);
+        }
+
+        // Prefer the smaller slice, and on a tie the one which is already in the right order
+        const uint32_t num_slice = end - start;
+        const uint32_t num_best = best_end - best_start;
+        if (best_property == DATABASE_INDEX_PROPERTY_NONE || num_slice < num_best
+            || (num_slice == num_best && candidates[i].property == sort_order)) {
+            range_index_clear(&best_index);
+            best_index = index;
+            best_property = candidates[i].property;
+            best_start = start;
+            best_end = end;
+        }
+        else {
+            range_index_clear(&index);
+        }
+    }
+
+    if (best_property == DATABASE_INDEX_PROPERTY_NONE) {
+        return NULL;
+    }
+
+    const uint32_t num_slice = best_end - best_start;
+    const bool needs_sort = best_property != sort_order;
+    if (needs_sort && num_slice > best_index.num_entries / RANGE_MAX_UNSORTED_SLICE_FRACTION) {
+        range_index_clear(&best_index);
+        return NULL;
+    }
+
+    g_autoptr(DynamicArray) slice = range_index_get_slice(&best_index, best_start, best_end);
+    range_index_clear(&best_index);
+
+    DynamicArray *results = search_chunks(query,
+                                          slice,
+                                          num_slice,
+                                          0,
+                                          false,
+                                          index_store_wants_single_threaded_search(store, query),
+                                          store->worker_pool,
+                                          store->worker_pool_collect_queue,
+                                          cancellable,
+                                          NULL);
+    if (needs_sort) {
+        // Same as for trigram candidates: even partial results need to be fully sorted
+        g_autoptr(FsearchDatabaseEntryCompareContext) ctx = db_entry_compare_context_new(
+            fsearch_database_sort_order_chain_for_property(sort_order));
+        darray_sort(results, (DynamicArrayCompareDataFunc)db_entry_compare_entries_by_chain, NULL, ctx);
+    }
+    return results;
+}
+
+// Whether the full path of `folder` is `path`, which makes it the parent of the entries a parent path match with that
+// needle matches
+static bool
+folder_has_path(FsearchDatabaseEntry *folder, const char *path, size_t path_len, bool match_case, GString *buffer) {
+    // Cheap check first, the path has to end with the folder's name (unless it's the root folder)
+    const char *name = db_entry_get_name_raw(folder);
+    const size_t name_len = strlen(name);
+    if (name_len > 0 && strcmp(name, G_DIR_SEPARATOR_S) != 0) {
+        if (name_len > path_len) {
+            return false;
+        }
+        const char *path_end = path + path_len - name_len;
+        if (match_case ? strcmp(path_end, name) != 0 : strcasecmp(path_end, name) != 0) {
+            return false;
+        }
+    }
+
+    g_string_truncate(buffer, 0);
+    db_entry_append_full_path(folder, buffer);
+    return match_case ? strcmp(buffer->str, path) == 0 : strcasecmp(buffer->str, path) == 0;
+}
+
+// Looks up the folders the parent path matches of the query refer to, once per search instead of building the parent
+// path of every entry. Picks the match with the fewest such folders (without case sensitivity there can be more than
+// one). Returns NULL if the query has no parent path match every entry must satisfy.
+static DynamicArray *
+index_store_resolve_parent_folders_locked(FsearchDatabaseIndexStore *store, FsearchQuery *query) {
+    // store->mutex must already be held by the caller
+    FsearchDatabaseChunkedArray *folder_chunks = store->folder_chunks[DATABASE_INDEX_PROPERTY_NAME];
+    if (!folder_chunks || !query->required_parent_nodes || query->required_parent_nodes->len == 0) {
+        return NULL;
+    }
+
+    g_autoptr(DynamicArray) chunks = fsearch_database_chunked_array_get_chunks(folder_chunks);
+    g_autoptr(GString) buffer = g_string_sized_new(256);
+    DynamicArray *best = NULL;
+    for (uint32_t i = 0; i < query->required_parent_nodes->len; ++i) {
+        FsearchQueryNode *node = g_ptr_array_index(query->required_parent_nodes, i);
+        const bool match_case = node->flags & QUERY_FLAG_MATCH_CASE;
+
+        DynamicArray *folders = darray_new(1);
+        for (uint32_t j = 0; j < darray_get_num_items(chunks); ++j) {
+            DynamicArray *chunk = darray_get_item(chunks, j);
+            for (uint32_t k = 0; k < darray_get_num_items(chunk); ++k) {
+                FsearchDatabaseEntry *folder = darray_get_item(chunk, k);
+                if (folder_has_path(folder, node->needle, node->needle_len, match_case, buffer)) {
+                    darray_add_item(folders, folder);
+                }
+            }
+        }
+
+        if (!best || darray_get_num_items(folders) < darray_get_num_items(best)) {
+            g_clear_pointer(&best, darray_unref);
+            best = folders;
+        }
+        else {
+            darray_unref(folders);
+        }
+    }
+    return best;
+}
+
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+} IndexStoreRange;
+
+static gint
+compare_ranges(gconstpointer a, gconstpointer b) {
+    const IndexStoreRange *range_a = a;
+    const IndexStoreRange *range_b = b;
+    return range_a->start < range_b->start ? -1 : range_a->start > range_b->start ? 1 : 0;
+}
+
+// Position of the first entry in the path index which sorts after the children of `folder` (`upper`) or doesn't sort
+// before them
+static uint32_t
+range_index_bound_for_folder(IndexStoreRangeIndex *index, FsearchDatabaseEntry *folder, bool upper) {
+    uint32_t lo = 0;
+    uint32_t hi = index->num_entries;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        const int res = db_entry_compare_path_with_folder(range_index_get_entry(index, mid), folder);
+        if (res < 0 || (upper && res == 0)) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Matches only the children of `parents`, which are next to each other in the path index, instead of all entries.
+// Returns NULL if there are no such folders to restrict the search to, or the children would need to be sorted and
+// are too many to be worth it.
+static DynamicArray *
+search_parent_children(FsearchDatabaseIndexStore *store,
+                       FsearchQuery *query,
+                       DynamicArray *parents,
+                       FsearchDatabaseChunkedArray **chunks_by_property,
+                       FsearchDatabaseIndexProperty sort_order,
+                       GCancellable *cancellable) {
+    FsearchDatabaseChunkedArray *chunked_array = chunks_by_property[DATABASE_INDEX_PROPERTY_PATH];
+    if (!parents || !chunked_array) {
+        return NULL;
+    }
+
+    IndexStoreRangeIndex index = {0};
+    range_index_init(&index, chunked_array);
+
+    const uint32_t num_parents = darray_get_num_items(parents);
+    g_autoptr(GArray) ranges = g_array_sized_new(FALSE, FALSE, sizeof(IndexStoreRange), num_parents);
+    for (uint32_t i = 0; i < num_parents; ++i) {
+        FsearchDatabaseEntry *parent = darray_get_item(parents, i);
+        IndexStoreRange range = {
+            .start = range_index_bound_for_folder(&index, parent, false),
+            .end = range_index_bound_for_folder(&index, parent, true),
+        };
+        if (range.start < range.end) {
+            g_array_append_val(ranges, range);
+        }
+    }
+
+    // Keep the children in the order of the path index. Folders with the very same path (e.g. the same folder being
+    // indexed twice) share their range.
+    g_array_sort(ranges, compare_ranges);
+    uint32_t num_children = 0;
+    uint32_t num_ranges = 0;
+    for (uint32_t i = 0; i < ranges->len; ++i) {
+        IndexStoreRange *range = &g_array_index(ranges, IndexStoreRange, i);
+        if (num_ranges > 0 && range->start < g_array_index(ranges, IndexStoreRange, num_ranges - 1).end) {
+            continue;
+        }
+        g_array_index(ranges, IndexStoreRange, num_ranges++) = *range;
+        num_children += range->end - range->start;
+    }
+    g_array_set_size(ranges, num_ranges);
+
+    const bool needs_sort = sort_order != DATABASE_INDEX_PROPERTY_PATH;
+    if (needs_sort && num_children > index.num_entries / RANGE_MAX_UNSORTED_SLICE_FRACTION) {
+        range_index_clear(&index);
+        return NULL;
+    }
+
+    g_autoptr(DynamicArray) slice = darray_new_full(16, (GDestroyNotify)darray_unref);
+    for (uint32_t i = 0; i < ranges->len; ++i) {
+        IndexStoreRange *range = &g_array_index(ranges, IndexStoreRange, i);
+        g_autoptr(DynamicArray) range_slice = range_index_get_slice(&index, range->start, range->end);
+        for (uint32_t j = 0; j < darray_get_num_items(range_slice); ++j) {
+            darray_add_item(slice, darray_ref(darray_get_item(range_slice, j)));
+        }
+    }
+    range_index_clear(&index);
+
+    DynamicArray *results = search_chunks(query,
+                                          slice,
+                                          num_children,
+                                          0,
+                                          false,
+                                          index_store_wants_single_threaded_search(store, query),
+                                          store->worker_pool,
+                                          store->worker_pool_collect_queue,
+                                          cancellable,
+                                          NULL);
+    if (needs_sort) {
+        // Same as for trigram candidates: even partial results need to be fully sorted
+        g_autoptr(FsearchDatabaseEntryCompareContext) ctx = db_entry_compare_context_new(
+            fsearch_database_sort_order_chain_for_property(sort_order));
+        darray_sort(results, (DynamicArrayCompareDataFunc)db_entry_compare_entries_by_chain, NULL, ctx);
+    }
+    return results;
+}
+
+// Gives all entries an ID, before they get added to a new extension index
+static void
+index_store_ensure_entry_ids_locked(FsearchDatabaseIndexStore *store, DynamicArray *files, DynamicArray *folders) {
+    // store->mutex must already be held by the caller
+    if (!store->entry_ids) {
+        store->entry_ids = fsearch_database_entry_id_table_new();
+    }
+    fsearch_database_entry_id_table_add(store->entry_ids, files);
+    fsearch_database_entry_id_table_add(store->entry_ids, folders);
+}
+
+// Matches `candidates` (in no particular order) against `query` and sorts the matches like the fast sort index of
+// `sort_order`
+static DynamicArray *
+match_candidates(FsearchQuery *query,
+                 DynamicArray *candidates,
+                 FsearchDatabaseIndexProperty sort_order,
+                 GCancellable *cancellable) {
+    const uint32_t num_candidates = darray_get_num_items(candidates);
+    DynamicArray *results = darray_new(num_candidates);
+
+    FsearchQueryMatchData *match_data = fsearch_query_match_data_new(NULL, NULL);
+    fsearch_query_match_data_set_thread_id(match_data, 0);
+    for (uint32_t i = 0; i < num_candidates; ++i) {
+        if (G_UNLIKELY(g_cancellable_is_cancelled(cancellable))) {
+            break;
+        }
+        FsearchDatabaseEntry *entry = darray_get_item(candidates, i);
+        fsearch_query_match_data_set_entry(match_data, entry);
+        if (fsearch_query_match(query, match_data)) {
+            darray_add_item(results, entry);
+        }
+    }
+    g_clear_pointer(&match_data, fsearch_query_match_data_free);
+
+    // Bring the matches into the same order as the fast sort index. This isn't cancelled, even partial results need
+    // to be fully sorted, and there are only few of them anyway.
+    g_autoptr(FsearchDatabaseEntryCompareContext) ctx = db_entry_compare_context_new(
+        fsearch_database_sort_order_chain_for_property(sort_order));
+    darray_sort(results, (DynamicArrayCompareDataFunc)db_entry_compare_entries_by_chain, NULL, ctx);
+
+    return results;
+}
+
+static void
+index_store_ensure_extension_indices_locked(FsearchDatabaseIndexStore *store) {
+    // store->mutex must already be held by the caller
+    if (store->file_extensions && store->folder_extensions) {
+        return;
+    }
+    FsearchDatabaseChunkedArray *file_chunks = store->file_chunks[DATABASE_INDEX_PROPERTY_NAME];
+    FsearchDatabaseChunkedArray *folder_chunks = store->folder_chunks[DATABASE_INDEX_PROPERTY_NAME];
+    if (!file_chunks || !folder_chunks) {
+        return;
+    }
+
+    g_autoptr(GTimer) timer = g_timer_new();
+    g_autoptr(DynamicArray) files = fsearch_database_chunked_array_get_joined(file_chunks);
+    g_autoptr(DynamicArray) folders = fsearch_database_chunked_array_get_joined(folder_chunks);
+    index_store_extension_indices_free(store);
+    index_store_ensure_entry_ids_locked(store, files, folders);
+    store->file_extensions = fsearch_database_extension_index_new(store->entry_ids, files);
+    store->folder_extensions = fsearch_database_extension_index_new(store->entry_ids, folders);
+
+    g_debug("[index_store] extension index built: %u extensions in %.3f ms",
+            fsearch_database_extension_index_get_num_extensions(store->file_extensions),
+            g_timer_elapsed(timer, NULL) * 1000.0);
+}
+
+typedef struct {
+    FsearchDatabaseTrigramIndex *trigrams;
+    FsearchDatabaseExtensionIndex *extensions;
+    uint32_t max_candidates;
+} IndexStoreCandidateContext;
+
+// The IDs (in ascending order) of the entries which the inverted indices consider for `tree`, i.e. a superset of the
+// entries it matches. The candidates of the operands get combined like the operator combines their matches. Returns
+// NULL if the tree can't be narrowed down to at most ctx->max_candidates entries (e.g. below NOT, or for needles
+// without a trigram), which stands for all entries.
+static GArray *
+get_tree_candidates(IndexStoreCandidateContext *ctx, GNode *tree) {
+    if (!tree || !tree->data) {
+        return NULL;
+    }
+    FsearchQueryNode *node = tree->data;
+    if (node->type == FSEARCH_QUERY_NODE_TYPE_QUERY) {
+        if (ctx->extensions && fsearch_query_node_is_extension_match(node)) {
+            return fsearch_database_extension_index_get_ids(ctx->extensions,
+                                                            node->search_term_list,
+                                                            ctx->max_candidates);
+        }
+        if (ctx->trigrams && fsearch_query_node_is_name_substring_match(node)) {
+            return fsearch_database_trigram_index_get_ids(ctx->trigrams, node->needle, ctx->max_candidates);
+        }
+        return NULL;
+    }
+
+    GArray *candidates = NULL;
+    switch (node->operator) {
+    case FSEARCH_QUERY_NODE_OPERATOR_AND:
+        // Operands without candidates don't narrow anything down, but don't widen anything up either
+        for (GNode *child = tree->children; child; child = child->next) {
+            GArray *child_candidates = get_tree_candidates(ctx, child);
+            if (!child_candidates) {
+                continue;
+            }
+            if (!candidates) {
+                candidates = child_candidates;
+                continue;
+            }
+            GArray *both = fsearch_database_posting_list_intersect_ids(candidates, child_candidates);
+            g_clear_pointer(&candidates, g_array_unref);
+            g_clear_pointer(&child_candidates, g_array_unref);
+            candidates = both;
+            if (candidates->len == 0) {
+                // Nothing can match anymore
+                break;
+            }
+        }
+        return candidates;
+    case FSEARCH_QUERY_NODE_OPERATOR_OR:
+        for (GNode *child = tree->children; child; child = child->next) {
+            GArray *child_candidates = get_tree_candidates(ctx, child);
+            if (!child_candidates) {
+                g_clear_pointer(&candidates, g_array_unref);
+                return NULL;
+            }
+            if (!candidates) {
+                candidates = child_candidates;
+            }
+            else {
+                GArray *either = fsearch_database_posting_list_unite_ids(candidates, child_candidates);
+                g_clear_pointer(&candidates, g_array_unref);
+                g_clear_pointer(&child_candidates, g_array_unref);
+                candidates = either;
+            }
+            if (candidates->len > ctx->max_candidates) {
+                g_clear_pointer(&candidates, g_array_unref);
+                return NULL;
+            }
+        }
+        return candidates;
+    default:
+        // The complement of a candidate set is almost everything
+        return NULL;
+    }
+}
+
+static gboolean
+find_extension_match(GNode *node, gpointer data) {
+    bool *found = data;
+    *found = node->data && fsearch_query_node_is_extension_match(node->data);
+    return *found;
+}
+
+static bool
+query_has_extension_match(FsearchQuery *query) {
+    bool found = false;
+    if (query->query_tree) {
+        g_node_traverse(query->query_tree, G_IN_ORDER, G_TRAVERSE_LEAVES, -1, find_extension_match, &found);
+    }
+    if (!found && query->filter_program) {
+        g_node_traverse(query->filter_tree, G_IN_ORDER, G_TRAVERSE_LEAVES, -1, find_extension_match, &found);
+    }
+    return found;
+}
+
+// Matches only the entries the inverted indices consider for the query and filter, instead of all of them. Returns
+// NULL if they can't narrow the search down far enough, in which case the entries need to be scanned.
+static DynamicArray *
+search_index_candidates(FsearchQuery *query,
+                        FsearchDatabaseEntryIdTable *entry_ids,
+                        FsearchDatabaseTrigramIndex *trigrams,
+                        FsearchDatabaseExtensionIndex *extensions,
+                        FsearchDatabaseChunkedArray *chunked_array,
+                        FsearchDatabaseIndexProperty sort_order,
+                        GCancellable *cancellable) {
+    if (!entry_ids || (!trigrams && !extensions)) {
+        return NULL;
+    }
+
+    const uint32_t num_entries = fsearch_database_chunked_array_get_num_entries(chunked_array);
+    IndexStoreCandidateContext ctx = {
+        .trigrams = trigrams,
+        .extensions = extensions,
+        .max_candidates = MIN(INDEX_MAX_CANDIDATES, num_entries / INDEX_MAX_CANDIDATES_FRACTION),
+    };
+    g_autoptr(GArray) candidates = get_tree_candidates(&ctx, query->query_tree);
+    if (query->filter_program) {
+        // The filter applies on top of the query
+        g_autoptr(GArray) filter_candidates = get_tree_candidates(&ctx, query->filter_tree);
+        if (filter_candidates && candidates) {
+            GArray *both = fsearch_database_posting_list_intersect_ids(candidates, filter_candidates);
+            g_clear_pointer(&candidates, g_array_unref);
+            candidates = both;
+        }
+        else if (filter_candidates) {
+            candidates = g_steal_pointer(&filter_candidates);
+        }
+    }
+    if (!candidates) {
+        return NULL;
+    }
+
+    g_autoptr(DynamicArray) candidate_entries = fsearch_database_entry_id_table_get_entries(entry_ids, candidates);
+    return match_candidates(query, candidate_entries, sort_order, cancellable);
+}
+
+// Keeps only the first `num_kept` of `results`, or the last ones if `reverse` is set. Takes ownership of `results`.
+static DynamicArray *
+limit_results(DynamicArray *results, uint32_t num_kept, bool reverse) {
+    const uint32_t num_results = darray_get_num_items(results);
+    if (num_results <= num_kept) {
+        return results;
+    }
+    g_autoptr(DynamicArray) all_results = results;
+    if (num_kept == 0) {
+        return darray_new(0);
+    }
+    return darray_get_range(all_results, reverse ? num_results - num_kept : 0, num_kept);
+}
 
-        start_pos = end_pos + 1;
-        end_pos += num_items_per_thread;
+// The first `limit` entries of `chunked_array`, or the last ones if `reverse` is set. `limited` gets set if there are
+// more entries than that.
+static DynamicArray *
+get_limited_entries(FsearchDatabaseChunkedArray *chunked_array, uint32_t limit, bool reverse, bool *limited) {
+    if (fsearch_database_chunked_array_get_num_entries(chunked_array) > limit) {
+        *limited = true;
     }
+    g_autoptr(DynamicArray) chunks = fsearch_database_chunked_array_get_chunks(chunked_array);
+    const uint32_t num_chunks = darray_get_num_items(chunks);
 
-    uint32_t num_threads_collected = 0;
-    while (num_threads_collected < darray_get_num_items(pool_data_array)) {
-        g_async_queue_pop(collect_queue);
-        num_threads_collected++;
+    // Find the chunks which hold the needed entries first, so they can be added in index order
+    uint32_t num_entries = 0;
+    uint32_t num_limited_chunks = 0;
+    while (num_limited_chunks < num_chunks && num_entries < limit) {
+        DynamicArray *chunk = darray_get_item(chunks, reverse ? num_chunks - 1 - num_limited_chunks : num_limited_chunks);
+        num_entries += darray_get_num_items(chunk);
+        num_limited_chunks++;
     }
 
-    return collect_search_results(pool_data_array);
+    const uint32_t start_chunk = reverse ? num_chunks - num_limited_chunks : 0;
+    g_autoptr(DynamicArray) entries = darray_new(num_entries);
+    for (uint32_t i = start_chunk; i < start_chunk + num_limited_chunks; ++i) {
+        darray_add_array(entries, darray_get_item(chunks, i));
+    }
+    return limit_results(g_steal_pointer(&entries), limit, reverse);
 }
 
 bool
@@ -1404,6 +2904,7 @@ fsearch_database_index_store_search(FsearchDatabaseIndexStore *store,
                                     FsearchQuery *query,
                                     FsearchDatabaseIndexProperty sort_order,
                                     GtkSortType sort_type,
+                                    uint32_t limit,
                                     GCancellable *cancellable) {
     g_return_val_if_fail(store, false);
     g_return_val_if_fail(store->search_results, false);
@@ -1426,34 +2927,212 @@ fsearch_database_index_store_search(FsearchDatabaseIndexStore *store,
         return false;
     }
 
-    // TODO: Search performance increase
-    // Avoid joining chunks together for searching. It's most certainly more efficient to search in the chunks directly.
-    // We just need to make sure that the search threads get a roughly equally sized range to search in.
-    g_autoptr(DynamicArray) files = file_chunks ? fsearch_database_chunked_array_get_joined(file_chunks) : NULL;
-    g_autoptr(DynamicArray) folders = folder_chunks ? fsearch_database_chunked_array_get_joined(folder_chunks) : NULL;
+    // When everything matches, the result is the whole index, so a joined copy is exactly what the view needs
+    const bool matches_everything = fsearch_query_matches_everything(query);
+    // The first rows of a view in descending order are the last entries of the index
+    const bool reverse = sort_type == GTK_SORT_DESCENDING;
+
+    // When the query only narrows down the previous query of this view (e.g. another character got typed), its
+    // results are a subset of the previous results. Those are kept up to date with the index and are already in the
+    // right order, so it's enough to search them instead of the whole index.
+    bool refined = false;
+    FsearchDatabaseSearchView *old_view = g_hash_table_lookup(store->search_results, GUINT_TO_POINTER(id));
+    if (!matches_everything && old_view
+        && fsearch_database_search_view_can_refine(old_view,
+                                                   query,
+                                                   fsearch_database_sort_order_chain_for_property(sort_order))) {
+        g_autoptr(FsearchDatabaseChunkedArray) old_files = fsearch_database_search_view_get_files(old_view);
+        g_autoptr(FsearchDatabaseChunkedArray) old_folders = fsearch_database_search_view_get_folders(old_view);
+        if (!old_files == !file_chunks && !old_folders == !folder_chunks) {
+            g_clear_pointer(&file_chunks, fsearch_database_chunked_array_unref);
+            g_clear_pointer(&folder_chunks, fsearch_database_chunked_array_unref);
+            file_chunks = g_steal_pointer(&old_files);
+            folder_chunks = g_steal_pointer(&old_folders);
+            refined = true;
+        }
+    }
 
-    const uint32_t num_searched = (files ? darray_get_num_items(files) : 0)
-                                + (folders ? darray_get_num_items(folders) : 0);
+    const uint32_t num_searched = (file_chunks ? fsearch_database_chunked_array_get_num_entries(file_chunks) : 0)
+                                + (folder_chunks ? fsearch_database_chunked_array_get_num_entries(folder_chunks) : 0);
 
-    const bool matches_everything = fsearch_query_matches_everything(query);
-    g_autoptr(DynamicArray) found_files = NULL;
-    if (files) {
-        found_files = matches_everything
-                        ? g_steal_pointer(&files)
-                        : search_entries(query, files, store->worker_pool, store->worker_pool_collect_queue, cancellable);
+    g_autoptr(DynamicArray) parent_folders = NULL;
+    if (!matches_everything && !refined) {
+        parent_folders = index_store_resolve_parent_folders_locked(store, query);
+        if (query_has_extension_match(query)) {
+            index_store_ensure_extension_indices_locked(store);
+        }
     }
+
+    const bool single_threaded = index_store_wants_single_threaded_search(store, query);
+    bool used_parents = false;
+    bool used_range = false;
+    bool used_candidates = false;
+
+    // Large scans publish their first matches before they're finished. Folders are searched first, so that for the
+    // ascending order the partial results are a prefix of the final ones. For the descending order the files get
+    // searched from their end, so the partial results are a suffix of them.
+    IndexStoreSearchStream stream = {
+        .store = store,
+        .id = id,
+        .query = query,
+        .chain = fsearch_database_sort_order_chain_for_property(sort_order),
+        .sort_type = sort_type,
+    };
+    const bool streaming = store->event_func && !matches_everything && !refined && limit == 0
+                        && num_searched >= THRESHOLD_FOR_STREAMING_SEARCH;
+    if (streaming) {
+        stream.files = darray_new(0);
+        stream.folders = darray_new(0);
+    }
+
+    // Whether any matches got dropped because of the limit
+    bool limited = false;
+
     g_autoptr(DynamicArray) found_folders = NULL;
-    if (folders) {
-        found_folders = matches_everything
-                          ? g_steal_pointer(&folders)
-                          : search_entries(query, folders, store->worker_pool, store->worker_pool_collect_queue, cancellable);
+    if (folder_chunks) {
+        if (matches_everything) {
+            found_folders = limit > 0 ? get_limited_entries(folder_chunks, limit, reverse, &limited)
+                                      : fsearch_database_chunked_array_get_joined(folder_chunks);
+        }
+        else if (refined) {
+            found_folders = search_entries(query,
+                                           folder_chunks,
+                                           limit,
+                                           reverse,
+                                           single_threaded,
+                                           store->worker_pool,
+                                           store->worker_pool_collect_queue,
+                                           cancellable,
+                                           &limited);
+        }
+        else if ((found_folders = search_parent_children(store,
+                                                         query,
+                                                         parent_folders,
+                                                         store->folder_chunks,
+                                                         sort_order,
+                                                         cancellable))) {
+            used_parents = true;
+        }
+        else if ((found_folders = search_range_slice(store, query, store->folder_chunks, sort_order, cancellable))) {
+            used_range = true;
+        }
+        else if ((found_folders = search_index_candidates(query,
+                                                        store->entry_ids,
+                                                        store->folder_trigrams,
+                                                        store->folder_extensions,
+                                                        folder_chunks,
+                                                        sort_order,
+                                                        cancellable))) {
+            used_candidates = true;
+        }
+        else if (streaming && sort_type == GTK_SORT_ASCENDING) {
+            // Descending views show the folders after all files, so their partial results wouldn't be the first rows
+            search_entries_streaming(&stream, folder_chunks, &stream.folders, cancellable);
+            found_folders = darray_ref(stream.folders);
+        }
+        else {
+            found_folders = search_entries(query,
+                                           folder_chunks,
+                                           limit,
+                                           reverse,
+                                           single_threaded,
+                                           store->worker_pool,
+                                           store->worker_pool_collect_queue,
+                                           cancellable,
+                                           &limited);
+        }
+    }
+
+    if (streaming && found_folders && found_folders != stream.folders) {
+        // The folders didn't need a scan, but the partial results of the file scan still have to show them
+        darray_add_array(stream.folders, found_folders);
+    }
+
+    g_autoptr(DynamicArray) found_files = NULL;
+    if (file_chunks) {
+        if (matches_everything) {
+            found_files = limit > 0 ? get_limited_entries(file_chunks, limit, reverse, &limited)
+                                    : fsearch_database_chunked_array_get_joined(file_chunks);
+        }
+        else if (refined) {
+            found_files = search_entries(query,
+                                         file_chunks,
+                                         limit,
+                                         reverse,
+                                         single_threaded,
+                                         store->worker_pool,
+                                         store->worker_pool_collect_queue,
+                                         cancellable,
+                                         &limited);
+        }
+        else if ((found_files = search_parent_children(store,
+                                                       query,
+                                                       parent_folders,
+                                                       store->file_chunks,
+                                                       sort_order,
+                                                       cancellable))) {
+            used_parents = true;
+        }
+        else if ((found_files = search_range_slice(store, query, store->file_chunks, sort_order, cancellable))) {
+            used_range = true;
+        }
+        else if ((found_files = search_index_candidates(query,
+                                                      store->entry_ids,
+                                                      store->file_trigrams,
+                                                      store->file_extensions,
+                                                      file_chunks,
+                                                      sort_order,
+                                                      cancellable))) {
+            used_candidates = true;
+        }
+        else if (streaming) {
+            search_entries_streaming(&stream, file_chunks, &stream.files, cancellable);
+            found_files = darray_ref(stream.files);
+        }
+        else {
+            found_files = search_entries(query,
+                                         file_chunks,
+                                         limit,
+                                         reverse,
+                                         single_threaded,
+                                         store->worker_pool,
+                                         store->worker_pool_collect_queue,
+                                         cancellable,
+                                         &limited);
+        }
+    }
+
+    if (streaming) {
+        index_store_clear_streaming_view(store);
+        g_clear_pointer(&stream.files, darray_unref);
+        g_clear_pointer(&stream.folders, darray_unref);
+    }
+
+    if (limit > 0) {
+        // Folders and files were both searched for `limit` matches (or all of them, for the searches which can't stop
+        // early), but the view only needs that many in total. Its folders come first, unless it's in descending order.
+        DynamicArray **first_results = reverse ? &found_files : &found_folders;
+        DynamicArray **second_results = reverse ? &found_folders : &found_files;
+        uint32_t num_results = 0;
+        if (*first_results) {
+            const uint32_t num_first_results = darray_get_num_items(*first_results);
+            *first_results = limit_results(*first_results, limit, reverse);
+            num_results += darray_get_num_items(*first_results);
+            limited = limited || num_results < num_first_results;
+        }
+        if (*second_results) {
+            const uint32_t num_second_results = darray_get_num_items(*second_results);
+            *second_results = limit_results(*second_results, limit - num_results, reverse);
+            limited = limited || darray_get_num_items(*second_results) < num_second_results;
+            num_results += darray_get_num_items(*second_results);
+        }
     }
 
     const uint32_t num_found_files = found_files ? darray_get_num_items(found_files) : 0;
     const uint32_t num_found_folders = found_folders ? darray_get_num_items(found_folders) : 0;
     const double search_time = g_timer_elapsed(timer, NULL);
 
-    g_debug("[index_store] search \"%s\": %u of %u matched (%u folder%s, %u file%s) in %.3f ms%s%s",
+    g_debug("[index_store] search \"%s\": %u of %u matched (%u folder%s, %u file%s) in %.3f ms%s%s%s%s%s%s%s%s",
             query->search_term ? query->search_term : "",
             num_found_folders + num_found_files,
             num_searched,
@@ -1463,14 +3142,21 @@ fsearch_database_index_store_search(FsearchDatabaseIndexStore *store,
             num_found_files == 1 ? "" : "s",
             search_time * 1000.0,
             matches_everything ? ", match-all" : "",
+            refined ? ", refined previous results" : "",
+            used_parents ? ", parent folder" : "",
+            used_range ? ", range slice" : "",
+            used_candidates ? ", index candidates" : "",
+            stream.num_published > 0 ? ", streamed" : "",
+            limited ? ", limited" : "",
             g_cancellable_is_cancelled(cancellable) ? ", cancelled" : "");
 
     if (found_files || found_folders) {
         // If the search got cancelled partway through, found_files/found_folders only reflect
         // whatever was matched before that happened. We still install them (rather than
         // discarding the work), but mark the view as incomplete so callers can tell a partial
-        // result set apart from a genuinely finished search.
-        const bool is_complete = !g_cancellable_is_cancelled(cancellable);
+        // result set apart from a genuinely finished search. The same goes for results which
+        // were cut off at the limit.
+        const bool is_complete = !g_cancellable_is_cancelled(cancellable) && !limited;
 
         // We only ever search in pre-sorted (fast-indexed) arrays, so the canonical chain for
         // `sort_order` alone already fully describes the result order.
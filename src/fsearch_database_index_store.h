@@ -31,6 +31,8 @@ typedef enum {
     FSEARCH_DATABASE_INDEX_STORE_EVENT_VIEW_CHANGED,
     FSEARCH_DATABASE_INDEX_STORE_EVENT_APPLY_STARTED,
     FSEARCH_DATABASE_INDEX_STORE_EVENT_APPLY_FINISHED,
+    // A large search published the matches it found so far, `data` is the FsearchDatabaseSearchInfo of those
+    FSEARCH_DATABASE_INDEX_STORE_EVENT_SEARCH_PROGRESS,
     NUM_FSEARCH_DATABASE_STORE_EVENTS,
 } FsearchDatabaseIndexStoreEventKind;
 
@@ -119,9 +121,28 @@ fsearch_database_index_store_get_entry_info(FsearchDatabaseIndexStore *store,
                                             uint32_t id,
                                             FsearchDatabaseEntryInfoFlags flags);
 
+// Looks up a row of the partial results a search in progress published for view `id`. Doesn't need the store lock,
+// which the search holds until it's finished. Returns NULL when no search of that view is in progress.
+FsearchDatabaseEntryInfo *
+fsearch_database_index_store_get_streaming_entry_info(FsearchDatabaseIndexStore *store,
+                                                      uint32_t idx,
+                                                      uint32_t id,
+                                                      FsearchDatabaseEntryInfoFlags flags);
+
 FsearchDatabaseSearchInfo *
 fsearch_database_index_store_get_search_info(FsearchDatabaseIndexStore *store, uint32_t id);
 
+// Enables an index over all trigrams of the entry names, which answers selective substring searches without looking
+// at every entry, at the cost of roughly 4 bytes per trigram and entry. It's built in the background once the store is
+// running, searches scan all entries until it's ready.
+// The store must be locked.
+void
+fsearch_database_index_store_set_trigram_index_enabled(FsearchDatabaseIndexStore *store, bool enabled);
+
+// Whether the trigram index is ready to be used by searches. The store must be locked.
+bool
+fsearch_database_index_store_has_trigram_index(FsearchDatabaseIndexStore *store);
+
 bool
 fsearch_database_index_store_has_chunks(FsearchDatabaseIndexStore *store, FsearchDatabaseChunkedArray *chunks);
 
@@ -144,12 +165,16 @@ fsearch_database_index_store_sort_results(FsearchDatabaseIndexStore *store,
                                           FsearchDatabaseIndexProperty sort_order,
                                           GtkSortType sort_type,
                                           GCancellable *cancellable);
+// Searches for `query` and installs the results as view `id`. With a `limit` other than 0, the view only gets the first
+// that many results in its order and the search stops as soon as they're known. Returns whether the view holds all
+// results, i.e. the search wasn't cancelled or cut off at the limit.
 bool
 fsearch_database_index_store_search(FsearchDatabaseIndexStore *store,
                                     uint32_t id,
                                     FsearchQuery *query,
                                     FsearchDatabaseIndexProperty sort_order,
                                     GtkSortType sort_type,
+                                    uint32_t limit,
                                     GCancellable *cancellable);
 
 void
@@ -3,6 +3,7 @@
 struct _FsearchDatabaseInfo {
     FsearchDatabaseIncludeManager *include_manager;
     FsearchDatabaseExcludeManager *exclude_manager;
+    FsearchDatabaseIndexPropertyFlags flags;
     uint32_t num_files;
     uint32_t num_folders;
 
@@ -36,6 +37,7 @@ fsearch_database_info_unref(FsearchDatabaseInfo *self) {
 FsearchDatabaseInfo *
 fsearch_database_info_new(FsearchDatabaseIncludeManager *include_manager,
                           FsearchDatabaseExcludeManager *exclude_manager,
+                          FsearchDatabaseIndexPropertyFlags flags,
                           uint32_t num_files,
                           uint32_t num_folders) {
     FsearchDatabaseInfo *self = calloc(1, sizeof(FsearchDatabaseInfo));
@@ -47,6 +49,7 @@ fsearch_database_info_new(FsearchDatabaseIncludeManager *include_manager,
     if (exclude_manager) {
         self->exclude_manager = fsearch_database_exclude_manager_copy(exclude_manager);
     }
+    self->flags = flags;
     self->num_files = num_files;
     self->num_folders = num_folders;
 
@@ -83,4 +86,10 @@ FsearchDatabaseExcludeManager *
 fsearch_database_info_get_exclude_manager(FsearchDatabaseInfo *self) {
     g_return_val_if_fail(self, NULL);
     return self->exclude_manager ? g_object_ref(self->exclude_manager) : NULL;
-}
\ No newline at end of file
+}
+
+FsearchDatabaseIndexPropertyFlags
+fsearch_database_info_get_flags(FsearchDatabaseInfo *self) {
+    g_return_val_if_fail(self, DATABASE_INDEX_PROPERTY_FLAG_NONE);
+    return self->flags;
+}
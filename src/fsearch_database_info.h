@@ -4,6 +4,7 @@
 
 #include "fsearch_database_exclude_manager.h"
 #include "fsearch_database_include_manager.h"
+#include "fsearch_database_index_properties.h"
 
 G_BEGIN_DECLS
 
@@ -23,6 +24,7 @@ fsearch_database_info_unref(FsearchDatabaseInfo *info);
 FsearchDatabaseInfo *
 fsearch_database_info_new(FsearchDatabaseIncludeManager *includes,
                           FsearchDatabaseExcludeManager *excludes,
+                          FsearchDatabaseIndexPropertyFlags flags,
                           uint32_t num_files,
                           uint32_t num_folders);
 
@@ -41,6 +43,9 @@ fsearch_database_info_get_include_manager(FsearchDatabaseInfo *info);
 FsearchDatabaseExcludeManager *
 fsearch_database_info_get_exclude_manager(FsearchDatabaseInfo *info);
 
+FsearchDatabaseIndexPropertyFlags
+fsearch_database_info_get_flags(FsearchDatabaseInfo *info);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(FsearchDatabaseInfo, fsearch_database_info_unref)
 
 G_END_DECLS
\ No newline at end of file
@@ -0,0 +1,199 @@
+#define G_LOG_DOMAIN "fsearch-database-posting-list"
+
+#include "fsearch_database_posting_list.h"
+
+#include <glib.h>
+#include <stdint.h>
+#include <string.h>
+
+void
+fsearch_database_posting_list_clear(FsearchDatabasePostingList *list) {
+    g_return_if_fail(list);
+    g_clear_pointer(&list->ids, g_free);
+    g_clear_pointer(&list->batch, g_free);
+    list->num_entries = 0;
+    list->max_entries = 0;
+    list->num_batch = 0;
+    list->max_batch = 0;
+}
+
+// Index of the first ID in `list` which isn't smaller than `id`
+static uint32_t
+posting_list_lower_bound(FsearchDatabasePostingList *list, uint32_t start, uint32_t id) {
+    uint32_t left = start;
+    uint32_t right = list->num_entries;
+    while (left < right) {
+        const uint32_t middle = left + (right - left) / 2;
+        if (list->ids[middle] < id) {
+            left = middle + 1;
+        }
+        else {
+            right = middle;
+        }
+    }
+    return left;
+}
+
+bool
+fsearch_database_posting_list_contains(FsearchDatabasePostingList *list, uint32_t id) {
+    const uint32_t idx = posting_list_lower_bound(list, 0, id);
+    return idx < list->num_entries && list->ids[idx] == id;
+}
+
+bool
+fsearch_database_posting_list_add_to_batch(FsearchDatabasePostingList *list, uint32_t id) {
+    if (list->num_batch > 0 && list->batch[list->num_batch - 1] == id) {
+        return false;
+    }
+    if (list->num_batch == list->max_batch) {
+        list->max_batch = MAX(8, list->max_batch * 2);
+        list->batch = g_renew(uint32_t, list->batch, list->max_batch);
+    }
+    list->batch[list->num_batch++] = id;
+    return list->num_batch == 1;
+}
+
+void
+fsearch_database_posting_list_clear_batch(FsearchDatabasePostingList *list) {
+    g_clear_pointer(&list->batch, g_free);
+    list->num_batch = 0;
+    list->max_batch = 0;
+}
+
+void
+fsearch_database_posting_list_merge_batch(FsearchDatabasePostingList *list) {
+    if (list->num_batch == 0) {
+        return;
+    }
+    const uint32_t num_total = list->num_entries + list->num_batch;
+    if (num_total > list->max_entries) {
+        // Lists are usually filled by a single batch when the index gets built, only grow them with some headroom
+        // once they get modified afterwards
+        list->max_entries = list->num_entries == 0 ? num_total : MAX(num_total, list->max_entries + list->max_entries / 8);
+        list->ids = g_renew(uint32_t, list->ids, list->max_entries);
+    }
+
+    if (list->num_entries == 0 || list->ids[list->num_entries - 1] < list->batch[0]) {
+        // The common case: all new IDs are larger than the existing ones
+        memcpy(list->ids + list->num_entries, list->batch, list->num_batch * sizeof(uint32_t));
+    }
+    else {
+        // Merge from the back, so nothing gets overwritten before it was moved
+        int64_t i = (int64_t)list->num_entries - 1;
+        int64_t j = (int64_t)list->num_batch - 1;
+        uint32_t w = num_total;
+        while (j >= 0) {
+            if (i >= 0 && list->ids[i] > list->batch[j]) {
+                list->ids[--w] = list->ids[i--];
+            }
+            else {
+                list->ids[--w] = list->batch[j--];
+            }
+        }
+    }
+    list->num_entries = num_total;
+}
+
+void
+fsearch_database_posting_list_subtract_batch(FsearchDatabasePostingList *list) {
+    if (list->num_batch == 0) {
+        return;
+    }
+    uint32_t r = posting_list_lower_bound(list, 0, list->batch[0]);
+    uint32_t w = r;
+    uint32_t j = 0;
+    for (; r < list->num_entries && j < list->num_batch; ++r) {
+        const uint32_t id = list->ids[r];
+        while (j < list->num_batch && list->batch[j] < id) {
+            j++;
+        }
+        if (j < list->num_batch && list->batch[j] == id) {
+            j++;
+            continue;
+        }
+        list->ids[w++] = id;
+    }
+    // Everything after the last removed entry only needs to be shifted
+    const uint32_t num_tail = list->num_entries - r;
+    if (num_tail > 0 && w != r) {
+        memmove(list->ids + w, list->ids + r, num_tail * sizeof(uint32_t));
+    }
+    list->num_entries = w + num_tail;
+
+    if (list->num_entries < list->max_entries / 4) {
+        list->max_entries = list->num_entries;
+        list->ids = g_renew(uint32_t, list->ids, list->max_entries);
+    }
+}
+
+// Index of the first ID in `ids` from `start` on which isn't smaller than `id`. Gallops ahead first, so it's cheap to
+// step through a much larger array.
+static uint32_t
+ids_lower_bound(GArray *ids, uint32_t start, uint32_t id) {
+    const uint32_t *values = (const uint32_t *)ids->data;
+    uint32_t left = start;
+    uint32_t step = 1;
+    while (left + step < ids->len && values[left + step] < id) {
+        left += step;
+        step *= 2;
+    }
+    uint32_t right = MIN(left + step, ids->len);
+    while (left < right) {
+        const uint32_t middle = left + (right - left) / 2;
+        if (values[middle] < id) {
+            left = middle + 1;
+        }
+        else {
+            right = middle;
+        }
+    }
+    return left;
+}
+
+GArray *
+fsearch_database_posting_list_intersect_ids(GArray *a, GArray *b) {
+    g_return_val_if_fail(a, NULL);
+    g_return_val_if_fail(b, NULL);
+
+    // Look up every ID of the smaller array in the larger one
+    GArray *small = a->len <= b->len ? a : b;
+    GArray *large = small == a ? b : a;
+
+    GArray *result = g_array_sized_new(FALSE, FALSE, sizeof(uint32_t), small->len);
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < small->len && j < large->len; ++i) {
+        const uint32_t id = g_array_index(small, uint32_t, i);
+        j = ids_lower_bound(large, j, id);
+        if (j < large->len && g_array_index(large, uint32_t, j) == id) {
+            g_array_append_val(result, id);
+            j++;
+        }
+    }
+    return result;
+}
+
+GArray *
+fsearch_database_posting_list_unite_ids(GArray *a, GArray *b) {
+    g_return_val_if_fail(a, NULL);
+    g_return_val_if_fail(b, NULL);
+
+    GArray *result = g_array_sized_new(FALSE, FALSE, sizeof(uint32_t), a->len + b->len);
+    uint32_t i = 0;
+    uint32_t j = 0;
+    while (i < a->len && j < b->len) {
+        const uint32_t id_a = g_array_index(a, uint32_t, i);
+        const uint32_t id_b = g_array_index(b, uint32_t, j);
+        if (id_a <= id_b) {
+            g_array_append_val(result, id_a);
+            i++;
+            j += id_a == id_b;
+        }
+        else {
+            g_array_append_val(result, id_b);
+            j++;
+        }
+    }
+    g_array_append_vals(result, &g_array_index(a, uint32_t, i), a->len - i);
+    g_array_append_vals(result, &g_array_index(b, uint32_t, j), b->len - j);
+    return result;
+}
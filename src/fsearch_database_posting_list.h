@@ -0,0 +1,53 @@
+#pragma once
+
+#include "fsearch_array.h"
+#include "fsearch_database_entry.h"
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+G_BEGIN_DECLS
+
+// A list of entry IDs (see FsearchDatabaseEntryIdTable) in ascending order, as used by the inverted indices of the
+// index store. Updates are collected in a batch (which must be in ascending order as well) and then merged into or
+// subtracted from the list all at once.
+typedef struct FsearchDatabasePostingList {
+    uint32_t *ids;
+    uint32_t num_entries;
+    uint32_t max_entries;
+
+    uint32_t *batch;
+    uint32_t num_batch;
+    uint32_t max_batch;
+} FsearchDatabasePostingList;
+
+// Frees the IDs and batch of `list`, but not `list` itself
+void
+fsearch_database_posting_list_clear(FsearchDatabasePostingList *list);
+
+bool
+fsearch_database_posting_list_contains(FsearchDatabasePostingList *list, uint32_t id);
+
+// Returns true if this is the first ID of the batch. Adding the same ID twice in a row is a no-op.
+bool
+fsearch_database_posting_list_add_to_batch(FsearchDatabasePostingList *list, uint32_t id);
+
+void
+fsearch_database_posting_list_merge_batch(FsearchDatabasePostingList *list);
+
+void
+fsearch_database_posting_list_subtract_batch(FsearchDatabasePostingList *list);
+
+void
+fsearch_database_posting_list_clear_batch(FsearchDatabasePostingList *list);
+
+// Set operations on arrays of IDs (uint32_t) in ascending order, like the ones the inverted indices hand out. The
+// results are in ascending order as well.
+GArray *
+fsearch_database_posting_list_intersect_ids(GArray *a, GArray *b);
+
+GArray *
+fsearch_database_posting_list_unite_ids(GArray *a, GArray *b);
+
+G_END_DECLS
@@ -21,6 +21,8 @@ typedef struct DatabaseWalkContext {
     FsearchDatabaseExcludeManager *exclude_manager;
     DynamicArray *folders;
     DynamicArray *files;
+    FsearchDatabaseEntryArena *arena;
+    FsearchDatabaseIndexPropertyFlags attribute_flags;
     FsearchFolderMonitorFanotify *fanotify_monitor;
     FsearchFolderMonitorInotify *inotify_monitor;
     bool one_file_system;
@@ -70,13 +72,14 @@ unwatch_folder(DatabaseWalkContext *walk_context, FsearchDatabaseEntry *folder)
 
 static FsearchDatabaseEntry *
 add_folder(DatabaseWalkContext *walk_context, const char *name, const char *path, time_t mtime, FsearchDatabaseEntry *parent) {
-    FsearchDatabaseEntry *folder_entry = db_entry_new_with_attributes(DATABASE_INDEX_PROPERTY_FLAG_DEFAULT,
-                                                                      name,
-                                                                      parent,
-                                                                      DATABASE_ENTRY_TYPE_FOLDER,
-                                                                      DATABASE_INDEX_PROPERTY_MODIFICATION_TIME,
-                                                                      mtime,
-                                                                      DATABASE_INDEX_PROPERTY_NONE);
+    FsearchDatabaseEntry *folder_entry = db_entry_new_with_attributes_in_arena(walk_context->arena,
+                                                                               walk_context->attribute_flags,
+                                                                               name,
+                                                                               parent,
+                                                                               DATABASE_ENTRY_TYPE_FOLDER,
+                                                                               DATABASE_INDEX_PROPERTY_MODIFICATION_TIME,
+                                                                               mtime,
+                                                                               DATABASE_INDEX_PROPERTY_NONE);
     if (!folder_entry) {
         return NULL;
     }
@@ -96,15 +99,16 @@ add_folder(DatabaseWalkContext *walk_context, const char *name, const char *path
 
 FsearchDatabaseEntry *
 add_file(DatabaseWalkContext *walk_context, const char *name, off_t size, time_t mtime, FsearchDatabaseEntry *parent) {
-    FsearchDatabaseEntry *file_entry = db_entry_new_with_attributes(DATABASE_INDEX_PROPERTY_FLAG_DEFAULT,
-                                                                    name,
-                                                                    parent,
-                                                                    DATABASE_ENTRY_TYPE_FILE,
-                                                                    DATABASE_INDEX_PROPERTY_SIZE,
-                                                                    size,
-                                                                    DATABASE_INDEX_PROPERTY_MODIFICATION_TIME,
-                                                                    mtime,
-                                                                    DATABASE_INDEX_PROPERTY_NONE);
+    FsearchDatabaseEntry *file_entry = db_entry_new_with_attributes_in_arena(walk_context->arena,
+                                                                             walk_context->attribute_flags,
+                                                                             name,
+                                                                             parent,
+                                                                             DATABASE_ENTRY_TYPE_FILE,
+                                                                             DATABASE_INDEX_PROPERTY_SIZE,
+                                                                             size,
+                                                                             DATABASE_INDEX_PROPERTY_MODIFICATION_TIME,
+                                                                             mtime,
+                                                                             DATABASE_INDEX_PROPERTY_NONE);
     if (!file_entry) {
         return NULL;
     }
@@ -245,6 +249,8 @@ db_scan_folder(const char *path,
                FsearchDatabaseEntry *parent,
                DynamicArray *folders,
                DynamicArray *files,
+               FsearchDatabaseEntryArena *arena,
+               FsearchDatabaseIndexPropertyFlags attribute_flags,
                FsearchDatabaseExcludeManager *exclude_manager,
                FsearchFolderMonitorFanotify *fanotify_monitor,
                FsearchFolderMonitorInotify *inotify_monitor,
@@ -277,6 +283,8 @@ db_scan_folder(const char *path,
     DatabaseWalkContext walk_context = {
         .folders = folders,
         .files = files,
+        .arena = arena,
+        .attribute_flags = attribute_flags,
         .fanotify_monitor = fanotify_monitor,
         .inotify_monitor = inotify_monitor,
         .exclude_manager = exclude_manager,
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "fsearch_database_entry_arena.h"
 #include "fsearch_database_exclude_manager.h"
+#include "fsearch_database_index_properties.h"
 #include "fsearch_folder_monitor_fanotify.h"
 #include "fsearch_folder_monitor_inotify.h"
 
@@ -9,6 +11,8 @@ db_scan_folder(const char *path,
                FsearchDatabaseEntry *parent,
                DynamicArray *folders,
                DynamicArray *files,
+               FsearchDatabaseEntryArena *arena,
+               FsearchDatabaseIndexPropertyFlags attribute_flags,
                FsearchDatabaseExcludeManager *exclude_manager,
                FsearchFolderMonitorFanotify *fanotify_monitor,
                FsearchFolderMonitorInotify *inotify_monitor,
@@ -214,8 +214,8 @@ fsearch_database_search_view_selection_foreach(FsearchDatabaseSearchView *view,
 
 void
 fsearch_database_search_view_sort(FsearchDatabaseSearchView *view,
-                                  DynamicArray *files_fast_sorted,
-                                  DynamicArray *folders_fast_sorted,
+                                  FsearchDatabaseChunkedArray *files_fast_sort_index,
+                                  FsearchDatabaseChunkedArray *folders_fast_sort_index,
                                   FsearchDatabaseIndexProperty sort_order,
                                   GtkSortType sort_type,
                                   GCancellable *cancellable) {
@@ -230,8 +230,8 @@ fsearch_database_search_view_sort(FsearchDatabaseSearchView *view,
                                   sort_order,
                                   files_in,
                                   folders_in,
-                                  files_fast_sorted,
-                                  folders_fast_sorted,
+                                  files_fast_sort_index,
+                                  folders_fast_sort_index,
                                   &files_new,
                                   &folders_new,
                                   &view->chain,
@@ -364,6 +364,12 @@ fsearch_database_search_view_remove(FsearchDatabaseSearchView *view,
 
 // Getters
 
+uint32_t
+fsearch_database_search_view_get_id(FsearchDatabaseSearchView *view) {
+    g_return_val_if_fail(view, 0);
+    return view->id;
+}
+
 FsearchDatabaseSearchInfo *
 fsearch_database_search_view_get_info(FsearchDatabaseSearchView *view) {
     g_return_val_if_fail(view, NULL);
@@ -382,4 +388,32 @@ FsearchQuery *
 fsearch_database_search_view_get_query(FsearchDatabaseSearchView *view) {
     g_return_val_if_fail(view, NULL);
     return fsearch_query_ref(view->query);
-}
\ No newline at end of file
+}
+
+bool
+fsearch_database_search_view_can_refine(FsearchDatabaseSearchView *view,
+                                        FsearchQuery *query,
+                                        FsearchDatabaseSortOrderChain chain) {
+    g_return_val_if_fail(view, false);
+    g_return_val_if_fail(query, false);
+
+    if (!view->is_complete || !view->query) {
+        return false;
+    }
+    if (!fsearch_database_sort_order_chain_equal(&view->chain, &chain)) {
+        return false;
+    }
+    return fsearch_query_is_refinement_of(query, view->query);
+}
+
+FsearchDatabaseChunkedArray *
+fsearch_database_search_view_get_files(FsearchDatabaseSearchView *view) {
+    g_return_val_if_fail(view, NULL);
+    return view->file_chunks ? fsearch_database_chunked_array_ref(view->file_chunks) : NULL;
+}
+
+FsearchDatabaseChunkedArray *
+fsearch_database_search_view_get_folders(FsearchDatabaseSearchView *view) {
+    g_return_val_if_fail(view, NULL);
+    return view->folder_chunks ? fsearch_database_chunked_array_ref(view->folder_chunks) : NULL;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "fsearch_array.h"
+#include "fsearch_database_chunked_array.h"
 #include "fsearch_database_entry.h"
 #include "fsearch_database_index_properties.h"
 #include "fsearch_database_search_info.h"
@@ -45,8 +46,8 @@ fsearch_database_search_view_remove(FsearchDatabaseSearchView *view,
 
 void
 fsearch_database_search_view_sort(FsearchDatabaseSearchView *view,
-                                  DynamicArray *files_fast_sorted,
-                                  DynamicArray *folders_fast_sorted,
+                                  FsearchDatabaseChunkedArray *files_fast_sort_index,
+                                  FsearchDatabaseChunkedArray *folders_fast_sort_index,
                                   FsearchDatabaseIndexProperty sort_order,
                                   GtkSortType sort_type,
                                   GCancellable *cancellable);
@@ -68,6 +69,9 @@ void
 fsearch_database_search_view_selection_foreach(FsearchDatabaseSearchView *view, GHFunc func, gpointer user_data);
 
 // Getters
+uint32_t
+fsearch_database_search_view_get_id(FsearchDatabaseSearchView *view);
+
 FsearchDatabaseSearchInfo *
 fsearch_database_search_view_get_info(FsearchDatabaseSearchView *view);
 
@@ -77,4 +81,18 @@ fsearch_database_search_view_get_entry_for_idx(FsearchDatabaseSearchView *view,
 FsearchQuery *
 fsearch_database_search_view_get_query(FsearchDatabaseSearchView *view);
 
+// Whether searching the results of `view` for `query` finds exactly what searching the whole index in the order of
+// `chain` would find, i.e. the view holds the complete results of a query which `query` refines and it's still
+// in that order.
+bool
+fsearch_database_search_view_can_refine(FsearchDatabaseSearchView *view,
+                                        FsearchQuery *query,
+                                        FsearchDatabaseSortOrderChain chain);
+
+FsearchDatabaseChunkedArray *
+fsearch_database_search_view_get_files(FsearchDatabaseSearchView *view);
+
+FsearchDatabaseChunkedArray *
+fsearch_database_search_view_get_folders(FsearchDatabaseSearchView *view);
+
 G_END_DECLS
\ No newline at end of file
@@ -3,8 +3,19 @@
 #include "fsearch_database_sort.h"
 
 #include "fsearch_database_entry.h"
+#include "fsearch_file_utils.h"
 
 #include <glib.h>
+#include <string.h>
+
+// Looking up the rank of an entry in a fast sort index takes about log2(n) comparisons, each of which is a lot more
+// expensive than checking the mark of an entry while walking the whole index
+#define RANK_LOOKUP_COST 16
+
+typedef struct {
+    uint64_t key;
+    FsearchDatabaseEntry *entry;
+} KeyedEntry;
 
 static char *
 chain_to_string(FsearchDatabaseSortOrderChain chain) {
@@ -86,8 +97,78 @@ fsearch_database_sort_order_chain_prepend(FsearchDatabaseSortOrderChain chain, F
     return result;
 }
 
+// Stable LSD radix sort by key, one byte per pass. Passes in which all keys share the same byte are skipped, so keys
+// only cost as many passes as they have significant bytes.
+static void
+radix_sort_keyed_entries(KeyedEntry *entries, uint32_t num_entries, GCancellable *cancellable) {
+    if (num_entries < 2) {
+        return;
+    }
+    g_autofree KeyedEntry *buffer = g_new(KeyedEntry, num_entries);
+    g_autofree uint32_t *counts = g_new0(uint32_t, sizeof(uint64_t) * 256);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        const uint64_t key = entries[i].key;
+        for (uint32_t byte = 0; byte < sizeof(uint64_t); ++byte) {
+            counts[byte * 256 + ((key >> (byte * 8)) & 0xff)]++;
+        }
+    }
+
+    KeyedEntry *src = entries;
+    KeyedEntry *dst = buffer;
+    for (uint32_t byte = 0; byte < sizeof(uint64_t); ++byte) {
+        uint32_t *byte_counts = counts + byte * 256;
+        const uint32_t shift = byte * 8;
+        if (byte_counts[(src[0].key >> shift) & 0xff] == num_entries) {
+            continue;
+        }
+        if (g_cancellable_is_cancelled(cancellable)) {
+            break;
+        }
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < 256; ++i) {
+            const uint32_t count = byte_counts[i];
+            byte_counts[i] = offset;
+            offset += count;
+        }
+        for (uint32_t i = 0; i < num_entries; ++i) {
+            dst[byte_counts[(src[i].key >> shift) & 0xff]++] = src[i];
+        }
+        KeyedEntry *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if (src != entries) {
+        memcpy(entries, src, num_entries * sizeof(KeyedEntry));
+    }
+}
+
+// Sorts `entries` by their ranks in the fast sort index, which costs O(log n) per entry instead of a walk over the
+// whole index. Returns NULL if some of the entries can't be found in the index.
+static DynamicArray *
+get_entries_sorted_by_rank(DynamicArray *entries, FsearchDatabaseChunkedArray *fast_sort_index) {
+    const uint32_t num_entries = darray_get_num_items(entries);
+    if (num_entries == 0) {
+        return darray_new(0);
+    }
+    g_autofree uint32_t *ranks = g_new(uint32_t, num_entries);
+    if (!fsearch_database_chunked_array_get_ranks(fast_sort_index, entries, ranks)) {
+        return NULL;
+    }
+    g_autofree KeyedEntry *keyed_entries = g_new(KeyedEntry, num_entries);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        keyed_entries[i] = (KeyedEntry){.key = ranks[i], .entry = darray_get_item(entries, i)};
+    }
+    radix_sort_keyed_entries(keyed_entries, num_entries, NULL);
+
+    DynamicArray *sorted = darray_new(num_entries);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        darray_add_item(sorted, keyed_entries[i].entry);
+    }
+    return sorted;
+}
+
 static DynamicArray *
-get_entries_sorted_from_reference_list(DynamicArray *old_list, DynamicArray *sorted_reference_list) {
+get_entries_sorted_from_reference_list(DynamicArray *old_list, FsearchDatabaseChunkedArray *sorted_reference_list) {
     const uint32_t num_items = darray_get_num_items(old_list);
     DynamicArray *new = darray_new(num_items);
     for (uint32_t i = 0; i < num_items; ++i) {
@@ -95,20 +176,221 @@ get_entries_sorted_from_reference_list(DynamicArray *old_list, DynamicArray *sor
         db_entry_set_mark(entry, 1);
     }
     uint32_t num_marked_found = 0;
-    const uint32_t num_items_in_sorted_reference_list = darray_get_num_items(sorted_reference_list);
-    for (uint32_t i = 0; i < num_items_in_sorted_reference_list && num_marked_found < num_items; ++i) {
-        FsearchDatabaseEntry *entry = darray_get_item(sorted_reference_list, i);
-        if (db_entry_get_mark(entry)) {
-            db_entry_set_mark(entry, 0);
-            darray_add_item(new, entry);
-            num_marked_found++;
+    g_autoptr(DynamicArray) chunks = fsearch_database_chunked_array_get_chunks(sorted_reference_list);
+    const uint32_t num_chunks = darray_get_num_items(chunks);
+    for (uint32_t c = 0; c < num_chunks && num_marked_found < num_items; ++c) {
+        DynamicArray *chunk = darray_get_item(chunks, c);
+        const uint32_t num_items_in_chunk = darray_get_num_items(chunk);
+        for (uint32_t i = 0; i < num_items_in_chunk && num_marked_found < num_items; ++i) {
+            FsearchDatabaseEntry *entry = darray_get_item(chunk, i);
+            if (db_entry_get_mark(entry)) {
+                db_entry_set_mark(entry, 0);
+                darray_add_item(new, entry);
+                num_marked_found++;
+            }
         }
     }
     return new;
 }
 
+bool
+fsearch_database_sort_property_is_numeric(FsearchDatabaseIndexProperty property) {
+    switch (property) {
+    case DATABASE_INDEX_PROPERTY_SIZE:
+    case DATABASE_INDEX_PROPERTY_MODIFICATION_TIME:
+    case DATABASE_INDEX_PROPERTY_ACCESS_TIME:
+    case DATABASE_INDEX_PROPERTY_STATUS_CHANGE_TIME:
+    case DATABASE_INDEX_PROPERTY_NUM_FILES:
+    case DATABASE_INDEX_PROPERTY_NUM_FOLDERS:
+        return true;
+    default:
+        return false;
+    }
+}
+
+DynamicArray *
+fsearch_database_sort_entries_by_numeric_property(DynamicArray *entries,
+                                                  FsearchDatabaseIndexProperty property,
+                                                  GCancellable *cancellable) {
+    g_return_val_if_fail(entries, NULL);
+    g_return_val_if_fail(fsearch_database_sort_property_is_numeric(property), NULL);
+
+    const uint32_t num_entries = darray_get_num_items(entries);
+    DynamicArray *sorted = darray_new(num_entries);
+    if (num_entries == 0) {
+        return sorted;
+    }
+    // Extract the keys once, instead of looking up the attributes of both entries in every comparison
+    g_autofree KeyedEntry *keyed_entries = g_new(KeyedEntry, num_entries);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        FsearchDatabaseEntry *entry = darray_get_item(entries, i);
+        keyed_entries[i] = (KeyedEntry){.key = db_entry_get_numeric_sort_key(entry, property), .entry = entry};
+    }
+    radix_sort_keyed_entries(keyed_entries, num_entries, cancellable);
+
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        darray_add_item(sorted, keyed_entries[i].entry);
+    }
+    return sorted;
+}
+
+static uint64_t
+load_be64(const uint8_t *bytes) {
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < sizeof(uint64_t); ++i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+// Gets the first 8 bytes of the memcmp-comparable sort key of `property` of `entry`. `complete_out` is set when they
+// hold the whole key, which is then also the case for all entries with the same abbreviated key. Returns false if
+// `entry` has no such key.
+static bool
+get_abbreviated_sort_key(FsearchDatabaseEntry *entry,
+                         FsearchDatabaseIndexProperty property,
+                         uint64_t *key_out,
+                         bool *complete_out) {
+    uint8_t key[sizeof(uint64_t)] = {0};
+    switch (property) {
+    case DATABASE_INDEX_PROPERTY_NAME: {
+        const char *name = db_entry_get_name_raw(entry);
+        const size_t key_len = fsearch_file_utils_get_path_sort_key(name ? name : "", key, sizeof(key));
+        *complete_out = key_len <= sizeof(key);
+        break;
+    }
+    case DATABASE_INDEX_PROPERTY_EXTENSION: {
+        // Extensions are compared with strcmp(), so their bytes are their key. Only those which are shorter than the
+        // abbreviated key end within it, which makes all entries with the same abbreviated key complete as well.
+        const char *extension = db_entry_get_extension(entry);
+        const size_t extension_len = extension ? strlen(extension) : 0;
+        memcpy(key, extension, MIN(extension_len, sizeof(key)));
+        *complete_out = extension_len < sizeof(key);
+        break;
+    }
+    case DATABASE_INDEX_PROPERTY_PATH: {
+        // Ranked parents compare by their rank alone
+        FsearchDatabaseEntry *parent = db_entry_get_parent(entry);
+        const uint32_t rank = parent ? db_entry_get_path_rank(parent) : 0;
+        if (parent && rank == 0) {
+            return false;
+        }
+        *key_out = rank;
+        *complete_out = true;
+        return true;
+    }
+    default:
+        return false;
+    }
+    *key_out = load_be64(key);
+    return true;
+}
+
+static void
+sort_keyed_entries_by_chain(KeyedEntry *entries,
+                            uint32_t num_entries,
+                            FsearchDatabaseEntryCompareContext *ctx,
+                            GCancellable *cancellable) {
+    if (num_entries < 64) {
+        // Stable insertion sort, like darray_sort() does for small arrays
+        for (uint32_t i = 1; i < num_entries; ++i) {
+            KeyedEntry val = entries[i];
+            uint32_t j = i;
+            while (j > 0 && db_entry_compare_entries_by_chain(&entries[j - 1].entry, &val.entry, ctx) > 0) {
+                entries[j] = entries[j - 1];
+                j--;
+            }
+            entries[j] = val;
+        }
+        return;
+    }
+    g_autoptr(DynamicArray) run = darray_new(num_entries);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        darray_add_item(run, entries[i].entry);
+    }
+    // Large runs (e.g. many files with the same long prefix) get sorted on the shared sort pool, which falls back to
+    // darray_sort() for smaller ones
+    darray_sort_multi_threaded(run, (DynamicArrayCompareDataFunc)db_entry_compare_entries_by_chain, cancellable, ctx);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        entries[i].entry = darray_get_item(run, i);
+    }
+}
+
+// Stable sort by the abbreviated sort keys. Only runs of entries with the same incomplete abbreviated key still need
+// to be compared with each other.
+static DynamicArray *
+sort_entries_by_abbreviated_key(DynamicArray *entries, FsearchDatabaseIndexProperty property, GCancellable *cancellable) {
+    const uint32_t num_entries = darray_get_num_items(entries);
+    FsearchDatabaseSortOrderChain chain = {};
+    chain.properties[chain.length++] = property;
+    g_autoptr(FsearchDatabaseEntryCompareContext) ctx = db_entry_compare_context_new(chain);
+
+    g_autofree KeyedEntry *keyed_entries = g_new(KeyedEntry, MAX(num_entries, 1));
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        FsearchDatabaseEntry *entry = darray_get_item(entries, i);
+        bool complete = false;
+        if (!get_abbreviated_sort_key(entry, property, &keyed_entries[i].key, &complete)) {
+            // Fall back to comparing all entries, with a sort which is stable as well
+            DynamicArray *sorted = darray_copy(entries);
+            darray_sort_multi_threaded(sorted,
+                                       (DynamicArrayCompareDataFunc)db_entry_compare_entries_by_chain,
+                                       cancellable,
+                                       ctx);
+            return sorted;
+        }
+        keyed_entries[i].entry = entry;
+    }
+    radix_sort_keyed_entries(keyed_entries, num_entries, cancellable);
+
+    for (uint32_t start = 0; start < num_entries && !g_cancellable_is_cancelled(cancellable);) {
+        uint32_t end = start + 1;
+        while (end < num_entries && keyed_entries[end].key == keyed_entries[start].key) {
+            end++;
+        }
+        if (end - start > 1) {
+            uint64_t key = 0;
+            bool complete = false;
+            get_abbreviated_sort_key(keyed_entries[start].entry, property, &key, &complete);
+            if (!complete) {
+                sort_keyed_entries_by_chain(keyed_entries + start, end - start, ctx, cancellable);
+            }
+        }
+        start = end;
+    }
+
+    DynamicArray *sorted = darray_new(num_entries);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        darray_add_item(sorted, keyed_entries[i].entry);
+    }
+    return sorted;
+}
+
+DynamicArray *
+fsearch_database_sort_entries_by_property(DynamicArray *entries,
+                                          FsearchDatabaseIndexProperty property,
+                                          GCancellable *cancellable) {
+    g_return_val_if_fail(entries, NULL);
+
+    if (fsearch_database_sort_property_is_numeric(property)) {
+        return fsearch_database_sort_entries_by_numeric_property(entries, property, cancellable);
+    }
+    switch (property) {
+    case DATABASE_INDEX_PROPERTY_NAME:
+    case DATABASE_INDEX_PROPERTY_PATH:
+    case DATABASE_INDEX_PROPERTY_EXTENSION:
+        return sort_entries_by_abbreviated_key(entries, property, cancellable);
+    default:
+        g_warning("[db_sort] no sort keys for %s", fsearch_database_index_property_to_string(property));
+        return NULL;
+    }
+}
+
 static DynamicArray *
 sort_entries(DynamicArray *entries_in, FsearchDatabaseSortOrderChain chain, GCancellable *cancellable, bool parallel_sort) {
+    if (chain.length > 0 && fsearch_database_sort_property_is_numeric(chain.properties[0])) {
+        // The entries are already ordered by the rest of the chain, so a stable sort by its first property completes it
+        return fsearch_database_sort_entries_by_numeric_property(entries_in, chain.properties[0], cancellable);
+    }
     DynamicArray *entries = darray_copy(entries_in);
     g_autoptr(FsearchDatabaseEntryCompareContext) ctx = db_entry_compare_context_new(chain);
     if (parallel_sort) {
@@ -123,20 +405,33 @@ sort_entries(DynamicArray *entries_in, FsearchDatabaseSortOrderChain chain, GCan
     return entries;
 }
 
+static bool
+prefer_rank_sort(uint32_t num_entries, uint32_t num_index_entries) {
+    const uint64_t lookup_cost = (uint64_t)num_entries * g_bit_storage(num_index_entries) * RANK_LOOKUP_COST;
+    return lookup_cost < num_index_entries;
+}
+
 static DynamicArray *
-fast_sort(DynamicArray *entries_in, DynamicArray *fast_sort_index, bool *whole_index_out) {
-    if (darray_get_num_items(entries_in) == darray_get_num_items(fast_sort_index)) {
+fast_sort(DynamicArray *entries_in, FsearchDatabaseChunkedArray *fast_sort_index, bool *whole_index_out) {
+    const uint32_t num_entries = darray_get_num_items(entries_in);
+    const uint32_t num_index_entries = fsearch_database_chunked_array_get_num_entries(fast_sort_index);
+    if (num_entries == num_index_entries) {
         // We're matching everything, and we have the entries already sorted in our index.
         // So we can just return references to the sorted indices.
         *whole_index_out = true;
-        return darray_ref(fast_sort_index);
+        return fsearch_database_chunked_array_get_joined(fast_sort_index);
     }
-    else {
-        // Another fast path. First we mark all entries we have currently in the view, then we walk the sorted
-        // index in order and add all marked entries to a new array.
-        *whole_index_out = false;
-        return get_entries_sorted_from_reference_list(entries_in, fast_sort_index);
+    *whole_index_out = false;
+    if (prefer_rank_sort(num_entries, num_index_entries)) {
+        // Only a few entries: look up where they're located in the index and sort them by that
+        DynamicArray *sorted = get_entries_sorted_by_rank(entries_in, fast_sort_index);
+        if (sorted) {
+            return sorted;
+        }
     }
+    // Another fast path. First we mark all entries we have currently in the view, then we walk the sorted
+    // index in order and add all marked entries to a new array.
+    return get_entries_sorted_from_reference_list(entries_in, fast_sort_index);
 }
 
 void
@@ -144,8 +439,8 @@ fsearch_database_sort_results(FsearchDatabaseSortOrderChain old_chain,
                               FsearchDatabaseIndexProperty new_sort_order,
                               DynamicArray *files_in,
                               DynamicArray *folders_in,
-                              DynamicArray *files_fast_sort_index,
-                              DynamicArray *folders_fast_sort_index,
+                              FsearchDatabaseChunkedArray *files_fast_sort_index,
+                              FsearchDatabaseChunkedArray *folders_fast_sort_index,
                               DynamicArray **files_out,
                               DynamicArray **folders_out,
                               FsearchDatabaseSortOrderChain *chain_out,
@@ -208,6 +503,7 @@ fsearch_database_sort_results(FsearchDatabaseSortOrderChain old_chain,
     // of each other.
     const FsearchDatabaseSortOrderChain new_chain = fsearch_database_sort_order_chain_prepend(old_chain, new_sort_order);
 
+    const bool radix_sort = fsearch_database_sort_property_is_numeric(new_sort_order);
     bool parallel_sort = true;
     if (new_sort_order == DATABASE_INDEX_PROPERTY_FILETYPE) {
         // Sorting by type can be really slow, because it accesses the filesystem to determine the type of files
@@ -243,6 +539,13 @@ fsearch_database_sort_results(FsearchDatabaseSortOrderChain old_chain,
         return;
     }
 
+    const char *sort_method = "single-threaded";
+    if (radix_sort) {
+        sort_method = "radix";
+    }
+    else if (parallel_sort) {
+        sort_method = "parallel";
+    }
     g_autofree char *chain_str = chain_to_string(new_chain);
     g_debug("[db_sort] manual sort by %s: %u file%s, %u folder%s in %.3f ms (%s%s) [%s]",
             fsearch_database_index_property_to_string(new_sort_order),
@@ -251,7 +554,7 @@ fsearch_database_sort_results(FsearchDatabaseSortOrderChain old_chain,
             num_folders,
             num_folders == 1 ? "" : "s",
             sort_time,
-            parallel_sort ? "parallel" : "single-threaded",
+            sort_method,
             folders_sorted ? "" : ", folders unsorted",
             chain_str);
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "fsearch_array.h"
+#include "fsearch_database_chunked_array.h"
 #include "fsearch_database_index_properties.h"
 
 #include <gio/gio.h>
@@ -19,13 +20,32 @@ fsearch_database_sort_order_chain_for_property(FsearchDatabaseIndexProperty prop
 FsearchDatabaseSortOrderChain
 fsearch_database_sort_order_chain_prepend(FsearchDatabaseSortOrderChain chain, FsearchDatabaseIndexProperty property);
 
+// Whether `property` is a numeric property, which fsearch_database_sort_entries_by_numeric_property() can sort by.
+bool
+fsearch_database_sort_property_is_numeric(FsearchDatabaseIndexProperty property);
+
+// Returns a copy of `entries` sorted by the numeric `property` with a radix sort. The sort is stable, so sorting an
+// array which is ordered by some chain yields an array ordered by that chain with `property` prepended.
+DynamicArray *
+fsearch_database_sort_entries_by_numeric_property(DynamicArray *entries,
+                                                  FsearchDatabaseIndexProperty property,
+                                                  GCancellable *cancellable);
+
+// Returns a copy of `entries` sorted by `property` alone, which can be a numeric property, name, path or extension.
+// Like the numeric sort it's stable. Names and extensions are compared by their sort keys and paths by the ranks of the
+// parent folders, so only few entries are compared directly.
+DynamicArray *
+fsearch_database_sort_entries_by_property(DynamicArray *entries,
+                                          FsearchDatabaseIndexProperty property,
+                                          GCancellable *cancellable);
+
 void
 fsearch_database_sort_results(FsearchDatabaseSortOrderChain old_chain,
                               FsearchDatabaseIndexProperty new_sort_order,
                               DynamicArray *files_in,
                               DynamicArray *folders_in,
-                              DynamicArray *files_fast_sort_index,
-                              DynamicArray *folders_fast_sort_index,
+                              FsearchDatabaseChunkedArray *files_fast_sort_index,
+                              FsearchDatabaseChunkedArray *folders_fast_sort_index,
                               DynamicArray **files_out,
                               DynamicArray **folders_out,
                               FsearchDatabaseSortOrderChain *chain_out,
@@ -0,0 +1,297 @@
+#define G_LOG_DOMAIN "fsearch-database-trigram-index"
+
+#include "fsearch_database_trigram_index.h"
+
+#include "fsearch_database_entry.h"
+#include "fsearch_database_entry_id_table.h"
+#include "fsearch_database_posting_list.h"
+
+#include <glib.h>
+#include <stdint.h>
+#include <string.h>
+
+// Trigrams are spread over several hash tables, so large batches of entries can be applied with one thread per shard
+#define MAX_NUM_SHARDS 16
+// Smaller batches (i.e. the usual file system change events) aren't worth spinning up threads for
+#define THRESHOLD_FOR_PARALLEL_UPDATE 10000
+
+typedef struct {
+    // Sorted by ID, so lists can be intersected and updated by merging
+    FsearchDatabasePostingList list;
+    uint32_t trigram;
+} TrigramPostingList;
+
+typedef struct {
+    // trigram -> TrigramPostingList
+    GHashTable *lists;
+} TrigramShard;
+
+struct FsearchDatabaseTrigramIndex {
+    TrigramShard shards[MAX_NUM_SHARDS];
+    uint32_t num_shards;
+
+    // Resolves the IDs in the posting lists, owned by the caller
+    FsearchDatabaseEntryIdTable *entry_ids;
+};
+
+typedef struct {
+    GMutex mutex;
+    GCond cond;
+    uint32_t num_pending;
+} TrigramUpdateGroup;
+
+typedef struct {
+    FsearchDatabaseTrigramIndex *index;
+    GArray *ids;
+    TrigramUpdateGroup *group;
+    uint32_t shard_idx;
+    bool remove;
+} TrigramShardUpdateContext;
+
+static inline uint32_t
+trigram_at(const char *str) {
+    return (uint32_t)(uint8_t)g_ascii_tolower(str[0]) << 16 | (uint32_t)(uint8_t)g_ascii_tolower(str[1]) << 8
+         | (uint32_t)(uint8_t)g_ascii_tolower(str[2]);
+}
+
+static inline uint32_t
+trigram_shard_idx(FsearchDatabaseTrigramIndex *index, uint32_t trigram) {
+    // Neighbouring trigrams differ in the low bits only, mix them before picking a shard
+    return ((trigram * 2654435761u) >> 16) % index->num_shards;
+}
+
+static void
+posting_list_free(TrigramPostingList *list) {
+    g_return_if_fail(list);
+    fsearch_database_posting_list_clear(&list->list);
+    g_free(list);
+}
+
+static void
+trigram_shard_update(FsearchDatabaseTrigramIndex *index, uint32_t shard_idx, GArray *ids, bool remove) {
+    TrigramShard *shard = &index->shards[shard_idx];
+    g_autoptr(GPtrArray) touched_lists = g_ptr_array_new();
+
+    // `ids` are sorted, so every batch ends up sorted as well
+    for (uint32_t i = 0; i < ids->len; ++i) {
+        const uint32_t id = g_array_index(ids, uint32_t, i);
+        FsearchDatabaseEntry *entry = fsearch_database_entry_id_table_get_entry(index->entry_ids, id);
+        const char *name = db_entry_get_name_raw_for_display(entry);
+        const size_t name_len = name ? strlen(name) : 0;
+        for (size_t j = 0; j + 3 <= name_len; ++j) {
+            const uint32_t trigram = trigram_at(name + j);
+            if (trigram_shard_idx(index, trigram) != shard_idx) {
+                continue;
+            }
+            TrigramPostingList *list = g_hash_table_lookup(shard->lists, GUINT_TO_POINTER(trigram));
+            if (!list) {
+                if (remove) {
+                    g_warning("[trigram_index] failed to remove entry: %s", name);
+                    continue;
+                }
+                list = g_new0(TrigramPostingList, 1);
+                list->trigram = trigram;
+                g_hash_table_insert(shard->lists, GUINT_TO_POINTER(trigram), list);
+            }
+            // The trigram might show up more than once in the entry's name
+            if (fsearch_database_posting_list_add_to_batch(&list->list, id)) {
+                g_ptr_array_add(touched_lists, list);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < touched_lists->len; ++i) {
+        TrigramPostingList *list = g_ptr_array_index(touched_lists, i);
+        if (remove) {
+            fsearch_database_posting_list_subtract_batch(&list->list);
+        }
+        else {
+            fsearch_database_posting_list_merge_batch(&list->list);
+        }
+        fsearch_database_posting_list_clear_batch(&list->list);
+
+        if (list->list.num_entries == 0) {
+            g_hash_table_remove(shard->lists, GUINT_TO_POINTER(list->trigram));
+        }
+    }
+}
+
+static void
+trigram_shard_update_thread(gpointer data, gpointer user_data) {
+    TrigramShardUpdateContext *ctx = data;
+    trigram_shard_update(ctx->index, ctx->shard_idx, ctx->ids, ctx->remove);
+
+    TrigramUpdateGroup *group = ctx->group;
+    g_mutex_lock(&group->mutex);
+    if (--group->num_pending == 0) {
+        g_cond_signal(&group->cond);
+    }
+    g_mutex_unlock(&group->mutex);
+}
+
+// All trigram indices share one pool, which lives as long as the process, instead of starting new threads for every
+// large batch
+static GThreadPool *
+get_update_pool(void) {
+    static GThreadPool *update_pool = NULL;
+    if (g_once_init_enter(&update_pool)) {
+        const int num_threads = (int)CLAMP(g_get_num_processors(), 1, MAX_NUM_SHARDS);
+        GThreadPool *pool = g_thread_pool_new(trigram_shard_update_thread, NULL, num_threads, FALSE, NULL);
+        g_once_init_leave(&update_pool, pool);
+    }
+    return update_pool;
+}
+
+static void
+trigram_index_update(FsearchDatabaseTrigramIndex *index, DynamicArray *entries, bool remove) {
+    if (!entries || darray_get_num_items(entries) == 0) {
+        return;
+    }
+
+    g_autoptr(GArray) ids = fsearch_database_entry_id_table_get_sorted_ids(index->entry_ids, entries);
+
+    if (index->num_shards < 2 || ids->len < THRESHOLD_FOR_PARALLEL_UPDATE) {
+        for (uint32_t i = 0; i < index->num_shards; ++i) {
+            trigram_shard_update(index, i, ids, remove);
+        }
+        return;
+    }
+
+    // Shards don't share any state, so each of them can be updated by its own thread
+    TrigramUpdateGroup group = {.num_pending = index->num_shards};
+    g_mutex_init(&group.mutex);
+    g_cond_init(&group.cond);
+
+    TrigramShardUpdateContext ctx[MAX_NUM_SHARDS] = {};
+    GThreadPool *pool = get_update_pool();
+    for (uint32_t i = 0; i < index->num_shards; ++i) {
+        ctx[i].index = index;
+        ctx[i].ids = ids;
+        ctx[i].group = &group;
+        ctx[i].shard_idx = i;
+        ctx[i].remove = remove;
+        g_thread_pool_push(pool, &ctx[i], NULL);
+    }
+
+    g_mutex_lock(&group.mutex);
+    while (group.num_pending > 0) {
+        g_cond_wait(&group.cond, &group.mutex);
+    }
+    g_mutex_unlock(&group.mutex);
+
+    g_mutex_clear(&group.mutex);
+    g_cond_clear(&group.cond);
+}
+
+static TrigramPostingList *
+trigram_index_lookup(FsearchDatabaseTrigramIndex *index, uint32_t trigram) {
+    TrigramShard *shard = &index->shards[trigram_shard_idx(index, trigram)];
+    return g_hash_table_lookup(shard->lists, GUINT_TO_POINTER(trigram));
+}
+
+static gint
+compare_posting_list_size(gconstpointer a, gconstpointer b) {
+    const TrigramPostingList *list_a = *(TrigramPostingList **)a;
+    const TrigramPostingList *list_b = *(TrigramPostingList **)b;
+    const uint32_t num_a = list_a->list.num_entries;
+    const uint32_t num_b = list_b->list.num_entries;
+    return num_a < num_b ? -1 : num_a > num_b ? 1 : 0;
+}
+
+FsearchDatabaseTrigramIndex *
+fsearch_database_trigram_index_new(FsearchDatabaseEntryIdTable *entry_ids, DynamicArray *entries) {
+    g_return_val_if_fail(entry_ids, NULL);
+
+    FsearchDatabaseTrigramIndex *index = g_new0(FsearchDatabaseTrigramIndex, 1);
+    index->entry_ids = entry_ids;
+    index->num_shards = CLAMP(g_get_num_processors(), 1, MAX_NUM_SHARDS);
+    for (uint32_t i = 0; i < index->num_shards; ++i) {
+        index->shards[i].lists = g_hash_table_new_full(g_direct_hash,
+                                                       g_direct_equal,
+                                                       NULL,
+                                                       (GDestroyNotify)posting_list_free);
+    }
+
+    trigram_index_update(index, entries, false);
+
+    return index;
+}
+
+void
+fsearch_database_trigram_index_free(FsearchDatabaseTrigramIndex *index) {
+    g_return_if_fail(index);
+
+    for (uint32_t i = 0; i < index->num_shards; ++i) {
+        g_clear_pointer(&index->shards[i].lists, g_hash_table_unref);
+    }
+    g_free(index);
+}
+
+void
+fsearch_database_trigram_index_add(FsearchDatabaseTrigramIndex *index, DynamicArray *entries) {
+    g_return_if_fail(index);
+    trigram_index_update(index, entries, false);
+}
+
+void
+fsearch_database_trigram_index_remove(FsearchDatabaseTrigramIndex *index, DynamicArray *entries) {
+    g_return_if_fail(index);
+    trigram_index_update(index, entries, true);
+}
+
+GArray *
+fsearch_database_trigram_index_get_ids(FsearchDatabaseTrigramIndex *index, const char *needle, uint32_t max_entries) {
+    g_return_val_if_fail(index, NULL);
+    g_return_val_if_fail(needle, NULL);
+
+    g_autoptr(GPtrArray) lists = g_ptr_array_new();
+    const size_t needle_len = strlen(needle);
+    for (size_t i = 0; i + 3 <= needle_len; ++i) {
+        TrigramPostingList *list = trigram_index_lookup(index, trigram_at(needle + i));
+        if (!list) {
+            // No entry contains this trigram, so nothing can match
+            return g_array_new(FALSE, FALSE, sizeof(uint32_t));
+        }
+        if (!g_ptr_array_find(lists, list, NULL)) {
+            g_ptr_array_add(lists, list);
+        }
+    }
+    if (lists->len == 0) {
+        return NULL;
+    }
+
+    // Start with the most selective trigram and only look up its entries in the others
+    g_ptr_array_sort(lists, compare_posting_list_size);
+    TrigramPostingList *smallest = g_ptr_array_index(lists, 0);
+    if (smallest->list.num_entries > max_entries) {
+        return NULL;
+    }
+
+    GArray *ids = g_array_sized_new(FALSE, FALSE, sizeof(uint32_t), smallest->list.num_entries);
+    for (uint32_t i = 0; i < smallest->list.num_entries; ++i) {
+        const uint32_t id = smallest->list.ids[i];
+        bool in_all_lists = true;
+        for (uint32_t j = 1; j < lists->len; ++j) {
+            TrigramPostingList *other = g_ptr_array_index(lists, j);
+            if (!fsearch_database_posting_list_contains(&other->list, id)) {
+                in_all_lists = false;
+                break;
+            }
+        }
+        if (in_all_lists) {
+            g_array_append_val(ids, id);
+        }
+    }
+    return ids;
+}
+
+uint32_t
+fsearch_database_trigram_index_get_num_trigrams(FsearchDatabaseTrigramIndex *index) {
+    g_return_val_if_fail(index, 0);
+
+    uint32_t num_trigrams = 0;
+    for (uint32_t i = 0; i < index->num_shards; ++i) {
+        num_trigrams += g_hash_table_size(index->shards[i].lists);
+    }
+    return num_trigrams;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "fsearch_array.h"
+#include "fsearch_database_entry_id_table.h"
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+G_BEGIN_DECLS
+
+// Inverted index from every (ASCII case folded) byte trigram of an entry name to the entries which contain it.
+// It only narrows down the entries which can possibly contain a given substring, the candidates still need to be
+// matched against the query. Entries are stored by their ID in `entry_ids`, so they must have one before they're added
+// and keep it until they're removed.
+//
+// Not thread safe, callers need to serialize all access.
+typedef struct FsearchDatabaseTrigramIndex FsearchDatabaseTrigramIndex;
+
+FsearchDatabaseTrigramIndex *
+fsearch_database_trigram_index_new(FsearchDatabaseEntryIdTable *entry_ids, DynamicArray *entries);
+
+void
+fsearch_database_trigram_index_free(FsearchDatabaseTrigramIndex *index);
+
+void
+fsearch_database_trigram_index_add(FsearchDatabaseTrigramIndex *index, DynamicArray *entries);
+
+// Entries must still be valid (i.e. have the same name as when they were added) while they're being removed
+void
+fsearch_database_trigram_index_remove(FsearchDatabaseTrigramIndex *index, DynamicArray *entries);
+
+// Returns the IDs (uint32_t, in ascending order) of all entries whose name contains every trigram of `needle`.
+// Returns NULL if the needle has no trigrams at all (i.e. it's shorter than three bytes) or if that would be more than
+// `max_entries` entries, in which case the caller is better off looking at every entry instead.
+GArray *
+fsearch_database_trigram_index_get_ids(FsearchDatabaseTrigramIndex *index, const char *needle, uint32_t max_entries);
+
+uint32_t
+fsearch_database_trigram_index_get_num_trigrams(FsearchDatabaseTrigramIndex *index);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FsearchDatabaseTrigramIndex, fsearch_database_trigram_index_free)
+
+G_END_DECLS
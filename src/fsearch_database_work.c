@@ -39,6 +39,7 @@ struct FsearchDatabaseWork {
             FsearchQuery *query;
             FsearchDatabaseIndexProperty sort_order;
             GtkSortType sort_type;
+            uint32_t limit;
         };
 
         // FSEARCH_DATABASE_WORK_GET_ITEM_INFO
@@ -224,7 +225,8 @@ FsearchDatabaseWork *
 fsearch_database_work_new_search(guint view_id,
                                  FsearchQuery *query,
                                  FsearchDatabaseIndexProperty sort_order,
-                                 GtkSortType sort_type) {
+                                 GtkSortType sort_type,
+                                 uint32_t limit) {
     g_return_val_if_fail(query, NULL);
 
     FsearchDatabaseWork *work = work_new();
@@ -232,6 +234,7 @@ fsearch_database_work_new_search(guint view_id,
     work->view_id = view_id;
     work->sort_order = sort_order;
     work->sort_type = sort_type;
+    work->limit = limit;
     work->query = fsearch_query_ref(query);
 
     return work;
@@ -333,6 +336,13 @@ fsearch_database_work_search_get_sort_type(FsearchDatabaseWork *work) {
     return work->sort_type;
 }
 
+uint32_t
+fsearch_database_work_search_get_limit(FsearchDatabaseWork *work) {
+    g_return_val_if_fail(work, 0);
+    g_return_val_if_fail(work->kind == FSEARCH_DATABASE_WORK_SEARCH, 0);
+    return work->limit;
+}
+
 FsearchDatabaseIndexProperty
 fsearch_database_work_sort_get_sort_order(FsearchDatabaseWork *work) {
     g_return_val_if_fail(work, NUM_DATABASE_INDEX_PROPERTIES);
@@ -80,7 +80,8 @@ FsearchDatabaseWork *
 fsearch_database_work_new_search(guint view_id,
                                  FsearchQuery *query,
                                  FsearchDatabaseIndexProperty sort_order,
-                                 GtkSortType sort_type);
+                                 GtkSortType sort_type,
+                                 uint32_t limit);
 
 FsearchDatabaseWork *
 fsearch_database_work_new_sort(guint view_id, FsearchDatabaseIndexProperty sort_order, GtkSortType sort_type);
@@ -127,6 +128,10 @@ fsearch_database_work_search_get_sort_order(FsearchDatabaseWork *work);
 GtkSortType
 fsearch_database_work_search_get_sort_type(FsearchDatabaseWork *work);
 
+// Maximum number of results the search is interested in, 0 for all of them
+uint32_t
+fsearch_database_work_search_get_limit(FsearchDatabaseWork *work);
+
 FsearchDatabaseIndexProperty
 fsearch_database_work_sort_get_sort_order(FsearchDatabaseWork *work);
 
@@ -595,11 +595,14 @@ fsearch_file_utils_get_file_type_non_localized(const char *name, gboolean is_dir
 }
 
 gchar *
-fsearch_file_utils_get_file_type(const char *name, gboolean is_dir) {
+fsearch_file_utils_get_file_type(const char *name, const char *content_type, gboolean is_dir) {
     gchar *type = NULL;
     if (is_dir) {
         type = g_strdup(_("Folder"));
     }
+    else if (content_type) {
+        type = g_content_type_get_description(content_type);
+    }
     else {
         type = get_content_type_description(name);
     }
@@ -861,4 +864,97 @@ fsearch_file_utils_cmp_paths(const char *s1, const char *s2) {
     default:
         return state;
     }
-}
\ No newline at end of file
+}
+
+typedef struct {
+    uint8_t *dest;
+    size_t dest_size;
+    size_t len;
+} SortKeyBuffer;
+
+static inline void
+sort_key_append(SortKeyBuffer *buf, uint8_t byte) {
+    if (buf->len < buf->dest_size) {
+        buf->dest[buf->len] = byte;
+    }
+    buf->len++;
+}
+
+static inline void
+sort_key_append_char(SortKeyBuffer *buf, unsigned char c) {
+    const int weight = path_char_weight(c);
+    if (weight < 0xff) {
+        sort_key_append(buf, weight);
+    }
+    else {
+        // The weights of the two largest characters don't fit into a byte
+        sort_key_append(buf, 0xff);
+        sort_key_append(buf, weight - 0xff);
+    }
+}
+
+static inline void
+sort_key_append_u32(SortKeyBuffer *buf, uint32_t value) {
+    sort_key_append(buf, value >> 24);
+    sort_key_append(buf, value >> 16);
+    sort_key_append(buf, value >> 8);
+    sort_key_append(buf, value);
+}
+
+size_t
+fsearch_file_utils_get_path_sort_key(const char *s, uint8_t *dest, size_t dest_size) {
+    SortKeyBuffer buf = {.dest = dest, .dest_size = dest_size, .len = 0};
+    const unsigned char *p = (const unsigned char *)s;
+    while (*p) {
+        if (!isdigit(*p)) {
+            sort_key_append_char(&buf, *p++);
+            continue;
+        }
+        const unsigned char *run = p;
+        while (isdigit(*p)) {
+            p++;
+        }
+        const uint32_t run_len = p - run;
+        if (*run != '0') {
+            // Integral numbers: longer ones are larger, those of the same length compare digit by digit
+            sort_key_append_char(&buf, '1');
+            if (run_len < 0xff) {
+                sort_key_append(&buf, run_len);
+            }
+            else {
+                sort_key_append(&buf, 0xff);
+                sort_key_append_u32(&buf, run_len);
+            }
+            for (uint32_t i = 0; i < run_len; ++i) {
+                sort_key_append_char(&buf, run[i]);
+            }
+            continue;
+        }
+
+        // Numbers with leading zeros: more zeros come first. With the same number of zeros, the ones which continue
+        // with other digits come first and compare like any other characters.
+        uint32_t num_zeros = 0;
+        while (num_zeros < run_len && run[num_zeros] == '0') {
+            num_zeros++;
+        }
+        sort_key_append_char(&buf, '0');
+        if (num_zeros < 0xff) {
+            sort_key_append(&buf, 0xff - num_zeros);
+        }
+        else {
+            sort_key_append(&buf, 0);
+            sort_key_append_u32(&buf, UINT32_MAX - num_zeros);
+        }
+        if (num_zeros == run_len) {
+            sort_key_append(&buf, 2);
+        }
+        else {
+            sort_key_append(&buf, 1);
+            for (uint32_t i = num_zeros; i < run_len; ++i) {
+                sort_key_append_char(&buf, run[i]);
+            }
+        }
+    }
+    sort_key_append(&buf, 0);
+    return buf.len;
+}
@@ -20,6 +20,7 @@
 
 #include <gtk/gtk.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef void
 (*FsearchFileUtilsOpenCallback)(gboolean result, const char *error_message, gpointer user_data);
@@ -49,8 +50,9 @@ fsearch_file_utils_open_path_list(GList *paths,
 bool
 fsearch_file_utils_open_path_list_with_command(GList *paths, const char *cmd, GString *error_message);
 
+// Describes the indexed `content_type` of a file, or guesses it from its `name` if the content type isn't known (NULL)
 gchar *
-fsearch_file_utils_get_file_type(const gchar *name, gboolean is_dir);
+fsearch_file_utils_get_file_type(const gchar *name, const char *content_type, gboolean is_dir);
 
 gchar *
 fsearch_file_utils_get_file_type_non_localized(const char *name, gboolean is_dir);
@@ -80,4 +82,11 @@ bool
 fsearch_file_utils_get_info(const char *path, time_t *mtime, off_t *size, bool *is_dir);
 
 int
-fsearch_file_utils_cmp_paths(const char *a, const char *b);
\ No newline at end of file
+fsearch_file_utils_cmp_paths(const char *a, const char *b);
+
+// Writes the sort key of `s` to `dest` and returns its length, like strxfrm(). Compared with memcmp() over the length of
+// the shorter one, keys are ordered the same way fsearch_file_utils_cmp_paths() orders the strings. At most `dest_size`
+// bytes are written, so a small buffer holds a prefix of the key, which is complete when the returned length is at most
+// `dest_size`.
+size_t
+fsearch_file_utils_get_path_sort_key(const char *s, uint8_t *dest, size_t dest_size);
\ No newline at end of file
@@ -0,0 +1,134 @@
+#define G_LOG_DOMAIN "fsearch-multi-pattern"
+
+#include "fsearch_multi_pattern.h"
+
+#include <string.h>
+
+// Upper bound for states * byte classes, which keeps the table at 16MB and the encoded transitions within 32 bits
+#define MAX_TABLE_SIZE (1u << 22)
+
+struct FsearchMultiPattern {
+    // Transitions are stored as (target state * num_classes) << 1, with the lowest bit set if the target state
+    // completes a pattern. This way the next lookup is a single addition.
+    uint32_t *table;
+    uint32_t num_classes;
+    uint8_t classes[256];
+};
+
+static uint8_t
+fold(uint8_t c, bool match_case) {
+    return match_case ? c : (uint8_t)g_ascii_tolower(c);
+}
+
+FsearchMultiPattern *
+fsearch_multi_pattern_new(const char **patterns, uint32_t num_patterns, bool match_case) {
+    g_return_val_if_fail(patterns, NULL);
+
+    // Every byte which appears in a pattern gets its own class, everything else falls into class 0
+    uint8_t classes[256] = {0};
+    uint32_t num_classes = 1;
+    uint32_t max_states = 1;
+    for (uint32_t i = 0; i < num_patterns; ++i) {
+        g_return_val_if_fail(patterns[i] && patterns[i][0] != '\0', NULL);
+        for (const uint8_t *p = (const uint8_t *)patterns[i]; *p != '\0'; ++p) {
+            const uint8_t c = fold(*p, match_case);
+            if (classes[c] == 0) {
+                classes[c] = num_classes++;
+            }
+            max_states++;
+        }
+    }
+    if (!match_case) {
+        for (uint32_t c = 'A'; c <= 'Z'; ++c) {
+            classes[c] = classes[g_ascii_tolower(c)];
+        }
+    }
+    if ((uint64_t)max_states * num_classes > MAX_TABLE_SIZE) {
+        return NULL;
+    }
+
+    // Build the trie. A transition to state 0 means there's none, because nothing leads back to the root.
+    uint32_t *delta = g_new0(uint32_t, max_states * num_classes);
+    bool *is_match = g_new0(bool, max_states);
+    uint32_t num_states = 1;
+    for (uint32_t i = 0; i < num_patterns; ++i) {
+        uint32_t state = 0;
+        for (const uint8_t *p = (const uint8_t *)patterns[i]; *p != '\0'; ++p) {
+            uint32_t *next = &delta[state * num_classes + classes[*p]];
+            if (*next == 0) {
+                *next = num_states++;
+            }
+            state = *next;
+        }
+        is_match[state] = true;
+    }
+
+    // Turn it into a DFA in breadth first order: missing transitions continue from the longest proper suffix of the
+    // state which is in the trie as well (its failure state), whose transitions are already complete.
+    uint32_t *fail = g_new0(uint32_t, num_states);
+    uint32_t *queue = g_new(uint32_t, num_states);
+    uint32_t queue_start = 0;
+    uint32_t queue_end = 0;
+    for (uint32_t c = 0; c < num_classes; ++c) {
+        const uint32_t child = delta[c];
+        if (child != 0) {
+            fail[child] = 0;
+            queue[queue_end++] = child;
+        }
+    }
+    while (queue_start < queue_end) {
+        const uint32_t state = queue[queue_start++];
+        is_match[state] |= is_match[fail[state]];
+        for (uint32_t c = 0; c < num_classes; ++c) {
+            uint32_t *next = &delta[state * num_classes + c];
+            const uint32_t fail_next = delta[fail[state] * num_classes + c];
+            if (*next != 0) {
+                fail[*next] = fail_next;
+                queue[queue_end++] = *next;
+            }
+            else {
+                *next = fail_next;
+            }
+        }
+    }
+
+    FsearchMultiPattern *multi_pattern = g_new0(FsearchMultiPattern, 1);
+    memcpy(multi_pattern->classes, classes, sizeof(classes));
+    multi_pattern->num_classes = num_classes;
+    multi_pattern->table = g_new(uint32_t, num_states * num_classes);
+    for (uint32_t i = 0; i < num_states * num_classes; ++i) {
+        const uint32_t target = delta[i];
+        multi_pattern->table[i] = ((target * num_classes) << 1) | (is_match[target] ? 1 : 0);
+    }
+
+    g_free(queue);
+    g_free(fail);
+    g_free(is_match);
+    g_free(delta);
+
+    return multi_pattern;
+}
+
+void
+fsearch_multi_pattern_free(FsearchMultiPattern *multi_pattern) {
+    if (!multi_pattern) {
+        return;
+    }
+    g_clear_pointer(&multi_pattern->table, g_free);
+    g_clear_pointer(&multi_pattern, g_free);
+}
+
+bool
+fsearch_multi_pattern_matches(const FsearchMultiPattern *multi_pattern, const char *haystack) {
+    const uint32_t *table = multi_pattern->table;
+    const uint8_t *classes = multi_pattern->classes;
+    uint32_t offset = 0;
+    for (const uint8_t *p = (const uint8_t *)haystack; *p != '\0'; ++p) {
+        const uint32_t next = table[offset + classes[*p]];
+        if (next & 1) {
+            return true;
+        }
+        offset = next >> 1;
+    }
+    return false;
+}
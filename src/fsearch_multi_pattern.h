@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+G_BEGIN_DECLS
+
+// An Aho-Corasick automaton, which finds out whether a string contains any of a set of patterns in a single pass.
+// It's stored as a dense transition table over byte classes (all bytes which don't appear in a pattern share a
+// class), so every input byte costs two table lookups, no matter how many patterns there are.
+typedef struct FsearchMultiPattern FsearchMultiPattern;
+
+// Builds the automaton for `num_patterns` non-empty `patterns`. Without `match_case` ASCII letters are compared case
+// insensitively, like fsearch_string_ascii_casestr does.
+// Returns NULL if the transition table would get too large.
+FsearchMultiPattern *
+fsearch_multi_pattern_new(const char **patterns, uint32_t num_patterns, bool match_case);
+
+void
+fsearch_multi_pattern_free(FsearchMultiPattern *multi_pattern);
+
+bool
+fsearch_multi_pattern_matches(const FsearchMultiPattern *multi_pattern, const char *haystack);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FsearchMultiPattern, fsearch_multi_pattern_free)
+
+G_END_DECLS
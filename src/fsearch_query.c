@@ -23,13 +23,29 @@
 #include "fsearch_query_flags.h"
 #include "fsearch_query_match_data.h"
 #include "fsearch_query_node.h"
+#include "fsearch_query_program.h"
 #include "fsearch_query_tree.h"
 #include "fsearch_string_utils.h"
 
 #include <glib.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+static void
+query_init_required_range(FsearchQuery *q, FsearchDatabaseIndexProperty property, FsearchQueryRange *range) {
+    range->start = INT64_MIN;
+    range->end = INT64_MAX;
+    range->is_set = fsearch_query_node_tree_get_required_range(q->query_tree, property, &range->start, &range->end);
+    if (q->filter_program) {
+        // The filter tree only applies when it got compiled
+        range->is_set |= fsearch_query_node_tree_get_required_range(q->filter_tree,
+                                                                    property,
+                                                                    &range->start,
+                                                                    &range->end);
+    }
+}
+
 FsearchQuery *
 fsearch_query_new(const char *search_term,
                   FsearchFilter *filter,
@@ -52,6 +68,20 @@ fsearch_query_new(const char *search_term,
         q->filter_tree = fsearch_query_node_tree_new(filter->query, filters, filter->flags);
     }
 
+    q->query_program = fsearch_query_program_new(q->query_tree);
+    if (q->filter_tree && !fsearch_string_is_empty(filter->query)) {
+        q->filter_program = fsearch_query_program_new(q->filter_tree);
+    }
+
+    q->required_parent_nodes = g_ptr_array_new();
+    fsearch_query_node_tree_collect_required_parent_nodes(q->query_tree, q->required_parent_nodes);
+    if (q->filter_program) {
+        fsearch_query_node_tree_collect_required_parent_nodes(q->filter_tree, q->required_parent_nodes);
+    }
+
+    query_init_required_range(q, DATABASE_INDEX_PROPERTY_SIZE, &q->required_size_range);
+    query_init_required_range(q, DATABASE_INDEX_PROPERTY_MODIFICATION_TIME, &q->required_mtime_range);
+
     q->filter = fsearch_filter_ref(filter);
     q->flags = flags;
     q->query_id = strdup(query_id ? query_id : "[missing_id]");
@@ -64,6 +94,9 @@ fsearch_query_free(FsearchQuery *query) {
     g_clear_pointer(&query->query_id, free);
     g_clear_pointer(&query->filter, fsearch_filter_unref);
     g_clear_pointer(&query->search_term, free);
+    g_clear_pointer(&query->required_parent_nodes, g_ptr_array_unref);
+    g_clear_pointer(&query->query_program, fsearch_query_program_free);
+    g_clear_pointer(&query->filter_program, fsearch_query_program_free);
     g_clear_pointer(&query->query_tree, fsearch_query_node_tree_free);
     g_clear_pointer(&query->filter_tree, fsearch_query_node_tree_free);
     g_clear_pointer(&query, free);
@@ -97,93 +130,24 @@ fsearch_query_matches_everything(FsearchQuery *query) {
     return false;
 }
 
-static bool
-highlight(GNode *node, FsearchDatabaseEntry *entry, FsearchQueryMatchData *match_data, FsearchDatabaseEntryType type) {
-    if (!node) {
-        return true;
-    }
-    FsearchQueryNode *n = node->data;
-    if (!n) {
-        return false;
-    }
-    if (n->type == FSEARCH_QUERY_NODE_TYPE_OPERATOR) {
-        GNode *left = node->children;
-        g_assert(left);
-        GNode *right = left->next;
-        if (n->operator == FSEARCH_QUERY_NODE_OPERATOR_AND
-        ) {
-            return highlight(left, entry, match_data, type) && highlight(right, entry, match_data, type);
-        }
-        else if (n->operator == FSEARCH_QUERY_NODE_OPERATOR_OR
-        ) {
-            return highlight(left, entry, match_data, type) || highlight(right, entry, match_data, type);
-        }
-        else {
-            return !highlight(left, entry, match_data, type);
-        }
-    }
-    else {
-        if (n->flags & QUERY_FLAG_FOLDERS_ONLY && type != DATABASE_ENTRY_TYPE_FOLDER) {
-            return false;
-        }
-        if (n->flags & QUERY_FLAG_FILES_ONLY && type != DATABASE_ENTRY_TYPE_FILE) {
-            return false;
-        }
-
-        return n->highlight_func ? n->highlight_func(n, match_data) : false;
-    }
-}
+bool
+fsearch_query_is_refinement_of(FsearchQuery *query, FsearchQuery *old_query) {
+    g_return_val_if_fail(query, false);
+    g_return_val_if_fail(old_query, false);
 
-static bool
-matches(GNode *node, FsearchDatabaseEntry *entry, FsearchQueryMatchData *match_data, FsearchDatabaseEntryType type) {
-    if (!node) {
-        return true;
-    }
-    FsearchQueryNode *n = node->data;
-    if (!n) {
+    if (query->flags != old_query->flags) {
         return false;
     }
-    if (n->type == FSEARCH_QUERY_NODE_TYPE_OPERATOR) {
-        GNode *left = node->children;
-        g_assert(left);
-        GNode *right = left->next;
-        if (n->operator == FSEARCH_QUERY_NODE_OPERATOR_AND
-        ) {
-            return matches(left, entry, match_data, type) && matches(right, entry, match_data, type);
-        }
-        else if (n->operator == FSEARCH_QUERY_NODE_OPERATOR_OR
-        ) {
-            return matches(left, entry, match_data, type) || matches(right, entry, match_data, type);
-        }
-        else {
-            return !matches(left, entry, match_data, type);
-        }
-    }
-    else {
-        if (n->flags & QUERY_FLAG_FOLDERS_ONLY && type != DATABASE_ENTRY_TYPE_FOLDER) {
-            return false;
-        }
-        if (n->flags & QUERY_FLAG_FILES_ONLY && type != DATABASE_ENTRY_TYPE_FILE) {
-            return false;
-        }
-
-        return n->search_func(n, match_data);
+    if (!query->filter != !old_query->filter) {
+        return false;
     }
+    return fsearch_query_node_tree_is_refinement_of(query->filter_tree, old_query->filter_tree)
+        && fsearch_query_node_tree_is_refinement_of(query->query_tree, old_query->query_tree);
 }
 
 static bool
-filter_entry(FsearchDatabaseEntry *entry, FsearchQueryMatchData *match_data, FsearchQuery *query) {
-    if (!query->filter) {
-        return true;
-    }
-    if (query->filter->query == NULL || fsearch_string_is_empty(query->filter->query)) {
-        return true;
-    }
-    FsearchDatabaseEntryType type = db_entry_get_type(entry);
-    if (query->filter_tree) {
-        return matches(query->filter_tree, entry, match_data, type);
-    }
-    return true;
+filter_entry(FsearchQuery *query, FsearchQueryMatchData *match_data, FsearchDatabaseEntryType type) {
+    return query->filter_program ? fsearch_query_program_match(query->filter_program, match_data, type) : true;
 }
 
 bool
@@ -194,13 +158,12 @@ fsearch_query_highlight(FsearchQuery *query, FsearchQueryMatchData *match_data)
     }
 
     FsearchDatabaseEntryType type = db_entry_get_type(entry);
-    GNode *token = query->query_tree;
 
-    if (!filter_entry(entry, match_data, query)) {
+    if (!filter_entry(query, match_data, type)) {
         return false;
     }
 
-    return highlight(token, entry, match_data, type);
+    return fsearch_query_program_highlight(query->query_program, match_data, type);
 }
 
 bool
@@ -211,11 +174,10 @@ fsearch_query_match(FsearchQuery *query, FsearchQueryMatchData *match_data) {
     }
 
     FsearchDatabaseEntryType type = db_entry_get_type(entry);
-    GNode *token = query->query_tree;
 
-    if (!filter_entry(entry, match_data, query)) {
+    if (!filter_entry(query, match_data, type)) {
         return false;
     }
 
-    return matches(token, entry, match_data, type);
-}
\ No newline at end of file
+    return fsearch_query_program_match(query->query_program, match_data, type);
+}
@@ -22,10 +22,19 @@
 #include <gtk/gtk.h>
 #include <pango/pango.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "fsearch_filter_manager.h"
 #include "fsearch_query_flags.h"
 #include "fsearch_query_match_data.h"
+#include "fsearch_query_program.h"
+
+// Inclusive range of values of a property every match lies in
+typedef struct FsearchQueryRange {
+    int64_t start;
+    int64_t end;
+    bool is_set;
+} FsearchQueryRange;
 
 typedef struct FsearchQuery {
     char *search_term;
@@ -36,6 +45,18 @@ typedef struct FsearchQuery {
     GNode *query_tree;
     GNode *filter_tree;
 
+    // The trees compiled for matching, filter_program is NULL if the filter accepts every entry
+    FsearchQueryProgram *query_program;
+    FsearchQueryProgram *filter_program;
+
+    // Parent path matches every match satisfies (borrowed from the trees), see
+    // fsearch_query_node_tree_collect_required_parent_nodes()
+    GPtrArray *required_parent_nodes;
+
+    // See fsearch_query_node_tree_get_required_range()
+    FsearchQueryRange required_size_range;
+    FsearchQueryRange required_mtime_range;
+
     char *query_id;
 
     FsearchQueryFlags flags;
@@ -63,6 +84,11 @@ fsearch_query_unref(FsearchQuery *query);
 bool
 fsearch_query_matches_everything(FsearchQuery *query);
 
+// Whether every entry matching `query` also matches `old_query`, so the results of `old_query` can be searched
+// instead of the whole index.
+bool
+fsearch_query_is_refinement_of(FsearchQuery *query, FsearchQuery *old_query);
+
 bool
 fsearch_query_match(FsearchQuery *queyr, FsearchQueryMatchData *match_data);
 
@@ -37,9 +37,11 @@ struct FsearchQueryMatchData {
 FsearchUtfBuilder *
 fsearch_query_match_data_get_utf_parent_path_builder(FsearchQueryMatchData *match_data) {
     if (!match_data->utf_parent_path_ready) {
+        const char *parent_path = fsearch_query_match_data_get_parent_path_str(match_data);
         match_data->utf_parent_path_ready =
-            fsearch_utf_builder_normalize_and_fold_case(match_data->utf_parent_path_builder,
-                                                        fsearch_query_match_data_get_parent_path_str(match_data));
+            match_data->entry && db_entry_path_is_ascii(match_data->entry)
+                ? fsearch_utf_builder_fold_case_ascii(match_data->utf_parent_path_builder, parent_path)
+                : fsearch_utf_builder_normalize_and_fold_case(match_data->utf_parent_path_builder, parent_path);
     }
     return match_data->utf_parent_path_builder;
 }
@@ -47,9 +49,11 @@ fsearch_query_match_data_get_utf_parent_path_builder(FsearchQueryMatchData *matc
 FsearchUtfBuilder *
 fsearch_query_match_data_get_utf_name_builder(FsearchQueryMatchData *match_data) {
     if (!match_data->utf_name_ready) {
+        const char *name = db_entry_get_name_raw_for_display(match_data->entry);
         match_data->utf_name_ready =
-            fsearch_utf_builder_normalize_and_fold_case(match_data->utf_name_builder,
-                                                        db_entry_get_name_raw_for_display(match_data->entry));
+            match_data->entry && db_entry_name_is_ascii(match_data->entry)
+                ? fsearch_utf_builder_fold_case_ascii(match_data->utf_name_builder, name)
+                : fsearch_utf_builder_normalize_and_fold_case(match_data->utf_name_builder, name);
     }
     return match_data->utf_name_builder;
 }
@@ -57,9 +61,11 @@ fsearch_query_match_data_get_utf_name_builder(FsearchQueryMatchData *match_data)
 FsearchUtfBuilder *
 fsearch_query_match_data_get_utf_path_builder(FsearchQueryMatchData *match_data) {
     if (!match_data->utf_path_ready) {
+        const char *path = fsearch_query_match_data_get_path_str(match_data);
         match_data->utf_path_ready =
-            fsearch_utf_builder_normalize_and_fold_case(match_data->utf_path_builder,
-                                                        fsearch_query_match_data_get_path_str(match_data));
+            match_data->entry && db_entry_name_is_ascii(match_data->entry) && db_entry_path_is_ascii(match_data->entry)
+                ? fsearch_utf_builder_fold_case_ascii(match_data->utf_path_builder, path)
+                : fsearch_utf_builder_normalize_and_fold_case(match_data->utf_path_builder, path);
     }
     return match_data->utf_path_builder;
 }
@@ -1,6 +1,7 @@
 #include "fsearch_query_matchers.h"
 #include "fsearch_database_entry.h"
 #include "fsearch_query_node.h"
+#include "fsearch_string_utils.h"
 #include <string.h>
 
 uint32_t
@@ -157,6 +158,56 @@ add_path_highlight(FsearchQueryMatchData *match_data, uint32_t start_idx, uint32
     }
 }
 
+static bool
+regex_literal_equal(const char *a, const char *b, size_t len, bool match_case) {
+    return match_case ? memcmp(a, b, len) == 0 : g_ascii_strncasecmp(a, b, len) == 0;
+}
+
+static bool
+regex_literal_ends(FsearchQueryNode *node, const char *haystack, size_t haystack_len, bool match_case) {
+    return haystack_len >= node->regex_suffix_len
+        && regex_literal_equal(haystack + haystack_len - node->regex_suffix_len,
+                               node->regex_suffix,
+                               node->regex_suffix_len,
+                               match_case);
+}
+
+// Whether the haystack lacks one of the literals the regex requires, in which case it can't match
+static bool
+regex_prefilter_rejects(FsearchQueryNode *node, const char *haystack, size_t haystack_len) {
+    if (node->regex_prefix_len == 0 && node->regex_suffix_len == 0 && node->regex_literal_len == 0) {
+        return false;
+    }
+    const bool match_case = node->flags & QUERY_FLAG_MATCH_CASE;
+    if (!match_case && !g_str_is_ascii(haystack)) {
+        // Caseless matching also folds some non-ASCII characters onto ASCII letters (e.g. KELVIN SIGN onto k), which
+        // the ASCII comparisons below would miss
+        return false;
+    }
+    if (node->regex_prefix_len > 0
+        && (haystack_len < node->regex_prefix_len
+            || !regex_literal_equal(haystack, node->regex_prefix, node->regex_prefix_len, match_case))) {
+        return true;
+    }
+    if (node->regex_suffix_len > 0) {
+        // `$` also matches right before a trailing newline
+        const bool ends_with_newline = haystack_len > 0 && haystack[haystack_len - 1] == '\n';
+        if (!regex_literal_ends(node, haystack, haystack_len, match_case)
+            && (!ends_with_newline || !regex_literal_ends(node, haystack, haystack_len - 1, match_case))) {
+            return true;
+        }
+    }
+    if (node->regex_literal_len > 0) {
+        const char *res = match_case
+                            ? strstr(haystack, node->regex_literal)
+                            : fsearch_string_ascii_casestr(haystack, node->regex_literal, node->regex_literal_len);
+        if (!res) {
+            return true;
+        }
+    }
+    return false;
+}
+
 uint32_t
 fsearch_query_matcher_regex(FsearchQueryNode *node, FsearchQueryMatchData *match_data) {
     const char *haystack = node->haystack_func(match_data);
@@ -164,6 +215,9 @@ fsearch_query_matcher_regex(FsearchQueryNode *node, FsearchQueryMatchData *match
     if (G_UNLIKELY(!node->regex)) {
         return 0;
     }
+    if (regex_prefilter_rejects(node, haystack, haystack_len)) {
+        return 0;
+    }
     const int32_t thread_id = fsearch_query_match_data_get_thread_id(match_data);
     pcre2_match_data *regex_match_data = g_ptr_array_index(node->regex_match_data_for_threads, thread_id);
     if (G_UNLIKELY(!regex_match_data)) {
@@ -219,7 +273,7 @@ fsearch_query_matcher_strstr(FsearchQueryNode *node, FsearchQueryMatchData *matc
 
 uint32_t
 fsearch_query_matcher_strcasestr(FsearchQueryNode *node, FsearchQueryMatchData *match_data) {
-    return strcasestr(node->haystack_func(match_data), node->needle) ? 1 : 0;
+    return fsearch_string_ascii_casestr(node->haystack_func(match_data), node->needle, node->needle_len) ? 1 : 0;
 }
 
 uint32_t
@@ -323,19 +377,19 @@ fsearch_query_matcher_highlight_ascii(FsearchQueryNode *node, FsearchQueryMatchD
         }
         return 0;
     }
-    const char *dest = node->flags & QUERY_FLAG_MATCH_CASE ? strstr(haystack, node->needle)
-                                                           : strcasestr(haystack, node->needle);
+    const char *dest = node->flags & QUERY_FLAG_MATCH_CASE
+                         ? strstr(haystack, node->needle)
+                         : fsearch_string_ascii_casestr(haystack, node->needle, node->needle_len);
     if (!dest) {
         return 0;
     }
     if (search_in_path) {
-        const size_t needle_len = strlen(node->needle);
-        add_path_highlight(match_data, dest - haystack, needle_len);
+        add_path_highlight(match_data, dest - haystack, node->needle_len);
     }
     else {
         PangoAttribute *pa = pango_attr_weight_new(PANGO_WEIGHT_BOLD);
         pa->start_index = dest - haystack;
-        pa->end_index = pa->start_index + strlen(node->needle);
+        pa->end_index = pa->start_index + node->needle_len;
         fsearch_query_match_data_add_highlight(match_data, pa, DATABASE_INDEX_PROPERTY_NAME);
     }
     return 1;
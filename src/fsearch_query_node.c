@@ -45,6 +45,9 @@ fsearch_query_node_free(FsearchQueryNode *node) {
         g_ptr_array_free(g_steal_pointer(&node->regex_match_data_for_threads), TRUE);
     }
     g_clear_pointer(&node->regex, pcre2_code_free);
+    g_clear_pointer(&node->regex_prefix, g_free);
+    g_clear_pointer(&node->regex_suffix, g_free);
+    g_clear_pointer(&node->regex_literal, g_free);
 
     g_clear_pointer(&node, g_free);
 }
@@ -264,6 +267,15 @@ fsearch_query_node_new_regex(const char *search_term, FsearchQueryFlags flags) {
         g_ptr_array_add(qnode->regex_match_data_for_threads, pcre2_match_data_create_from_pattern(qnode->regex, NULL));
     }
 
+    fsearch_string_get_regex_literals(search_term, &qnode->regex_prefix, &qnode->regex_suffix, &qnode->regex_literal);
+    qnode->regex_prefix_len = qnode->regex_prefix ? strlen(qnode->regex_prefix) : 0;
+    qnode->regex_suffix_len = qnode->regex_suffix ? strlen(qnode->regex_suffix) : 0;
+    qnode->regex_literal_len = qnode->regex_literal ? strlen(qnode->regex_literal) : 0;
+    g_debug("[regex] literals: prefix \"%s\", suffix \"%s\", literal \"%s\"",
+            qnode->regex_prefix ? qnode->regex_prefix : "",
+            qnode->regex_suffix ? qnode->regex_suffix : "",
+            qnode->regex_literal ? qnode->regex_literal : "");
+
     qnode->search_func = fsearch_query_matcher_regex;
     qnode->haystack_func = (FsearchQueryNodeHaystackFunc *)(flags & QUERY_FLAG_SEARCH_IN_PATH
                                                                 ? fsearch_query_match_data_get_path_str
@@ -408,6 +420,8 @@ fsearch_query_node_new_contenttype(const char *search_term, FsearchQueryFlags fl
         g_string_prepend(res->description, "contenttype_");
         res->haystack_func = (FsearchQueryNodeHaystackFunc *)fsearch_query_match_data_get_content_type_str;
         res->highlight_func = fsearch_query_matcher_highlight_none;
+        // Content types which aren't indexed have to be looked up on the file system. The index store still searches
+        // multi threaded when they are.
         res->wants_single_threaded_search = true;
     }
 
@@ -445,4 +459,23 @@ fsearch_query_node_new(const char *search_term, FsearchQueryFlags flags) {
         res->triggers_auto_match_path = triggers_auto_match_path;
     }
     return res;
+}
+
+bool
+fsearch_query_node_is_name_substring_match(FsearchQueryNode *node) {
+    g_assert(node);
+    if (node->type != FSEARCH_QUERY_NODE_TYPE_QUERY || !node->needle
+        || node->haystack_func != (FsearchQueryNodeHaystackFunc *)fsearch_query_match_data_get_name_str) {
+        return false;
+    }
+    // Exact matches imply the needle is a substring of the name as well
+    return node->search_func == fsearch_query_matcher_strstr || node->search_func == fsearch_query_matcher_strcasestr
+        || node->search_func == fsearch_query_matcher_strcmp || node->search_func == fsearch_query_matcher_strcasecmp;
+}
+
+bool
+fsearch_query_node_is_extension_match(FsearchQueryNode *node) {
+    g_assert(node);
+    return node->type == FSEARCH_QUERY_NODE_TYPE_QUERY && node->search_func == fsearch_query_matcher_extension
+        && node->search_term_list;
 }
\ No newline at end of file
@@ -72,6 +72,14 @@ struct FsearchQueryNode {
     pcre2_code *regex;
     GPtrArray *regex_match_data_for_threads;
     bool regex_jit_available;
+    // Literals every match of the regex must contain (see fsearch_string_get_regex_literals), or NULL.
+    // They reject most candidates much faster than the regex engine.
+    char *regex_prefix;
+    size_t regex_prefix_len;
+    char *regex_suffix;
+    size_t regex_suffix_len;
+    char *regex_literal;
+    size_t regex_literal_len;
 
     FsearchQueryFlags flags;
 
@@ -144,4 +152,12 @@ FsearchQueryNode *
 fsearch_query_node_new_contenttype(const char *search_term, FsearchQueryFlags flags);
 
 FsearchQueryNode *
-fsearch_query_node_new(const char *search_term, FsearchQueryFlags flags);
\ No newline at end of file
+fsearch_query_node_new(const char *search_term, FsearchQueryFlags flags);
+
+// Whether every entry `node` matches contains its needle in the name (exact matches included)
+bool
+fsearch_query_node_is_name_substring_match(FsearchQueryNode *node);
+
+// Whether `node` matches entries by their extension, the extensions are its search_term_list
+bool
+fsearch_query_node_is_extension_match(FsearchQueryNode *node);
\ No newline at end of file
@@ -0,0 +1,342 @@
+#define G_LOG_DOMAIN "fsearch-query-program"
+
+#include "fsearch_query_program.h"
+#include "fsearch_multi_pattern.h"
+#include "fsearch_query_flags.h"
+#include "fsearch_query_matchers.h"
+#include "fsearch_query_node.h"
+
+#include <stdint.h>
+
+typedef enum {
+    // result = node accepts the entry type && node matches
+    QUERY_OP_TEST,
+    // result = node accepts the entry type && any node of the group matches
+    QUERY_OP_TEST_GROUP,
+    // result = false
+    QUERY_OP_FALSE,
+    // result = !result
+    QUERY_OP_NOT,
+    // jump to target if the result is false/true, i.e. the left operand of AND/OR already decided the result
+    QUERY_OP_JUMP_IF_FALSE,
+    QUERY_OP_JUMP_IF_TRUE,
+} FsearchQueryOp;
+
+// Operands of an OR which all search for a plain substring in the same haystack. Their needles are combined into a
+// single automaton, so the group costs about as much as a single substring search.
+typedef struct {
+    FsearchMultiPattern *multi_pattern;
+    // The nodes in the order they appeared in the query, highlighting still uses them one by one
+    GPtrArray *nodes;
+} FsearchQueryNodeGroup;
+
+typedef struct {
+    FsearchQueryNodeMatchFunc *search_func;
+    FsearchQueryNodeMatchFunc *highlight_func;
+    FsearchQueryNode *node;
+    const FsearchQueryNodeGroup *group;
+    uint32_t target;
+    uint8_t op;
+    // bit (1 << FsearchDatabaseEntryType) is set for every entry type the node applies to
+    uint8_t entry_types;
+} FsearchQueryInstruction;
+
+struct FsearchQueryProgram {
+    FsearchQueryInstruction *instructions;
+    uint32_t num_instructions;
+    GPtrArray *groups;
+};
+
+#define ENTRY_TYPE_BIT(type) ((uint8_t)(1u << (type)))
+
+// Below that many operands the individual substring searches are just as fast
+#define MIN_NODES_PER_GROUP 4
+
+static void
+group_free(FsearchQueryNodeGroup *group) {
+    g_clear_pointer(&group->multi_pattern, fsearch_multi_pattern_free);
+    g_clear_pointer(&group->nodes, g_ptr_array_unref);
+    g_free(group);
+}
+
+static uint32_t
+emit(GArray *instructions, FsearchQueryOp op, FsearchQueryNode *node) {
+    FsearchQueryInstruction instruction = {0};
+    instruction.op = op;
+    if (node) {
+        instruction.node = node;
+        instruction.search_func = node->search_func;
+        instruction.highlight_func = node->highlight_func;
+        instruction.entry_types = ENTRY_TYPE_BIT(DATABASE_ENTRY_TYPE_FOLDER) | ENTRY_TYPE_BIT(DATABASE_ENTRY_TYPE_FILE);
+        if (node->flags & QUERY_FLAG_FOLDERS_ONLY) {
+            instruction.entry_types &= ~ENTRY_TYPE_BIT(DATABASE_ENTRY_TYPE_FILE);
+        }
+        if (node->flags & QUERY_FLAG_FILES_ONLY) {
+            instruction.entry_types &= ~ENTRY_TYPE_BIT(DATABASE_ENTRY_TYPE_FOLDER);
+        }
+    }
+    g_array_append_val(instructions, instruction);
+    return instructions->len - 1;
+}
+
+static bool
+is_substring_node(FsearchQueryNode *n) {
+    return n && n->type == FSEARCH_QUERY_NODE_TYPE_QUERY && n->needle_len > 0
+        && (n->search_func == fsearch_query_matcher_strstr || n->search_func == fsearch_query_matcher_strcasestr);
+}
+
+static bool
+can_share_group(FsearchQueryNode *a, FsearchQueryNode *b) {
+    const FsearchQueryFlags type_flags = QUERY_FLAG_FOLDERS_ONLY | QUERY_FLAG_FILES_ONLY;
+    return a->search_func == b->search_func && a->haystack_func == b->haystack_func
+        && (a->flags & type_flags) == (b->flags & type_flags);
+}
+
+// Collects the operands of `tree` and all the ORs directly nested in it, in evaluation order
+static void
+collect_or_operands(GNode *tree, GPtrArray *operands) {
+    FsearchQueryNode *n = tree->data;
+    if (n && n->type == FSEARCH_QUERY_NODE_TYPE_OPERATOR && n->operator == FSEARCH_QUERY_NODE_OPERATOR_OR) {
+        for (GNode *child = tree->children; child; child = child->next) {
+            collect_or_operands(child, operands);
+        }
+        return;
+    }
+    g_ptr_array_add(operands, tree);
+}
+
+// Tries to build a group from the substring node `operands[start]` and all later operands it can share one with
+static FsearchQueryNodeGroup *
+group_new(GPtrArray *operands, uint32_t start, FsearchQueryNodeGroup **operand_groups) {
+    FsearchQueryNode *first = ((GNode *)g_ptr_array_index(operands, start))->data;
+    g_autoptr(GPtrArray) nodes = g_ptr_array_new();
+    g_autoptr(GPtrArray) needles = g_ptr_array_new();
+    for (uint32_t i = start; i < operands->len; ++i) {
+        FsearchQueryNode *n = ((GNode *)g_ptr_array_index(operands, i))->data;
+        if (!operand_groups[i] && is_substring_node(n) && can_share_group(first, n)) {
+            g_ptr_array_add(nodes, n);
+            g_ptr_array_add(needles, n->needle);
+        }
+    }
+    if (nodes->len < MIN_NODES_PER_GROUP) {
+        return NULL;
+    }
+    FsearchMultiPattern *multi_pattern = fsearch_multi_pattern_new((const char **)needles->pdata,
+                                                                   needles->len,
+                                                                   first->search_func
+                                                                       == fsearch_query_matcher_strstr);
+    if (!multi_pattern) {
+        return NULL;
+    }
+    FsearchQueryNodeGroup *group = g_new0(FsearchQueryNodeGroup, 1);
+    group->multi_pattern = multi_pattern;
+    group->nodes = g_steal_pointer(&nodes);
+    return group;
+}
+
+static void
+compile(GNode *tree, GArray *instructions, GPtrArray *groups);
+
+// Compiles an OR chain with enough substring operands as a flat sequence of operands, where the substring searches
+// are replaced by group tests. Returns false if there's nothing to group.
+static bool
+compile_or_groups(GNode *tree, GArray *instructions, GPtrArray *groups) {
+    g_autoptr(GPtrArray) operands = g_ptr_array_new();
+    collect_or_operands(tree, operands);
+    if (operands->len < MIN_NODES_PER_GROUP) {
+        return false;
+    }
+
+    g_autofree FsearchQueryNodeGroup **operand_groups = g_new0(FsearchQueryNodeGroup *, operands->len);
+    bool has_groups = false;
+    for (uint32_t i = 0; i < operands->len; ++i) {
+        FsearchQueryNode *n = ((GNode *)g_ptr_array_index(operands, i))->data;
+        if (operand_groups[i] || !is_substring_node(n)) {
+            continue;
+        }
+        FsearchQueryNodeGroup *group = group_new(operands, i, operand_groups);
+        if (!group) {
+            continue;
+        }
+        for (uint32_t j = i; j < operands->len; ++j) {
+            if (g_ptr_array_find(group->nodes, ((GNode *)g_ptr_array_index(operands, j))->data, NULL)) {
+                operand_groups[j] = group;
+            }
+        }
+        g_ptr_array_add(groups, group);
+        g_debug("[query_program] grouped %u substring searches", group->nodes->len);
+        has_groups = true;
+    }
+    if (!has_groups) {
+        return false;
+    }
+
+    g_autoptr(GArray) jumps = g_array_new(FALSE, FALSE, sizeof(uint32_t));
+    for (uint32_t i = 0; i < operands->len; ++i) {
+        GNode *operand = g_ptr_array_index(operands, i);
+        FsearchQueryNodeGroup *group = operand_groups[i];
+        if (group && g_ptr_array_index(group->nodes, 0) != operand->data) {
+            // The group was already tested at its first node
+            continue;
+        }
+        if (i > 0) {
+            const uint32_t jump = emit(instructions, QUERY_OP_JUMP_IF_TRUE, NULL);
+            g_array_append_val(jumps, jump);
+        }
+        if (group) {
+            const uint32_t test = emit(instructions, QUERY_OP_TEST_GROUP, operand->data);
+            g_array_index(instructions, FsearchQueryInstruction, test).group = group;
+        }
+        else {
+            compile(operand, instructions, groups);
+        }
+    }
+    for (uint32_t i = 0; i < jumps->len; ++i) {
+        g_array_index(instructions, FsearchQueryInstruction, g_array_index(jumps, uint32_t, i)).target =
+            instructions->len;
+    }
+    return true;
+}
+
+static void
+compile(GNode *tree, GArray *instructions, GPtrArray *groups) {
+    FsearchQueryNode *n = tree->data;
+    if (!n) {
+        emit(instructions, QUERY_OP_FALSE, NULL);
+        return;
+    }
+    if (n->type != FSEARCH_QUERY_NODE_TYPE_OPERATOR) {
+        emit(instructions, QUERY_OP_TEST, n);
+        return;
+    }
+    if (n->operator == FSEARCH_QUERY_NODE_OPERATOR_OR && compile_or_groups(tree, instructions, groups)) {
+        return;
+    }
+
+    GNode *left = tree->children;
+    g_assert(left);
+    compile(left, instructions, groups);
+
+    if (n->operator == FSEARCH_QUERY_NODE_OPERATOR_NOT) {
+        emit(instructions, QUERY_OP_NOT, NULL);
+        return;
+    }
+
+    GNode *right = left->next;
+    g_assert(right);
+    const uint32_t jump = emit(instructions,
+                               n->operator == FSEARCH_QUERY_NODE_OPERATOR_AND ? QUERY_OP_JUMP_IF_FALSE
+                                                                               : QUERY_OP_JUMP_IF_TRUE,
+                               NULL);
+    compile(right, instructions, groups);
+    g_array_index(instructions, FsearchQueryInstruction, jump).target = instructions->len;
+}
+
+FsearchQueryProgram *
+fsearch_query_program_new(GNode *tree) {
+    FsearchQueryProgram *program = g_new0(FsearchQueryProgram, 1);
+    program->groups = g_ptr_array_new_with_free_func((GDestroyNotify)group_free);
+    if (!tree) {
+        // An empty program matches everything
+        return program;
+    }
+    GArray *instructions = g_array_new(FALSE, FALSE, sizeof(FsearchQueryInstruction));
+    compile(tree, instructions, program->groups);
+    program->num_instructions = instructions->len;
+    program->instructions = (FsearchQueryInstruction *)g_array_free(instructions, FALSE);
+    return program;
+}
+
+void
+fsearch_query_program_free(FsearchQueryProgram *program) {
+    if (!program) {
+        return;
+    }
+    g_clear_pointer(&program->instructions, g_free);
+    g_clear_pointer(&program->groups, g_ptr_array_unref);
+    g_clear_pointer(&program, g_free);
+}
+
+static bool
+group_highlight(const FsearchQueryNodeGroup *group, FsearchQueryMatchData *match_data) {
+    // Like the OR chain it replaces, this stops at the first match
+    for (uint32_t i = 0; i < group->nodes->len; ++i) {
+        FsearchQueryNode *n = g_ptr_array_index(group->nodes, i);
+        if (n->highlight_func && n->highlight_func(n, match_data)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline __attribute__((always_inline)) bool
+run(const FsearchQueryProgram *program, FsearchQueryMatchData *match_data, FsearchDatabaseEntryType type, bool highlight) {
+    const FsearchQueryInstruction *instructions = program->instructions;
+    const uint32_t num_instructions = program->num_instructions;
+    const uint8_t type_bit = ENTRY_TYPE_BIT(type);
+
+    bool result = true;
+    uint32_t pc = 0;
+    while (pc < num_instructions) {
+        const FsearchQueryInstruction *instruction = &instructions[pc];
+        switch (instruction->op) {
+        case QUERY_OP_TEST:
+            if (!(instruction->entry_types & type_bit)) {
+                result = false;
+            }
+            else if (highlight) {
+                result = instruction->highlight_func ? instruction->highlight_func(instruction->node, match_data)
+                                                     : false;
+            }
+            else {
+                result = instruction->search_func(instruction->node, match_data);
+            }
+            pc++;
+            break;
+        case QUERY_OP_TEST_GROUP:
+            if (!(instruction->entry_types & type_bit)) {
+                result = false;
+            }
+            else if (highlight) {
+                result = group_highlight(instruction->group, match_data);
+            }
+            else {
+                result = fsearch_multi_pattern_matches(instruction->group->multi_pattern,
+                                                       instruction->node->haystack_func(match_data));
+            }
+            pc++;
+            break;
+        case QUERY_OP_FALSE:
+            result = false;
+            pc++;
+            break;
+        case QUERY_OP_NOT:
+            result = !result;
+            pc++;
+            break;
+        case QUERY_OP_JUMP_IF_FALSE:
+            pc = result ? pc + 1 : instruction->target;
+            break;
+        case QUERY_OP_JUMP_IF_TRUE:
+            pc = result ? instruction->target : pc + 1;
+            break;
+        default:
+            g_assert_not_reached();
+        }
+    }
+    return result;
+}
+
+bool
+fsearch_query_program_match(const FsearchQueryProgram *program,
+                            FsearchQueryMatchData *match_data,
+                            FsearchDatabaseEntryType type) {
+    return run(program, match_data, type, false);
+}
+
+bool
+fsearch_query_program_highlight(const FsearchQueryProgram *program,
+                                FsearchQueryMatchData *match_data,
+                                FsearchDatabaseEntryType type) {
+    return run(program, match_data, type, true);
+}
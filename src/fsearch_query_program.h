@@ -0,0 +1,35 @@
+#pragma once
+
+#include "fsearch_database_entry.h"
+#include "fsearch_query_match_data.h"
+
+#include <glib.h>
+#include <stdbool.h>
+
+G_BEGIN_DECLS
+
+// A query tree compiled to a flat list of instructions, which can be evaluated without recursion.
+// AND and OR become conditional jumps past their right operand, so it's short-circuited exactly like the tree.
+//
+// The program borrows the nodes of the tree, so the tree must outlive it.
+typedef struct FsearchQueryProgram FsearchQueryProgram;
+
+FsearchQueryProgram *
+fsearch_query_program_new(GNode *tree);
+
+void
+fsearch_query_program_free(FsearchQueryProgram *program);
+
+bool
+fsearch_query_program_match(const FsearchQueryProgram *program,
+                            FsearchQueryMatchData *match_data,
+                            FsearchDatabaseEntryType type);
+
+bool
+fsearch_query_program_highlight(const FsearchQueryProgram *program,
+                                FsearchQueryMatchData *match_data,
+                                FsearchDatabaseEntryType type);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FsearchQueryProgram, fsearch_query_program_free)
+
+G_END_DECLS
@@ -1,10 +1,15 @@
 #define G_LOG_DOMAIN "fsearch-query-tree"
 
 #include "fsearch_query_tree.h"
+#include "fsearch_query_match_data.h"
+#include "fsearch_query_matchers.h"
 #include "fsearch_query_node.h"
 #include "fsearch_query_parser.h"
 #include "fsearch_string_utils.h"
 
+#include <stdint.h>
+#include <string.h>
+
 static gboolean
 free_tree_node(GNode *node, gpointer data);
 
@@ -278,6 +283,350 @@ fsearch_query_node_tree_wants_single_threaded_search(GNode *tree) {
     return wants_single_threaded_search;
 }
 
+void
+fsearch_query_node_tree_collect_required_parent_nodes(GNode *tree, GPtrArray *parent_nodes) {
+    g_assert(parent_nodes);
+    if (!tree) {
+        return;
+    }
+    FsearchQueryNode *n = tree->data;
+    if (!n) {
+        return;
+    }
+    if (n->type == FSEARCH_QUERY_NODE_TYPE_OPERATOR) {
+        if (n->operator == FSEARCH_QUERY_NODE_OPERATOR_AND) {
+            for (GNode *child = tree->children; child; child = child->next) {
+                fsearch_query_node_tree_collect_required_parent_nodes(child, parent_nodes);
+            }
+        }
+        return;
+    }
+    // Only plain byte-wise comparisons, the folder a needle refers to can then be looked up by its path
+    if (n->haystack_func == (FsearchQueryNodeHaystackFunc *)fsearch_query_match_data_get_parent_path_str
+        && n->needle_len > 0
+        && (n->search_func == fsearch_query_matcher_strcmp || n->search_func == fsearch_query_matcher_strcasecmp)) {
+        g_ptr_array_add(parent_nodes, n);
+    }
+}
+
+static bool
+node_is_equal(FsearchQueryNode *n, FsearchQueryNode *old) {
+    if (n->type != old->type) {
+        return false;
+    }
+    if (n->type == FSEARCH_QUERY_NODE_TYPE_OPERATOR) {
+        return n->operator == old->operator;
+    }
+    // All other node state (search term lists, regex, UTF builders, ...) is derived from these
+    return n->search_func == old->search_func && n->haystack_func == old->haystack_func && n->flags == old->flags
+        && n->comparison_type == old->comparison_type && n->num_start == old->num_start && n->num_end == old->num_end
+        && g_strcmp0(n->needle, old->needle) == 0;
+}
+
+static bool
+node_is_substring_refinement(FsearchQueryNode *n, FsearchQueryNode *old) {
+    if (n->type != FSEARCH_QUERY_NODE_TYPE_QUERY || old->type != FSEARCH_QUERY_NODE_TYPE_QUERY) {
+        return false;
+    }
+    // Only plain ASCII substring matches: the UTF matchers fold and normalize the needle as a whole, so extending it
+    // doesn't necessarily extend the folded form.
+    if (n->search_func != old->search_func || n->haystack_func != old->haystack_func || n->flags != old->flags) {
+        return false;
+    }
+    if (!n->needle || !old->needle) {
+        return false;
+    }
+    if (n->search_func == fsearch_query_matcher_strstr) {
+        return strstr(n->needle, old->needle) != NULL;
+    }
+    else if (n->search_func == fsearch_query_matcher_strcasestr) {
+        return fsearch_string_ascii_casestr(n->needle, old->needle, old->needle_len) != NULL;
+    }
+    return false;
+}
+
+static bool
+node_tree_is_refinement_of(GNode *tree, GNode *old_tree, bool negated) {
+    if (!tree || !old_tree) {
+        return tree == old_tree;
+    }
+    FsearchQueryNode *n = tree->data;
+    FsearchQueryNode *old = old_tree->data;
+    if (!n || !old) {
+        return n == old;
+    }
+    if (g_node_n_children(tree) != g_node_n_children(old_tree)) {
+        return false;
+    }
+    if (!node_is_equal(n, old)) {
+        // Below a NOT a narrower needle matches more entries, not less
+        return !negated && tree->children == NULL && node_is_substring_refinement(n, old);
+    }
+    if (n->type == FSEARCH_QUERY_NODE_TYPE_OPERATOR && n->operator == FSEARCH_QUERY_NODE_OPERATOR_NOT) {
+        negated = true;
+    }
+    else if (n->type == FSEARCH_QUERY_NODE_TYPE_OPERATOR && g_node_n_children(tree) == 2) {
+        // The planner might have swapped the operands of AND and OR differently for both queries, e.g. because a
+        // needle got longer and is now considered more selective. Either order gives the same results.
+        GNode *left = tree->children;
+        GNode *old_left = old_tree->children;
+        return (node_tree_is_refinement_of(left, old_left, negated)
+                && node_tree_is_refinement_of(left->next, old_left->next, negated))
+            || (node_tree_is_refinement_of(left, old_left->next, negated)
+                && node_tree_is_refinement_of(left->next, old_left, negated));
+    }
+    for (GNode *child = tree->children, *old_child = old_tree->children; child && old_child;
+         child = child->next, old_child = old_child->next) {
+        if (!node_tree_is_refinement_of(child, old_child, negated)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+fsearch_query_node_tree_is_refinement_of(GNode *tree, GNode *old_tree) {
+    return node_tree_is_refinement_of(tree, old_tree, false);
+}
+
+// Narrows [*start, *end] down to the values a numeric node accepts
+static bool
+node_intersect_range(FsearchQueryNode *n, int64_t *start, int64_t *end) {
+    int64_t node_start = INT64_MIN;
+    int64_t node_end = INT64_MAX;
+    switch (n->comparison_type) {
+    case FSEARCH_QUERY_NODE_COMPARISON_EQUAL:
+        node_start = n->num_start;
+        node_end = n->num_start;
+        break;
+    case FSEARCH_QUERY_NODE_COMPARISON_GREATER:
+        if (n->num_start == INT64_MAX) {
+            // nothing is greater, i.e. an empty range
+            node_start = INT64_MAX;
+            node_end = INT64_MIN;
+        }
+        else {
+            node_start = n->num_start + 1;
+        }
+        break;
+    case FSEARCH_QUERY_NODE_COMPARISON_GREATER_EQ:
+        node_start = n->num_start;
+        break;
+    case FSEARCH_QUERY_NODE_COMPARISON_SMALLER:
+        if (n->num_start == INT64_MIN) {
+            node_start = INT64_MAX;
+            node_end = INT64_MIN;
+        }
+        else {
+            node_end = n->num_start - 1;
+        }
+        break;
+    case FSEARCH_QUERY_NODE_COMPARISON_SMALLER_EQ:
+        node_end = n->num_start;
+        break;
+    case FSEARCH_QUERY_NODE_COMPARISON_RANGE:
+        if (n->num_end == INT64_MIN) {
+            node_start = INT64_MAX;
+            node_end = INT64_MIN;
+        }
+        else {
+            node_start = n->num_start;
+            node_end = n->num_end - 1;
+        }
+        break;
+    default:
+        return false;
+    }
+    *start = MAX(*start, node_start);
+    *end = MIN(*end, node_end);
+    return true;
+}
+
+bool
+fsearch_query_node_tree_get_required_range(GNode *tree,
+                                           FsearchDatabaseIndexProperty property,
+                                           int64_t *start,
+                                           int64_t *end) {
+    g_assert(start);
+    g_assert(end);
+    if (!tree) {
+        return false;
+    }
+    FsearchQueryNode *n = tree->data;
+    if (!n) {
+        return false;
+    }
+    if (n->type == FSEARCH_QUERY_NODE_TYPE_OPERATOR) {
+        bool res = false;
+        if (n->operator == FSEARCH_QUERY_NODE_OPERATOR_AND) {
+            for (GNode *child = tree->children; child; child = child->next) {
+                res |= fsearch_query_node_tree_get_required_range(child, property, start, end);
+            }
+        }
+        return res;
+    }
+
+    FsearchQueryNodeMatchFunc *search_func = NULL;
+    switch (property) {
+    case DATABASE_INDEX_PROPERTY_SIZE:
+        search_func = fsearch_query_matcher_size;
+        break;
+    case DATABASE_INDEX_PROPERTY_MODIFICATION_TIME:
+        search_func = fsearch_query_matcher_date_modified;
+        break;
+    default:
+        return false;
+    }
+    if (n->search_func != search_func) {
+        return false;
+    }
+    return node_intersect_range(n, start, end);
+}
+
+// Rough cost of evaluating a node for one entry, relative to a numeric comparison
+#define QUERY_PLAN_COST_NUMERIC 1.0
+#define QUERY_PLAN_COST_EXTENSION 2.0
+#define QUERY_PLAN_COST_ASCII 4.0
+#define QUERY_PLAN_COST_UTF 10.0
+#define QUERY_PLAN_COST_REGEX 25.0
+#define QUERY_PLAN_COST_PATH 20.0
+#define QUERY_PLAN_COST_CONTENT_TYPE 1000.0
+
+static bool
+haystack_is_path(FsearchQueryNodeHaystackFunc *haystack_func) {
+    return haystack_func == (FsearchQueryNodeHaystackFunc *)fsearch_query_match_data_get_path_str
+        || haystack_func == (FsearchQueryNodeHaystackFunc *)fsearch_query_match_data_get_parent_path_str
+        || haystack_func == (FsearchQueryNodeHaystackFunc *)fsearch_query_match_data_get_utf_path_builder
+        || haystack_func == (FsearchQueryNodeHaystackFunc *)fsearch_query_match_data_get_utf_parent_path_builder;
+}
+
+static double
+needle_selectivity(FsearchQueryNode *n) {
+    // Only distinguish very short needles. Extending a needle can still reorder the tree, which
+    // fsearch_query_node_tree_is_refinement_of takes into account.
+    if (n->needle_len <= 1) {
+        return 0.5;
+    }
+    else if (n->needle_len == 2) {
+        return 0.2;
+    }
+    return 0.05;
+}
+
+static void
+query_node_estimate(FsearchQueryNode *n, double *cost, double *selectivity) {
+    FsearchQueryNodeMatchFunc *f = n->search_func;
+    if (f == fsearch_query_matcher_true || f == fsearch_query_matcher_false) {
+        *cost = 0.0;
+        *selectivity = f == fsearch_query_matcher_true ? 1.0 : 0.0;
+        return;
+    }
+
+    if (f == fsearch_query_matcher_size || f == fsearch_query_matcher_date_modified || f == fsearch_query_matcher_depth
+        || f == fsearch_query_matcher_childcount || f == fsearch_query_matcher_childfilecount
+        || f == fsearch_query_matcher_childfoldercount) {
+        *cost = QUERY_PLAN_COST_NUMERIC;
+        switch (n->comparison_type) {
+        case FSEARCH_QUERY_NODE_COMPARISON_EQUAL:
+            *selectivity = 0.1;
+            break;
+        case FSEARCH_QUERY_NODE_COMPARISON_RANGE:
+            *selectivity = 0.3;
+            break;
+        default:
+            *selectivity = 0.5;
+            break;
+        }
+        return;
+    }
+    else if (f == fsearch_query_matcher_extension) {
+        *cost = QUERY_PLAN_COST_EXTENSION;
+        *selectivity = 0.1;
+        return;
+    }
+    else if (f == fsearch_query_matcher_strstr || f == fsearch_query_matcher_strcasestr) {
+        *cost = QUERY_PLAN_COST_ASCII;
+        *selectivity = needle_selectivity(n);
+    }
+    else if (f == fsearch_query_matcher_strcmp || f == fsearch_query_matcher_strcasecmp) {
+        *cost = QUERY_PLAN_COST_ASCII;
+        *selectivity = 0.01;
+    }
+    else if (f == fsearch_query_matcher_utf_strcasestr) {
+        *cost = QUERY_PLAN_COST_UTF;
+        *selectivity = needle_selectivity(n);
+    }
+    else if (f == fsearch_query_matcher_utf_strcasecmp) {
+        *cost = QUERY_PLAN_COST_UTF;
+        *selectivity = 0.01;
+    }
+    else {
+        // regex, wildcards and anything we don't know about
+        *cost = QUERY_PLAN_COST_REGEX;
+        *selectivity = 0.2;
+    }
+
+    if (n->haystack_func == (FsearchQueryNodeHaystackFunc *)fsearch_query_match_data_get_content_type_str) {
+        *cost += QUERY_PLAN_COST_CONTENT_TYPE;
+        *selectivity = 0.2;
+    }
+    else if (haystack_is_path(n->haystack_func)) {
+        *cost += QUERY_PLAN_COST_PATH;
+    }
+}
+
+static void
+plan_tree(GNode *tree, double *cost, double *selectivity) {
+    *cost = 0.0;
+    *selectivity = 1.0;
+    FsearchQueryNode *n = tree ? tree->data : NULL;
+    if (!n) {
+        return;
+    }
+    if (n->type != FSEARCH_QUERY_NODE_TYPE_OPERATOR) {
+        query_node_estimate(n, cost, selectivity);
+        return;
+    }
+
+    GNode *left = tree->children;
+    g_assert(left);
+    double left_cost = 0.0;
+    double left_selectivity = 1.0;
+    plan_tree(left, &left_cost, &left_selectivity);
+
+    if (n->operator == FSEARCH_QUERY_NODE_OPERATOR_NOT) {
+        *cost = left_cost;
+        *selectivity = 1.0 - left_selectivity;
+        return;
+    }
+
+    GNode *right = left->next;
+    g_assert(right);
+    double right_cost = 0.0;
+    double right_selectivity = 1.0;
+    plan_tree(right, &right_cost, &right_selectivity);
+
+    // The right child only gets evaluated if the left one didn't already decide the result:
+    // AND needs the left child to match, OR needs it to fail.
+    const bool is_and = n->operator == FSEARCH_QUERY_NODE_OPERATOR_AND;
+    const double left_first = left_cost + (is_and ? left_selectivity : 1.0 - left_selectivity) * right_cost;
+    const double right_first = right_cost + (is_and ? right_selectivity : 1.0 - right_selectivity) * left_cost;
+    if (right_first < left_first) {
+        g_node_unlink(right);
+        g_node_prepend(tree, right);
+    }
+    *cost = MIN(left_first, right_first);
+    *selectivity = is_and ? left_selectivity * right_selectivity
+                          : left_selectivity + right_selectivity - left_selectivity * right_selectivity;
+}
+
+void
+fsearch_query_node_tree_plan(GNode *tree) {
+    double cost = 0.0;
+    double selectivity = 1.0;
+    plan_tree(tree, &cost, &selectivity);
+}
+
 GNode *
 fsearch_query_node_tree_new(const char *search_term, FsearchFilterManager *filters, FsearchQueryFlags flags) {
     g_autofree char *query = g_strdup(search_term);
@@ -291,6 +640,7 @@ fsearch_query_node_tree_new(const char *search_term, FsearchFilterManager *filte
     else {
         res = get_query_tree(query_stripped, filters, flags);
     }
+    fsearch_query_node_tree_plan(res);
     return res;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "fsearch_database_index_properties.h"
 #include "fsearch_filter_manager.h"
 
 #include <glib.h>
@@ -13,6 +14,30 @@ fsearch_query_node_tree_triggers_auto_match_case(GNode *tree);
 bool
 fsearch_query_node_tree_wants_single_threaded_search(GNode *tree);
 
+// Adds all parent path matches (FsearchQueryNode *) to `parent_nodes` which every entry matching `tree` must satisfy,
+// i.e. the ones which are only combined with AND and compare the path byte-wise. The nodes are owned by the tree.
+void
+fsearch_query_node_tree_collect_required_parent_nodes(GNode *tree, GPtrArray *parent_nodes);
+
+// Narrows the inclusive range [*start, *end] down to the values of `property` (size or modification time) which
+// every entry matching `tree` must have, i.e. the ones of comparisons which are only combined with AND.
+// Returns false if there are no such comparisons. The range is empty (*start > *end) if nothing can match.
+bool
+fsearch_query_node_tree_get_required_range(GNode *tree,
+                                           FsearchDatabaseIndexProperty property,
+                                           int64_t *start,
+                                           int64_t *end);
+
+// Whether every entry which matches `tree` is guaranteed to match `old_tree` as well, e.g. because one of its
+// substring needles got extended. It's conservative, i.e. it might return false even though that's the case.
+bool
+fsearch_query_node_tree_is_refinement_of(GNode *tree, GNode *old_tree);
+
+// Reorders the children of AND and OR nodes, so that the cheapest and most selective ones get evaluated first.
+// Doesn't change which entries the tree matches. fsearch_query_node_tree_new() already does that.
+void
+fsearch_query_node_tree_plan(GNode *tree);
+
 GNode *
 fsearch_query_node_tree_new(const char *search_term, FsearchFilterManager *filters, FsearchQueryFlags flags);
 
@@ -155,8 +155,11 @@ fsearch_result_view_query_tooltip(FsearchResultView *view,
         break;
     }
     case DATABASE_INDEX_PROPERTY_FILETYPE: {
+        // Prefer the indexed content type, which sorting by type uses as well
+        const GQuark content_type = fsearch_database_entry_info_get_content_type(info);
         text = fsearch_file_utils_get_file_type(
             fsearch_database_entry_info_get_name(info)->str,
+            content_type ? g_quark_to_string(content_type) : NULL,
             fsearch_database_entry_info_get_entry_type(info) == DATABASE_ENTRY_TYPE_FOLDER ? TRUE : FALSE);
         break;
     }
@@ -450,12 +453,15 @@ fsearch_result_view_draw_row(FsearchResultView *result_view,
                 text = fsearch_database_entry_info_get_extension(info)->str;
                 break;
             }
-            case DATABASE_INDEX_PROPERTY_FILETYPE:
+            case DATABASE_INDEX_PROPERTY_FILETYPE: {
+                const GQuark content_type = fsearch_database_entry_info_get_content_type(info);
                 text_autofree = fsearch_file_utils_get_file_type(
                     fsearch_database_entry_info_get_name(info)->str,
+                    content_type ? g_quark_to_string(content_type) : NULL,
                     fsearch_database_entry_info_get_entry_type(info) == DATABASE_ENTRY_TYPE_FOLDER ? TRUE : FALSE);
                 text = text_autofree;
                 break;
+            }
             case DATABASE_INDEX_PROPERTY_MODIFICATION_TIME: {
                 const time_t mtime = fsearch_database_entry_info_get_mtime(info);
                 strftime(text_time,
@@ -21,8 +21,15 @@
 #include "fsearch_string_utils.h"
 #include <ctype.h>
 #include <glib.h>
+#include <stdint.h>
 #include <string.h>
 
+#if defined(__GNUC__) && defined(__x86_64__)
+// SSE2 is part of the x86_64 baseline, AVX2 gets picked at runtime if the CPU supports it
+#define FSEARCH_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
 bool
 fsearch_string_is_empty(const char *str) {
     // query is considered empty if:
@@ -149,6 +156,236 @@ fsearch_string_convert_wildcard_to_regex_expression(const char *str) {
     return g_string_free(regex_epxression, FALSE);
 }
 
+// Returns a pointer to the first character after the character class starting at `p`, or NULL if it isn't closed
+static const char *
+regex_skip_class(const char *p) {
+    p++;
+    if (*p == '^') {
+        p++;
+    }
+    if (*p == ']') {
+        // A closing bracket right at the start is part of the class
+        p++;
+    }
+    while (*p != '\0') {
+        if (*p == '\\') {
+            if (p[1] == '\0') {
+                return NULL;
+            }
+            p += 2;
+            continue;
+        }
+        if (*p == '[' && p[1] == ':') {
+            const char *end = strstr(p + 2, ":]");
+            if (end) {
+                p = end + 2;
+                continue;
+            }
+        }
+        if (*p == ']') {
+            return p + 1;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+// Returns a pointer to the first character after the group starting at `p`, or NULL if it isn't closed
+static const char *
+regex_skip_group(const char *p) {
+    uint32_t depth = 0;
+    while (*p != '\0') {
+        if (*p == '\\') {
+            if (p[1] == '\0') {
+                return NULL;
+            }
+            p += 2;
+            continue;
+        }
+        if (*p == '[') {
+            p = regex_skip_class(p);
+            if (!p) {
+                return NULL;
+            }
+            continue;
+        }
+        if (*p == '(') {
+            depth++;
+        }
+        else if (*p == ')' && --depth == 0) {
+            return p + 1;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+// Returns a pointer to the first character after the quantifier at `p` (including a lazy or possessive modifier),
+// or `p` if there's none. `optional` is set if the quantifier allows zero repetitions.
+static const char *
+regex_skip_quantifier(const char *p, bool *optional) {
+    *optional = false;
+    const char *end = p;
+    if (*p == '*' || *p == '?') {
+        *optional = true;
+        end = p + 1;
+    }
+    else if (*p == '+') {
+        end = p + 1;
+    }
+    else if (*p == '{') {
+        // {n}, {n,}, {n,m} or {,m}, everything else is matched literally
+        const char *s = p + 1;
+        const char *min_start = s;
+        while (g_ascii_isdigit(*s)) {
+            s++;
+        }
+        bool has_digits = s != min_start;
+        bool min_is_zero = !has_digits || strspn(min_start, "0") == (size_t)(s - min_start);
+        if (*s == ',') {
+            s++;
+            while (g_ascii_isdigit(*s)) {
+                has_digits = true;
+                s++;
+            }
+        }
+        if (*s != '}' || !has_digits) {
+            return p;
+        }
+        *optional = min_is_zero;
+        end = s + 1;
+    }
+    else {
+        return p;
+    }
+    if (*end == '?' || *end == '+') {
+        end++;
+    }
+    return end;
+}
+
+static void
+regex_literals_finish_run(GString *run, bool *run_is_prefix, char **prefix, GString *longest) {
+    if (*run_is_prefix) {
+        // The prefix gets checked on its own
+        if (run->len > 0) {
+            *prefix = g_strdup(run->str);
+        }
+        *run_is_prefix = false;
+    }
+    else if (run->len > longest->len) {
+        g_string_assign(longest, run->str);
+    }
+    g_string_truncate(run, 0);
+}
+
+void
+fsearch_string_get_regex_literals(const char *pattern, char **prefix_out, char **suffix_out, char **literal_out) {
+    g_assert(pattern);
+    g_assert(prefix_out);
+    g_assert(suffix_out);
+    g_assert(literal_out);
+
+    *prefix_out = NULL;
+    *suffix_out = NULL;
+    *literal_out = NULL;
+
+    if (strstr(pattern, "(?") || strstr(pattern, "(*") || strstr(pattern, "\\Q")) {
+        // Option settings, verbs and quoting can change the meaning of everything that follows
+        return;
+    }
+
+    g_autoptr(GString) run = g_string_sized_new(32);
+    g_autoptr(GString) longest = g_string_sized_new(32);
+    g_autofree char *prefix = NULL;
+    g_autofree char *suffix = NULL;
+
+    const char *p = pattern;
+    bool run_is_prefix = false;
+    if (*p == '^') {
+        run_is_prefix = true;
+        p++;
+    }
+
+    while (*p != '\0') {
+        bool is_literal = false;
+        char c = '\0';
+        if (*p == '\\') {
+            const char escaped = p[1];
+            if (g_ascii_isalnum(escaped)) {
+                if (!strchr("dDwWsShHvVRNbBAzZG", escaped) || (escaped == 'N' && p[2] == '{')) {
+                    // Code points, properties, back references, ...
+                    return;
+                }
+            }
+            else if (escaped == '\0' || !g_ascii_isprint(escaped)) {
+                return;
+            }
+            else {
+                is_literal = true;
+                c = escaped;
+            }
+            p += 2;
+        }
+        else if (*p == '[') {
+            p = regex_skip_class(p);
+            if (!p) {
+                return;
+            }
+        }
+        else if (*p == '(') {
+            p = regex_skip_group(p);
+            if (!p) {
+                return;
+            }
+        }
+        else if (*p == '|' || *p == ')' || *p == '*' || *p == '+' || *p == '?') {
+            // Alternatives at the top level don't require anything
+            return;
+        }
+        else if (*p == '$' && p[1] == '\0') {
+            if (run->len > 0) {
+                suffix = g_strdup(run->str);
+                if (!run_is_prefix) {
+                    // The suffix gets checked on its own
+                    g_string_truncate(run, 0);
+                }
+            }
+            p++;
+            break;
+        }
+        else if ((guchar)*p >= 0x80) {
+            p = g_utf8_next_char(p);
+        }
+        else if (*p == '.' || *p == '^' || *p == '$' || *p == '{') {
+            p++;
+        }
+        else {
+            is_literal = true;
+            c = *p;
+            p++;
+        }
+
+        bool optional = false;
+        const char *quantifier = p;
+        p = regex_skip_quantifier(quantifier, &optional);
+        if (is_literal && !optional) {
+            g_string_append_c(run, c);
+        }
+        if (!is_literal || p != quantifier) {
+            regex_literals_finish_run(run, &run_is_prefix, &prefix, longest);
+        }
+    }
+    regex_literals_finish_run(run, &run_is_prefix, &prefix, longest);
+
+    // A single character doesn't reject enough to pay for the extra scan
+    if (longest->len > 1) {
+        *literal_out = g_strdup(longest->str);
+    }
+    *prefix_out = g_steal_pointer(&prefix);
+    *suffix_out = g_steal_pointer(&suffix);
+}
+
 bool
 fsearch_string_starts_with_interval(char *str, char **end_ptr) {
     g_assert(str);
@@ -163,4 +400,149 @@ fsearch_string_starts_with_interval(char *str, char **end_ptr) {
     }
     *end_ptr = str;
     return false;
-}
\ No newline at end of file
+}
+
+typedef const char *(*AsciiCaseStrFunc)(const char *haystack,
+                                        size_t haystack_len,
+                                        const char *needle,
+                                        size_t needle_len);
+
+static inline bool
+ascii_equal_icase(const char *a, const char *b, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (g_ascii_tolower(a[i]) != g_ascii_tolower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const char *
+ascii_casestr_scalar(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len) {
+    const char first = g_ascii_tolower(needle[0]);
+    for (size_t i = 0; i + needle_len <= haystack_len; i++) {
+        if (g_ascii_tolower(haystack[i]) == first && ascii_equal_icase(haystack + i + 1, needle + 1, needle_len - 1)) {
+            return haystack + i;
+        }
+    }
+    return NULL;
+}
+
+#ifdef FSEARCH_HAVE_X86_SIMD
+// The vector kernels look for positions where both the first and the last byte of the needle match and only
+// compare the remaining bytes there. Haystack bytes are OR'ed with 0x20 when the needle byte is a letter, which
+// maps exactly the upper case form of that letter onto its lower case form.
+static inline uint8_t
+ascii_case_mask(char c) {
+    return g_ascii_isalpha(c) ? 0x20 : 0x00;
+}
+
+// Checks all positions from *pos on which can be covered by full 16 byte blocks, *pos points to the first unchecked
+// position afterwards. It's always inlined, so the AVX2 kernel gets a VEX encoded copy and doesn't pay for switching
+// between AVX and legacy SSE instructions.
+static inline __attribute__((always_inline)) const char *
+ascii_casestr_sse2_blocks(const char *haystack,
+                          size_t haystack_len,
+                          const char *needle,
+                          size_t needle_len,
+                          size_t *pos) {
+    const size_t last_offset = needle_len - 1;
+    const char first = g_ascii_tolower(needle[0]);
+    const char last = g_ascii_tolower(needle[last_offset]);
+    const __m128i first_v = _mm_set1_epi8(first);
+    const __m128i last_v = _mm_set1_epi8(last);
+    const __m128i first_mask = _mm_set1_epi8((char)ascii_case_mask(first));
+    const __m128i last_mask = _mm_set1_epi8((char)ascii_case_mask(last));
+
+    const size_t num_positions = haystack_len - needle_len + 1;
+    size_t i = *pos;
+    for (; i + 16 <= num_positions; i += 16) {
+        const __m128i block_first = _mm_or_si128(_mm_loadu_si128((const __m128i *)(haystack + i)), first_mask);
+        const __m128i block_last =
+            _mm_or_si128(_mm_loadu_si128((const __m128i *)(haystack + i + last_offset)), last_mask);
+        uint32_t candidates = (uint32_t)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first_v), _mm_cmpeq_epi8(block_last, last_v)));
+        while (candidates) {
+            const size_t candidate = i + (size_t)__builtin_ctz(candidates);
+            if (ascii_equal_icase(haystack + candidate + 1, needle + 1, needle_len - 1)) {
+                return haystack + candidate;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    *pos = i;
+    return NULL;
+}
+
+static const char *
+ascii_casestr_sse2(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len) {
+    size_t i = 0;
+    const char *res = ascii_casestr_sse2_blocks(haystack, haystack_len, needle, needle_len, &i);
+    if (res) {
+        return res;
+    }
+    return ascii_casestr_scalar(haystack + i, haystack_len - i, needle, needle_len);
+}
+
+__attribute__((target("avx2"))) static const char *
+ascii_casestr_avx2(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len) {
+    const size_t last_offset = needle_len - 1;
+    const char first = g_ascii_tolower(needle[0]);
+    const char last = g_ascii_tolower(needle[last_offset]);
+    const __m256i first_v = _mm256_set1_epi8(first);
+    const __m256i last_v = _mm256_set1_epi8(last);
+    const __m256i first_mask = _mm256_set1_epi8((char)ascii_case_mask(first));
+    const __m256i last_mask = _mm256_set1_epi8((char)ascii_case_mask(last));
+
+    const size_t num_positions = haystack_len - needle_len + 1;
+    size_t i = 0;
+    for (; i + 32 <= num_positions; i += 32) {
+        const __m256i block_first = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(haystack + i)), first_mask);
+        const __m256i block_last =
+            _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(haystack + i + last_offset)), last_mask);
+        uint32_t candidates = (uint32_t)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first_v), _mm256_cmpeq_epi8(block_last, last_v)));
+        while (candidates) {
+            const size_t candidate = i + (size_t)__builtin_ctz(candidates);
+            if (ascii_equal_icase(haystack + candidate + 1, needle + 1, needle_len - 1)) {
+                return haystack + candidate;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    // Less than 32 positions left, which might still fill a 16 byte block
+    const char *res = ascii_casestr_sse2_blocks(haystack, haystack_len, needle, needle_len, &i);
+    if (res) {
+        return res;
+    }
+    return ascii_casestr_scalar(haystack + i, haystack_len - i, needle, needle_len);
+}
+#endif
+
+static AsciiCaseStrFunc
+ascii_casestr_get_impl(void) {
+    static gsize impl = 0;
+    if (g_once_init_enter(&impl)) {
+        AsciiCaseStrFunc func = ascii_casestr_scalar;
+#ifdef FSEARCH_HAVE_X86_SIMD
+        __builtin_cpu_init();
+        func = __builtin_cpu_supports("avx2") ? ascii_casestr_avx2 : ascii_casestr_sse2;
+#endif
+        g_once_init_leave(&impl, (gsize)func);
+    }
+    return (AsciiCaseStrFunc)impl;
+}
+
+const char *
+fsearch_string_ascii_casestr(const char *haystack, const char *needle, size_t needle_len) {
+    g_assert(haystack);
+    g_assert(needle);
+    if (needle_len == 0) {
+        return haystack;
+    }
+    const size_t haystack_len = strlen(haystack);
+    if (haystack_len < needle_len) {
+        return NULL;
+    }
+    return ascii_casestr_get_impl()(haystack, haystack_len, needle, needle_len);
+}
@@ -18,6 +18,7 @@
 
 #pragma once
 #include <stdbool.h>
+#include <stddef.h>
 #include <unistd.h>
 
 bool
@@ -39,6 +40,12 @@ fsearch_string_is_ascii_icase(const char *str);
 bool
 fsearch_string_has_wildcards(const char *str);
 
+// Case insensitive substring search like strcasestr, but only folds ASCII letters. This makes it a good fit for
+// needles which are ASCII in both their lower and upper case form (see fsearch_string_is_ascii_icase), and allows
+// it to use SIMD instructions when the CPU supports them.
+const char *
+fsearch_string_ascii_casestr(const char *haystack, const char *needle, size_t needle_len);
+
 // Converts a wildcard expression to a regular expression, i.e.
 // `*` becomes `.*`
 // `?` becomes `.`
@@ -46,6 +53,12 @@ fsearch_string_has_wildcards(const char *str);
 char *
 fsearch_string_convert_wildcard_to_regex_expression(const char *str);
 
+// Extracts literal strings every match of the regular expression `pattern` must contain: a prefix (if the pattern is
+// anchored at the start), a suffix (if it's anchored at the end) and the longest other ASCII literal.
+// Strings which can't be determined are set to NULL, which is always a safe result.
+void
+fsearch_string_get_regex_literals(const char *pattern, char **prefix_out, char **suffix_out, char **literal_out);
+
 // Detect if str starts with a interval identifier (i.e. `..` or `-`).
 // At success end_ptr will point to the first character after the interval.
 // If no interval was detected end_ptr will point to str.
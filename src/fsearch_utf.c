@@ -46,7 +46,6 @@ fsearch_utf_builder_clear(FsearchUtfBuilder *builder) {
     }
     builder->initialized = false;
     g_clear_pointer(&builder->case_map, ucasemap_close);
-    g_clear_pointer(&builder->string, free);
     g_clear_pointer(&builder->string_utf8_folded, free);
     g_clear_pointer(&builder->string_folded, free);
     g_clear_pointer(&builder->string_normalized_folded, free);
@@ -82,7 +81,6 @@ fsearch_utf_builder_normalize_and_fold_case(FsearchUtfBuilder *builder,
 
     UErrorCode status = U_ZERO_ERROR;
 
-    builder->string = g_strdup(string);
     // first perform case folding (this can be done while our string is still in UTF8 form)
     builder->string_utf8_folded_len =
         ucasemap_utf8FoldCase(builder->case_map,
@@ -150,4 +148,33 @@ fail:
     builder->string_is_folded_and_normalized = false;
     builder->string_utf8_is_folded = false;
     return false;
-}
\ No newline at end of file
+}
+
+bool
+fsearch_utf_builder_fold_case_ascii(FsearchUtfBuilder *builder, const char *string) {
+    g_assert(builder);
+    // With the Turkic mappings even ASCII 'I' folds to a non-ASCII character
+    if (!builder->initialized || builder->fold_options != U_FOLD_CASE_DEFAULT) {
+        return fsearch_utf_builder_normalize_and_fold_case(builder, string);
+    }
+
+    int32_t len = 0;
+    for (; string[len] != '\0'; len++) {
+        if (G_UNLIKELY(len >= builder->num_characters - 1)) {
+            return fsearch_utf_builder_normalize_and_fold_case(builder, string);
+        }
+        // Folded ASCII is also NFD normalized already, so all representations are simple copies
+        const char c = g_ascii_tolower(string[len]);
+        builder->string_utf8_folded[len] = c;
+        builder->string_folded[len] = (UChar)c;
+        builder->string_normalized_folded[len] = (UChar)c;
+    }
+    builder->string_utf8_folded[len] = '\0';
+
+    builder->string_utf8_folded_len = len;
+    builder->string_folded_len = len;
+    builder->string_normalized_folded_len = len;
+    builder->string_utf8_is_folded = true;
+    builder->string_is_folded_and_normalized = true;
+    return true;
+}
@@ -9,7 +9,6 @@ typedef struct FsearchUtfBuilder {
     UCaseMap *case_map;
     const UNormalizer2 *normalizer;
 
-    char *string;
     char *string_utf8_folded;
     UChar *string_folded;
     UChar *string_normalized_folded;
@@ -37,4 +36,9 @@ fsearch_utf_fold_case_utf8(UCaseMap *case_map, FsearchUtfBuilder *builder, const
 
 bool
 fsearch_utf_builder_normalize_and_fold_case(FsearchUtfBuilder *builder,
-                                            const char *string);
\ No newline at end of file
+                                            const char *string);
+
+// Same as fsearch_utf_builder_normalize_and_fold_case, but `string` must be pure ASCII,
+// which allows folding it with a simple copy instead of going through ICU
+bool
+fsearch_utf_builder_fold_case_ascii(FsearchUtfBuilder *builder, const char *string);
@@ -66,6 +66,8 @@ struct _FsearchApplicationWindow {
     FsearchDatabase *db;
     FsearchDatabaseWork *work_search;
     FsearchDatabaseWork *work_sort;
+    // Whether partial results of `work_search` are already shown
+    bool work_search_has_progress;
 
     guint apply_overlay_timeout_id;
     int32_t apply_depth;
@@ -549,11 +551,25 @@ on_search_finished(FsearchDatabase *db, guint id, FsearchDatabaseSearchInfo *inf
         if (!search_info_matches_tracked_work(win, info)) {
             return;
         }
-        apply_search_info(win, info, true);
+        // Keep the scroll position and cursor if the user already got to see the partial results
+        apply_search_info(win, info, !win->work_search_has_progress);
         g_clear_pointer(&win->work_search, fsearch_database_work_unref);
     }
 }
 
+static void
+on_search_progress(FsearchDatabase *db, guint id, FsearchDatabaseSearchInfo *info, gpointer self) {
+    FsearchApplicationWindow *win = get_window_for_id(id);
+
+    if (win) {
+        if (!search_info_matches_tracked_work(win, info)) {
+            return;
+        }
+        apply_search_info(win, info, !win->work_search_has_progress);
+        win->work_search_has_progress = true;
+    }
+}
+
 static void
 on_search_started(FsearchDatabase *db, gpointer data, gpointer user_data) {
     const guint win_id = GPOINTER_TO_UINT(data);
@@ -580,10 +596,12 @@ perform_search(FsearchApplicationWindow *win) {
         fsearch_database_work_cancel(win->work_search);
     }
     g_clear_pointer(&win->work_search, fsearch_database_work_unref);
+    win->work_search_has_progress = false;
     win->work_search = fsearch_database_work_new_search(win_id,
                                                         query,
                                                         fsearch_list_view_get_sort_order(win->result_view->list_view),
-                                                        fsearch_list_view_get_sort_type(win->result_view->list_view));
+                                                        fsearch_list_view_get_sort_type(win->result_view->list_view),
+                                                        0);
     g_clear_pointer(&filter, fsearch_filter_unref);
     fsearch_database_queue_work(win->db, win->work_search);
 }
@@ -997,6 +1015,7 @@ fsearch_application_window_init(FsearchApplicationWindow *self) {
     self->db = fsearch_application_get_db(app);
     g_signal_connect_object(self->db, "search-started", G_CALLBACK(on_search_started), self, G_CONNECT_AFTER);
     g_signal_connect_object(self->db, "search-finished", G_CALLBACK(on_search_finished), self, G_CONNECT_AFTER);
+    g_signal_connect_object(self->db, "search-progress", G_CALLBACK(on_search_progress), self, G_CONNECT_AFTER);
     g_signal_connect_object(self->db, "sort-started", G_CALLBACK(on_sort_started), self, G_CONNECT_AFTER);
     g_signal_connect_object(self->db, "sort-finished", G_CALLBACK(on_sort_finished), self, G_CONNECT_AFTER);
     g_signal_connect_object(self->db, "scan-started", G_CALLBACK(on_database_scan_started), self, G_CONNECT_AFTER);
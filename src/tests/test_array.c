@@ -183,6 +183,82 @@ test_sort(void) {
     test_single_and_multi_threaded_sort(array, (DynamicArrayCompareDataFunc)sort_version);
 }
 
+static DynamicArray *
+make_versions(Version *versions, uint32_t num_versions, uint32_t num_majors) {
+    DynamicArray *array = darray_new(num_versions);
+    for (uint32_t i = 0; i < num_versions; i++) {
+        // Many versions share a major number, so the order of equal items gets checked too
+        versions[i].major = g_random_int_range(0, (int32_t)num_majors);
+        versions[i].minor = 0;
+        darray_add_item(array, &versions[i]);
+    }
+    return array;
+}
+
+static int32_t
+sort_version_major(void **a, void **b, void *data) {
+    Version *v1 = *a;
+    Version *v2 = *b;
+    return v1->major - v2->major;
+}
+
+static void
+test_sort_large(void) {
+    const uint32_t num_versions = 200000;
+    g_autofree Version *versions = g_new(Version, num_versions);
+    g_autoptr(DynamicArray) array = make_versions(versions, num_versions, 1000);
+
+    g_autoptr(DynamicArray) expected = darray_copy(array);
+    darray_sort(expected, (DynamicArrayCompareDataFunc)sort_version_major, NULL, NULL);
+
+    const uint32_t thread_counts[] = {1, 2, 3, 5, 8, 64};
+    for (uint32_t i = 0; i < G_N_ELEMENTS(thread_counts); i++) {
+        g_autoptr(DynamicArray) sorted = darray_copy(array);
+        darray_sort_multi_threaded_with_num_threads(sorted,
+                                                    (DynamicArrayCompareDataFunc)sort_version_major,
+                                                    NULL,
+                                                    NULL,
+                                                    thread_counts[i]);
+        g_assert_cmpuint(darray_get_num_items(sorted), ==, num_versions);
+        for (uint32_t j = 0; j < num_versions; j++) {
+            // Both sorts are stable, so even equal items have to end up at the same position
+            g_assert_true(darray_get_item(sorted, j) == darray_get_item(expected, j));
+        }
+    }
+}
+
+static void
+test_perf_sort_scaling(void) {
+    const uint32_t num_versions = 4000000;
+    g_autofree Version *versions = g_new(Version, num_versions);
+    g_autoptr(DynamicArray) array = make_versions(versions, num_versions, num_versions);
+
+    const uint32_t num_processors = g_get_num_processors();
+    double single_threaded_time = 0;
+    for (uint32_t num_threads = 1;; num_threads = MIN(num_threads * 2, num_processors)) {
+        g_autoptr(DynamicArray) sorted = darray_copy(array);
+        g_test_timer_start();
+        darray_sort_multi_threaded_with_num_threads(sorted,
+                                                    (DynamicArrayCompareDataFunc)sort_version_major,
+                                                    NULL,
+                                                    NULL,
+                                                    num_threads);
+        const double sort_time = g_test_timer_elapsed();
+        if (num_threads == 1) {
+            single_threaded_time = sort_time;
+        }
+        g_test_message("%u items, %u threads: %.3f ms, speedup %.2f",
+                       num_versions,
+                       num_threads,
+                       sort_time * 1000.0,
+                       single_threaded_time / sort_time);
+        if (num_threads == num_processors) {
+            g_test_minimized_result(sort_time, "sort with %u threads: %.3f ms", num_threads, sort_time * 1000.0);
+            break;
+        }
+    }
+}
+
 static void
 test_search(void) {
     same_elements();
@@ -349,6 +425,26 @@ test_range(void) {
     g_assert_cmpint(GPOINTER_TO_INT(darray_get_item(range, n_range - 1)), ==, i_range + n_range - 1);
 }
 
+static void
+test_add_array_range(void) {
+    const uint32_t count = 10;
+    g_autoptr(DynamicArray) array = darray_new(count);
+    for (int i = 0; i < count; i++) {
+        darray_add_item(array, GINT_TO_POINTER(i));
+    }
+
+    g_autoptr(DynamicArray) dest = darray_new(1);
+    darray_add_array_range(dest, array, 6, 4);
+    darray_add_array_range(dest, array, 0, 0);
+    darray_add_array_range(dest, array, 2, 3);
+    g_assert_cmpuint(darray_get_num_items(dest), ==, 7);
+
+    const int expected[] = {6, 7, 8, 9, 2, 3, 4};
+    for (uint32_t i = 0; i < G_N_ELEMENTS(expected); i++) {
+        g_assert_cmpint(GPOINTER_TO_INT(darray_get_item(dest, i)), ==, expected[i]);
+    }
+}
+
 static void
 test_copy_ref(void) {
     const int32_t val = 100;
@@ -380,8 +476,14 @@ main(int argc, char *argv[]) {
     g_test_add_func("/FSearch/array/steal", test_steal);
     g_test_add_func("/FSearch/array/steal_items_func", test_steal_items_func);
     g_test_add_func("/FSearch/array/range", test_range);
+    g_test_add_func("/FSearch/array/add_array_range", test_add_array_range);
     g_test_add_func("/FSearch/array/copy_ref", test_copy_ref);
     g_test_add_func("/FSearch/array/sort", test_sort);
     g_test_add_func("/FSearch/array/search", test_search);
+    g_test_add_func("/FSearch/array/sort_large", test_sort_large);
+
+    if (g_test_perf()) {
+        g_test_add_func("/FSearch/array/perf/sort_scaling", test_perf_sort_scaling);
+    }
     return g_test_run();
 }
\ No newline at end of file
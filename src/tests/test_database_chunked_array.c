@@ -614,6 +614,34 @@ test_find_slow_existing_and_missing(void) {
     db_entry_free(miss_query);
 }
 
+static void
+test_get_ranks_of_entries(void) {
+    g_autoptr(DynamicArray) input = make_sorted_files("f", 5000);
+    g_autoptr(FsearchDatabaseChunkedArray) arr = make_chunked_array(input,
+                                                                    TRUE,
+                                                                    DATABASE_INDEX_PROPERTY_NAME,
+                                                                    DATABASE_ENTRY_TYPE_FILE,
+                                                                    (GDestroyNotify)db_entry_free_no_unparent);
+    // Spread over several chunks and in no particular order
+    const uint32_t expected_ranks[] = {4999, 0, 2047, 2048, 3333, 17};
+    g_autoptr(DynamicArray) entries = darray_new(G_N_ELEMENTS(expected_ranks));
+    for (uint32_t i = 0; i < G_N_ELEMENTS(expected_ranks); i++) {
+        darray_add_item(entries, darray_get_item(input, expected_ranks[i]));
+    }
+    uint32_t ranks[G_N_ELEMENTS(expected_ranks)] = {0};
+    g_assert_true(fsearch_database_chunked_array_get_ranks(arr, entries, ranks));
+    for (uint32_t i = 0; i < G_N_ELEMENTS(expected_ranks); i++) {
+        g_assert_cmpuint(ranks[i], ==, expected_ranks[i]);
+    }
+
+    // An entry with the same name which isn't part of the array has no rank
+    FsearchDatabaseEntry *copy = make_file("f_000017");
+    darray_add_item(entries, copy);
+    uint32_t more_ranks[G_N_ELEMENTS(expected_ranks) + 1] = {0};
+    g_assert_false(fsearch_database_chunked_array_get_ranks(arr, entries, more_ranks));
+    db_entry_free(copy);
+}
+
 static void
 test_find_duplicate_keys_returns_a_matching_entry(void) {
     // Parentless entries with an identical name are genuinely tied under NAME sort order
@@ -1380,6 +1408,7 @@ main(int argc, char **argv) {
     g_test_add_func("/FSearch/database/chunked_array/find_empty_array_null", test_find_empty_array_returns_null);
     g_test_add_func("/FSearch/database/chunked_array/find_slow_existing_and_missing",
                     test_find_slow_existing_and_missing);
+    g_test_add_func("/FSearch/database/chunked_array/get_ranks", test_get_ranks_of_entries);
     g_test_add_func("/FSearch/database/chunked_array/find_duplicate_keys",
                     test_find_duplicate_keys_returns_a_matching_entry);
     g_test_add_func("/FSearch/database/chunked_array/find_duplicates_across_chunk_boundary",
@@ -2,7 +2,7 @@
  * Extensive test suite for FsearchDatabaseEntry.
  *
  * Covers the public API declared in fsearch_database_entry.h:
- *   - db_entry_new / db_entry_new_with_attributes
+ *   - db_entry_new / db_entry_new_with_attributes (and their _in_arena variants)
  *   - db_entry_is_folder / db_entry_is_file / db_entry_get_type
  *   - db_entry_is_sibling / db_entry_is_descendant
  *   - db_entry_folder_get_num_children / _num_files / _num_folders
@@ -23,10 +23,11 @@
  * db_entry_set_attribute_for_offset
  *   - db_entry_get_attribute_offset / db_entry_get_attribute_offsets
  *   - db_entry_get_deep_copy
- *   - db_entry_free / db_entry_free_no_unparent / db_entry_free_full
+ *   - db_entry_free / db_entry_free_no_unparent / db_entry_free_full / db_entry_free_outside_arena
  *   - db_entry_compare_context_new / db_entry_compare_context_free
  *   - db_entry_compare_entries_by_{name,size,extension,type,modification_time,position,path,full_path,chain}
  *   - db_entry_{set,is}_monitored_{fanotify,inotify} / db_entry_set_monitored_failed / db_entry_is_monitored_failed
+ *   - FsearchDatabaseEntryIdTable, which hands out 32-bit IDs to entries
  *
  * Not exercised: db_entry_get_idx, db_entry_get_member_flags and
  * db_entry_get_dummy_for_name_and_parent are declared in the header but have
@@ -35,6 +36,7 @@
 
 #include "fsearch_database_entry.h"
 #include "fsearch_database_entry_flags.h"
+#include "fsearch_database_entry_id_table.h"
 #include "fsearch_database_index_properties.h"
 
 #include <glib.h>
@@ -241,18 +243,19 @@ test_get_attribute_offset_none_property_fails(void) {
 
 static void
 test_get_attribute_offsets_computed_properties_are_absent(void) {
-    // PATH, PATH_FULL, FILETYPE and EXTENSION are computed on demand and never
-    // stored inline, so they must always report an invalid (-1) offset, even
-    // with every flag set.
+    // PATH, PATH_FULL and EXTENSION are computed on demand and never stored
+    // inline, so they must always report an invalid (-1) offset, even with
+    // every flag set. FILETYPE holds the indexed content type after the child
+    // counts.
     g_autofree size_t *offsets = db_entry_get_attribute_offsets(DATABASE_INDEX_PROPERTY_FLAG_ALL);
     const size_t invalid = (size_t)-1;
     g_assert_cmpuint(offsets[DATABASE_INDEX_PROPERTY_NONE], ==, invalid);
     g_assert_cmpuint(offsets[DATABASE_INDEX_PROPERTY_PATH], ==, invalid);
     g_assert_cmpuint(offsets[DATABASE_INDEX_PROPERTY_PATH_FULL], ==, invalid);
     g_assert_cmpuint(offsets[DATABASE_INDEX_PROPERTY_CREATION_TIME], ==, invalid);
-    g_assert_cmpuint(offsets[DATABASE_INDEX_PROPERTY_FILETYPE], ==, invalid);
     g_assert_cmpuint(offsets[DATABASE_INDEX_PROPERTY_EXTENSION], ==, invalid);
-    g_assert_cmpuint(offsets[DATABASE_INDEX_PROPERTY_NAME], ==, 40);
+    g_assert_cmpuint(offsets[DATABASE_INDEX_PROPERTY_FILETYPE], ==, 40);
+    g_assert_cmpuint(offsets[DATABASE_INDEX_PROPERTY_NAME], ==, 44);
 }
 
 static void
@@ -423,6 +426,33 @@ test_depth_increases_with_nesting(void) {
     db_entry_free(root);
 }
 
+static void
+test_depth_follows_parent_changes(void) {
+    FsearchDatabaseEntry *root = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "root", NULL);
+    FsearchDatabaseEntry *mid = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "mid", root);
+    FsearchDatabaseEntry *leaf = new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "leaf", NULL);
+
+    db_entry_set_parent(leaf, mid);
+    g_assert_cmpuint(db_entry_get_depth(leaf), ==, 2);
+    db_entry_set_parent(leaf, NULL);
+    g_assert_cmpuint(db_entry_get_depth(leaf), ==, 0);
+
+    // The raw parent update leaves the depth alone until it's recomputed
+    db_entry_set_parent_no_update(leaf, mid);
+    g_assert_cmpuint(db_entry_get_depth(leaf), ==, 0);
+    db_entry_update_depth(leaf);
+    g_assert_cmpuint(db_entry_get_depth(leaf), ==, 2);
+    db_entry_set_parent_no_update(leaf, NULL);
+
+    FsearchDatabaseEntry *dummy = db_entry_get_dummy_for_name_and_parent(mid, "", DATABASE_ENTRY_TYPE_FILE);
+    g_assert_cmpuint(db_entry_get_depth(dummy), ==, 2);
+
+    db_entry_free_no_unparent(dummy);
+    db_entry_free(leaf);
+    db_entry_free(mid);
+    db_entry_free(root);
+}
+
 static void
 test_get_parent_of_root_is_null(void) {
     FsearchDatabaseEntry *root = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "root", NULL);
@@ -851,6 +881,45 @@ test_append_content_type_of_nonexistent_path_is_unknown(void) {
     db_entry_free(root);
 }
 
+static void
+test_append_content_type_uses_indexed_content_type(void) {
+    FsearchDatabaseEntry *root = new_folder(DATABASE_INDEX_PROPERTY_FLAG_FILETYPE, "does_not_exist_root_xyz", NULL);
+    FsearchDatabaseEntry *file = new_file(DATABASE_INDEX_PROPERTY_FLAG_SIZE | DATABASE_INDEX_PROPERTY_FLAG_FILETYPE,
+                                          "does_not_exist_file_xyz.txt",
+                                          root);
+    g_assert_cmpuint(db_entry_get_content_type(file), ==, 0);
+
+    // An indexed content type is used as is, without looking at the file system
+    db_entry_set_content_type(file, g_quark_from_static_string("image/png"));
+    GString *str = g_string_new(NULL);
+    db_entry_append_content_type(file, str);
+    g_assert_cmpstr(str->str, ==, "image/png");
+
+    // Without one the file system gets asked and the result is remembered
+    db_entry_set_content_type(file, 0);
+    g_string_truncate(str, 0);
+    db_entry_append_content_type(file, str);
+    g_assert_cmpstr(str->str, ==, "unknown");
+    g_assert_cmpuint(db_entry_get_content_type(file), ==, g_quark_from_static_string("unknown"));
+    g_string_free(str, TRUE);
+
+    // Attributes before the content type are unaffected
+    db_entry_set_size(file, 42);
+    g_assert_cmpint(db_entry_get_size(file), ==, 42);
+    g_assert_cmpuint(db_entry_get_content_type(file), ==, g_quark_from_static_string("unknown"));
+
+    db_entry_free(file);
+    db_entry_free(root);
+}
+
+static void
+test_content_type_without_flag_is_not_stored(void) {
+    FsearchDatabaseEntry *file = new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "a.txt", NULL);
+    db_entry_set_content_type(file, g_quark_from_static_string("text/plain"));
+    g_assert_cmpuint(db_entry_get_content_type(file), ==, 0);
+    db_entry_free(file);
+}
+
 /* ------------------------------------------------------------------------ *
  * Comparators
  * ------------------------------------------------------------------------ */
@@ -961,10 +1030,8 @@ test_compare_by_type_folders_always_equal(void) {
     g_assert_cmpint(db_entry_compare_entries_by_type(&dir_b, &dir_a, ctx), ==, 0);
     g_assert_cmpint(db_entry_compare_entries_by_type(&dir_a, &dir_a, ctx), ==, 0);
 
-    // Both folders share the "Folder" type string, so exactly one entry is added to the
-    // dedup table, but each entry gets its own cache slot.
-    g_assert_cmpuint(g_hash_table_size(ctx->file_type_table), ==, 1);
-    g_assert_cmpuint(g_hash_table_size(ctx->entry_to_file_type_table), ==, 2);
+    // Folders always have the "Folder" type, so nothing needs to be cached for them
+    g_assert_cmpuint(g_hash_table_size(ctx->entry_to_file_type_table), ==, 0);
 
     db_entry_compare_context_free(ctx);
     db_entry_free(dir_a);
@@ -984,6 +1051,29 @@ test_compare_by_type_folder_and_file_differ(void) {
     db_entry_free(file);
 }
 
+static void
+test_compare_by_type_uses_indexed_content_type(void) {
+    FsearchDatabaseEntryCompareContext *ctx = db_entry_compare_context_new((FsearchDatabaseSortOrderChain){});
+    // The names suggest different types, but the indexed content types are the same
+    FsearchDatabaseEntry *a = new_file(DATABASE_INDEX_PROPERTY_FLAG_FILETYPE, "a.txt", NULL);
+    FsearchDatabaseEntry *b = new_file(DATABASE_INDEX_PROPERTY_FLAG_FILETYPE, "b.png", NULL);
+    db_entry_set_content_type(a, g_quark_from_static_string("text/plain"));
+    db_entry_set_content_type(b, g_quark_from_static_string("text/plain"));
+
+    g_assert_cmpint(db_entry_compare_entries_by_type(&a, &b, ctx), ==, 0);
+    // Only entries without an indexed content type need to be cached per sort
+    g_assert_cmpuint(g_hash_table_size(ctx->entry_to_file_type_table), ==, 0);
+
+    FsearchDatabaseEntry *c = new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "c.txt", NULL);
+    db_entry_compare_entries_by_type(&a, &c, ctx);
+    g_assert_cmpuint(g_hash_table_size(ctx->entry_to_file_type_table), ==, 1);
+
+    db_entry_compare_context_free(ctx);
+    db_entry_free(a);
+    db_entry_free(b);
+    db_entry_free(c);
+}
+
 static void
 test_compare_by_chain_type_then_name(void) {
     // db_entry_compare_entries_by_chain() is what actually implements "fall back to the next
@@ -1181,6 +1271,198 @@ test_path_compare_has_no_name_collisions(void) {
     db_entry_free(root);
 }
 
+static void
+test_path_rank_is_only_stored_in_folders(void) {
+    FsearchDatabaseEntry *folder = new_folder(DATABASE_INDEX_PROPERTY_FLAG_DEFAULT, "dir", NULL);
+    FsearchDatabaseEntry *file = new_file(DATABASE_INDEX_PROPERTY_FLAG_DEFAULT, "file", folder);
+
+    g_assert_cmpuint(db_entry_get_path_rank(folder), ==, 0);
+    db_entry_set_path_rank(folder, 42);
+    g_assert_cmpuint(db_entry_get_path_rank(folder), ==, 42);
+    // The rank has its own storage
+    g_assert_cmpstr(db_entry_get_name_raw(folder), ==, "dir");
+
+    db_entry_set_path_rank(file, 42);
+    g_assert_cmpuint(db_entry_get_path_rank(file), ==, 0);
+
+    db_entry_free(file);
+    db_entry_free(folder);
+}
+
+static void
+test_id_table_hands_out_and_reuses_ids(void) {
+    g_autoptr(FsearchDatabaseEntryIdTable) table = fsearch_database_entry_id_table_new();
+    DynamicArray *entries = darray_new(4);
+    for (uint32_t i = 0; i < 4; ++i) {
+        g_autofree char *name = g_strdup_printf("file_%u", i);
+        darray_add_item(entries, new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, name, NULL));
+    }
+
+    fsearch_database_entry_id_table_add(table, entries);
+    g_assert_cmpuint(fsearch_database_entry_id_table_get_num_entries(table), ==, 4);
+    for (uint32_t i = 0; i < 4; ++i) {
+        FsearchDatabaseEntry *entry = darray_get_item(entries, i);
+        const uint32_t id = fsearch_database_entry_id_table_get_id(table, entry);
+        g_assert_cmpuint(id, !=, 0);
+        g_assert_true(fsearch_database_entry_id_table_get_entry(table, id) == entry);
+    }
+    g_assert_null(fsearch_database_entry_id_table_get_entry(table, 0));
+
+    // Entries which are already part of the table keep their ID
+    const uint32_t first_id = fsearch_database_entry_id_table_get_id(table, darray_get_item(entries, 0));
+    fsearch_database_entry_id_table_add(table, entries);
+    g_assert_cmpuint(fsearch_database_entry_id_table_get_num_entries(table), ==, 4);
+    g_assert_cmpuint(fsearch_database_entry_id_table_get_id(table, darray_get_item(entries, 0)), ==, first_id);
+
+    g_autoptr(GArray) ids = fsearch_database_entry_id_table_get_sorted_ids(table, entries);
+    g_assert_cmpuint(ids->len, ==, 4);
+    for (uint32_t i = 1; i < ids->len; ++i) {
+        g_assert_cmpuint(g_array_index(ids, uint32_t, i - 1), <, g_array_index(ids, uint32_t, i));
+    }
+
+    // The ID of a removed entry is handed out again
+    g_autoptr(DynamicArray) removed = darray_new(1);
+    darray_add_item(removed, darray_get_item(entries, 2));
+    const uint32_t removed_id = fsearch_database_entry_id_table_get_id(table, darray_get_item(entries, 2));
+    fsearch_database_entry_id_table_remove(table, removed);
+    g_assert_cmpuint(fsearch_database_entry_id_table_get_id(table, darray_get_item(entries, 2)), ==, 0);
+    g_assert_null(fsearch_database_entry_id_table_get_entry(table, removed_id));
+    g_assert_cmpuint(fsearch_database_entry_id_table_get_num_entries(table), ==, 3);
+
+    // Entries which aren't part of the table don't show up in the sorted IDs
+    g_autoptr(GArray) remaining_ids = fsearch_database_entry_id_table_get_sorted_ids(table, entries);
+    g_assert_cmpuint(remaining_ids->len, ==, 3);
+
+    FsearchDatabaseEntry *new_entry = new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "new", NULL);
+    g_autoptr(DynamicArray) added = darray_new(1);
+    darray_add_item(added, new_entry);
+    fsearch_database_entry_id_table_add(table, added);
+    g_assert_cmpuint(fsearch_database_entry_id_table_get_id(table, new_entry), ==, removed_id);
+    g_assert_true(fsearch_database_entry_id_table_get_entry(table, removed_id) == new_entry);
+
+    db_entry_free(new_entry);
+    for (uint32_t i = 0; i < 4; ++i) {
+        db_entry_free(darray_get_item(entries, i));
+    }
+    darray_unref(entries);
+}
+
+// The table finds the IDs of entries by their address. That lookup has to survive growing the table and removing
+// entries from the middle of it.
+static void
+test_id_table_looks_up_ids_after_removals(void) {
+    g_autoptr(FsearchDatabaseEntryIdTable) table = fsearch_database_entry_id_table_new();
+    const uint32_t num_entries = 10000;
+    DynamicArray *entries = darray_new(num_entries);
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        g_autofree char *name = g_strdup_printf("file_%u", i);
+        darray_add_item(entries, new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, name, NULL));
+    }
+    fsearch_database_entry_id_table_add(table, entries);
+
+    g_autoptr(DynamicArray) removed = darray_new(num_entries / 3);
+    for (uint32_t i = 0; i < num_entries; i += 3) {
+        darray_add_item(removed, darray_get_item(entries, i));
+    }
+    fsearch_database_entry_id_table_remove(table, removed);
+    g_assert_cmpuint(fsearch_database_entry_id_table_get_num_entries(table),
+                     ==,
+                     num_entries - darray_get_num_items(removed));
+
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        FsearchDatabaseEntry *entry = darray_get_item(entries, i);
+        const uint32_t id = fsearch_database_entry_id_table_get_id(table, entry);
+        if (i % 3 == 0) {
+            g_assert_cmpuint(id, ==, 0);
+        }
+        else {
+            g_assert_cmpuint(id, !=, 0);
+            g_assert_true(fsearch_database_entry_id_table_get_entry(table, id) == entry);
+        }
+    }
+
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        db_entry_free(darray_get_item(entries, i));
+    }
+    darray_unref(entries);
+}
+
+static int
+sign(int value) {
+    return (value > 0) - (value < 0);
+}
+
+static void
+assert_path_order_equal(FsearchDatabaseEntry **entries, uint32_t num_entries, const int *expected) {
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        for (uint32_t j = 0; j < num_entries; ++j) {
+            const int *e = expected + 2 * (i * num_entries + j);
+            g_assert_cmpint(sign(db_entry_compare_entries_by_full_path(&entries[i], &entries[j])), ==, e[0]);
+            g_assert_cmpint(sign(db_entry_compare_entries_by_path(&entries[i], &entries[j])), ==, e[1]);
+        }
+    }
+}
+
+// Ranked folders must compare exactly like unranked ones, also when only some of them are ranked
+static void
+test_path_rank_keeps_path_order(void) {
+    FsearchDatabaseEntry *root = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "a", NULL);
+    FsearchDatabaseEntry *b = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "b", root);
+    FsearchDatabaseEntry *b_a = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "a", b);
+    FsearchDatabaseEntry *b_a_deep = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "deep", b_a);
+    FsearchDatabaseEntry *bd = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "b.d", root);
+    FsearchDatabaseEntry *b2 = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "b2", root);
+
+    FsearchDatabaseEntry *folders[] = {b_a_deep, b2, root, bd, b_a, b};
+    const uint32_t num_folders = G_N_ELEMENTS(folders);
+    FsearchDatabaseEntry *entries[] = {
+        b_a_deep,
+        b2,
+        root,
+        bd,
+        b_a,
+        b,
+        new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "z.txt", root),
+        new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "a", b),
+        new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "c.txt", b_a_deep),
+        new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "a.txt", b_a),
+        new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "x", bd),
+        new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "y", b2),
+    };
+    const uint32_t num_entries = G_N_ELEMENTS(entries);
+
+    int expected[G_N_ELEMENTS(entries) * G_N_ELEMENTS(entries) * 2];
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        for (uint32_t j = 0; j < num_entries; ++j) {
+            expected[2 * (i * num_entries + j)] = sign(db_entry_compare_entries_by_full_path(&entries[i], &entries[j]));
+            expected[2 * (i * num_entries + j) + 1] = sign(db_entry_compare_entries_by_path(&entries[i], &entries[j]));
+        }
+    }
+
+    FsearchDatabaseEntry *ranked[G_N_ELEMENTS(folders)];
+    memcpy(ranked, folders, sizeof(folders));
+    sort_entries_by_chain(ranked, num_folders, (FsearchDatabaseSortOrderChain){{DATABASE_INDEX_PROPERTY_PATH_FULL}, 1});
+    for (uint32_t i = 0; i < num_folders; ++i) {
+        db_entry_set_path_rank(ranked[i], i + 1);
+    }
+    assert_path_order_equal(entries, num_entries, expected);
+
+    // Like a folder which was created after the ranks were assigned
+    db_entry_set_path_rank(b_a, 0);
+    db_entry_set_path_rank(b2, 0);
+    assert_path_order_equal(entries, num_entries, expected);
+
+    for (uint32_t i = num_folders; i < num_entries; ++i) {
+        db_entry_free(entries[i]);
+    }
+    db_entry_free(b_a_deep);
+    db_entry_free(b_a);
+    db_entry_free(b);
+    db_entry_free(bd);
+    db_entry_free(b2);
+    db_entry_free(root);
+}
+
 static void
 test_dummy_does_not_change_parent_child_counts(void) {
     FsearchDatabaseEntry *dir = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "dir", NULL);
@@ -1440,6 +1722,120 @@ test_get_flags_reflects_type_and_mark(void) {
     db_entry_free(folder);
 }
 
+static void
+test_name_and_path_ascii_flags(void) {
+    FsearchDatabaseEntry *root = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "home", NULL);
+    FsearchDatabaseEntry *umlaut = new_folder(DATABASE_INDEX_PROPERTY_FLAG_NONE, "Bücher", root);
+    FsearchDatabaseEntry *ascii_in_umlaut = new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "notes.txt", umlaut);
+    FsearchDatabaseEntry *ascii_in_root = new_file(DATABASE_INDEX_PROPERTY_FLAG_NONE, "README", root);
+
+    g_assert_true(db_entry_name_is_ascii(root));
+    g_assert_false(db_entry_name_is_ascii(umlaut));
+    g_assert_true(db_entry_name_is_ascii(ascii_in_umlaut));
+
+    g_assert_true(db_entry_path_is_ascii(umlaut));
+    g_assert_false(db_entry_path_is_ascii(ascii_in_umlaut));
+    g_assert_true(db_entry_path_is_ascii(ascii_in_root));
+
+    db_entry_free(ascii_in_root);
+    db_entry_free(ascii_in_umlaut);
+    db_entry_free(umlaut);
+    db_entry_free(root);
+}
+
+/* ------------------------------------------------------------------------ *
+ * db_entry_new_in_arena / db_entry_new_with_attributes_in_arena
+ * ------------------------------------------------------------------------ */
+
+static void
+test_arena_entries_behave_like_heap_entries(void) {
+    g_autoptr(FsearchDatabaseEntryArena) arena = fsearch_database_entry_arena_new();
+
+    FsearchDatabaseEntry *folder = db_entry_new_in_arena(arena,
+                                                         DATABASE_INDEX_PROPERTY_FLAG_SIZE,
+                                                         "dir",
+                                                         NULL,
+                                                         DATABASE_ENTRY_TYPE_FOLDER);
+    FsearchDatabaseEntry *file = db_entry_new_with_attributes_in_arena(arena,
+                                                                       DATABASE_INDEX_PROPERTY_FLAG_SIZE,
+                                                                       "file.txt",
+                                                                       folder,
+                                                                       DATABASE_ENTRY_TYPE_FILE,
+                                                                       DATABASE_INDEX_PROPERTY_SIZE,
+                                                                       (int64_t)42,
+                                                                       DATABASE_INDEX_PROPERTY_NONE);
+    g_assert_true(db_entry_get_flags(folder) & FSEARCH_DATABASE_ENTRY_FLAG_ARENA);
+    g_assert_true(db_entry_get_flags(file) & FSEARCH_DATABASE_ENTRY_FLAG_ARENA);
+    g_assert_cmpstr(db_entry_get_name_raw(file), ==, "file.txt");
+    g_assert_cmpint(db_entry_get_size(file), ==, 42);
+    g_assert_cmpint(db_entry_get_size(folder), ==, 42);
+    g_assert_cmpuint(db_entry_folder_get_num_files(folder), ==, 1);
+    g_assert_cmpuint(fsearch_database_entry_arena_get_num_bytes(arena), >, 0);
+
+    // A deep copy doesn't live in the arena
+    FsearchDatabaseEntry *copy = db_entry_get_deep_copy(file);
+    g_assert_false(db_entry_get_flags(copy) & FSEARCH_DATABASE_ENTRY_FLAG_ARENA);
+    db_entry_free_full(copy);
+
+    db_entry_free(file);
+    g_assert_cmpuint(db_entry_folder_get_num_files(folder), ==, 0);
+    db_entry_free(folder);
+}
+
+static void
+test_arena_reuses_released_entries(void) {
+    g_autoptr(FsearchDatabaseEntryArena) arena = fsearch_database_entry_arena_new();
+
+    FsearchDatabaseEntry *a = db_entry_new_in_arena(arena, 0, "aaaa", NULL, DATABASE_ENTRY_TYPE_FILE);
+    db_entry_free(a);
+    // Same size class: the released slot gets handed out again, cleared
+    FsearchDatabaseEntry *b = db_entry_new_in_arena(arena, 0, "bbbb", NULL, DATABASE_ENTRY_TYPE_FILE);
+    g_assert_true((void *)a == (void *)b);
+    g_assert_cmpstr(db_entry_get_name_raw(b), ==, "bbbb");
+    g_assert_false(db_entry_get_mark(b));
+    db_entry_free(b);
+
+    // Entries which don't fit into any size class still work, they just aren't part of the arena
+    g_autofree char *long_name = g_strnfill(4096, 'x');
+    FsearchDatabaseEntry *large = db_entry_new_in_arena(arena, 0, long_name, NULL, DATABASE_ENTRY_TYPE_FOLDER);
+    g_assert_false(db_entry_get_flags(large) & FSEARCH_DATABASE_ENTRY_FLAG_ARENA);
+    g_assert_cmpstr(db_entry_get_name_raw(large), ==, long_name);
+    db_entry_free(large);
+}
+
+static void
+test_arena_unref_releases_remaining_entries(void) {
+    FsearchDatabaseEntryArena *arena = fsearch_database_entry_arena_new();
+    FsearchDatabaseEntry *root = db_entry_new_in_arena(arena, 0, "root", NULL, DATABASE_ENTRY_TYPE_FOLDER);
+    for (uint32_t i = 0; i < 10000; i++) {
+        g_autofree char *name = g_strdup_printf("file_%u", i);
+        db_entry_new_in_arena(arena, 0, name, root, DATABASE_ENTRY_TYPE_FILE);
+    }
+    g_assert_cmpuint(db_entry_folder_get_num_files(root), ==, 10000);
+
+    // Nothing gets freed individually: dropping the arena takes all entries with it (checked by valgrind/asan)
+    g_assert_true(fsearch_database_entry_arena_is_exclusive(arena));
+    g_clear_pointer(&arena, fsearch_database_entry_arena_unref);
+}
+
+static void
+test_arena_free_outside_arena_only_frees_large_entries(void) {
+    FsearchDatabaseEntryArena *arena = fsearch_database_entry_arena_new();
+    // Root folders store their full path as their name, which can be too large for any size class
+    g_autofree char *long_path = g_strnfill(600, 'x');
+    FsearchDatabaseEntry *root = db_entry_new_in_arena(arena, 0, long_path, NULL, DATABASE_ENTRY_TYPE_FOLDER);
+    FsearchDatabaseEntry *file = db_entry_new_in_arena(arena, 0, "file", root, DATABASE_ENTRY_TYPE_FILE);
+    g_assert_false(db_entry_get_flags(root) & FSEARCH_DATABASE_ENTRY_FLAG_ARENA);
+    g_assert_true(db_entry_get_flags(file) & FSEARCH_DATABASE_ENTRY_FLAG_ARENA);
+
+    // The entry in the arena stays untouched, the large one gets freed (checked by valgrind/asan)
+    db_entry_free_outside_arena(file);
+    g_assert_cmpstr(db_entry_get_name_raw(file), ==, "file");
+    db_entry_free_outside_arena(root);
+
+    g_clear_pointer(&arena, fsearch_database_entry_arena_unref);
+}
+
 /* ------------------------------------------------------------------------ *
  * Main
  * ------------------------------------------------------------------------ */
@@ -1502,6 +1898,7 @@ main(int argc, char **argv) {
     // Depth / parent / sibling / descendant
     g_test_add_func("/FSearch/database/entry/depth_root_zero", test_depth_root_is_zero);
     g_test_add_func("/FSearch/database/entry/depth_nesting", test_depth_increases_with_nesting);
+    g_test_add_func("/FSearch/database/entry/depth_follows_parent_changes", test_depth_follows_parent_changes);
     g_test_add_func("/FSearch/database/entry/parent_of_root_null", test_get_parent_of_root_is_null);
     g_test_add_func("/FSearch/database/entry/parent_null_entry", test_get_parent_null_entry_returns_null);
     g_test_add_func("/FSearch/database/entry/parent_returns_actual", test_get_parent_returns_actual_parent);
@@ -1547,6 +1944,8 @@ main(int argc, char **argv) {
     g_test_add_func("/FSearch/database/entry/append_path_preserves_prefix", test_append_path_appends_to_existing_content);
     g_test_add_func("/FSearch/database/entry/content_type_nonexistent_is_unknown",
                     test_append_content_type_of_nonexistent_path_is_unknown);
+    g_test_add_func("/FSearch/database/entry/content_type_indexed", test_append_content_type_uses_indexed_content_type);
+    g_test_add_func("/FSearch/database/entry/content_type_without_flag", test_content_type_without_flag_is_not_stored);
 
     // Comparators
     g_test_add_func("/FSearch/database/entry/compare_by_name_natural_order", test_compare_by_name_natural_order);
@@ -1563,6 +1962,8 @@ main(int argc, char **argv) {
                     test_compare_by_type_folders_always_equal);
     g_test_add_func("/FSearch/database/entry/compare_by_type_folder_file_differ",
                     test_compare_by_type_folder_and_file_differ);
+    g_test_add_func("/FSearch/database/entry/compare_by_type_indexed_content_type",
+                    test_compare_by_type_uses_indexed_content_type);
     g_test_add_func("/FSearch/database/entry/compare_by_chain_type_then_name", test_compare_by_chain_type_then_name);
     g_test_add_func("/FSearch/database/entry/compare_by_path_siblings_name_order",
                     test_compare_by_path_siblings_use_name_order);
@@ -1573,6 +1974,11 @@ main(int argc, char **argv) {
                     test_path_sort_keeps_descendant_files_contiguous);
     g_test_add_func("/FSearch/database/entry/path_compare_has_no_name_collisions",
                     test_path_compare_has_no_name_collisions);
+    g_test_add_func("/FSearch/database/entry/path_rank_only_in_folders", test_path_rank_is_only_stored_in_folders);
+    g_test_add_func("/FSearch/database/entry/path_rank_keeps_path_order", test_path_rank_keeps_path_order);
+    g_test_add_func("/FSearch/database/entry/id_table_hands_out_and_reuses_ids", test_id_table_hands_out_and_reuses_ids);
+    g_test_add_func("/FSearch/database/entry/id_table_looks_up_ids_after_removals",
+                    test_id_table_looks_up_ids_after_removals);
     g_test_add_func("/FSearch/database/entry/dummy_does_not_change_parent_child_counts",
                     test_dummy_does_not_change_parent_child_counts);
     g_test_add_func("/FSearch/database/entry/dummy_sorts_before_every_child", test_dummy_sorts_before_every_child);
@@ -1599,6 +2005,14 @@ main(int argc, char **argv) {
 
     // Flags
     g_test_add_func("/FSearch/database/entry/get_flags_type_and_mark", test_get_flags_reflects_type_and_mark);
+    g_test_add_func("/FSearch/database/entry/name_and_path_ascii_flags", test_name_and_path_ascii_flags);
+
+    // Arena
+    g_test_add_func("/FSearch/database/entry/arena_entries_like_heap_entries", test_arena_entries_behave_like_heap_entries);
+    g_test_add_func("/FSearch/database/entry/arena_reuses_released_entries", test_arena_reuses_released_entries);
+    g_test_add_func("/FSearch/database/entry/arena_unref_releases_remaining", test_arena_unref_releases_remaining_entries);
+    g_test_add_func("/FSearch/database/entry/arena_free_outside_arena_only_frees_large_entries",
+                    test_arena_free_outside_arena_only_frees_large_entries);
 
     return g_test_run();
 }
@@ -169,12 +169,97 @@ test_save_load_roundtrip_preserves_hierarchy_and_sort_orders(void) {
     g_rmdir(tmp_dir);
 }
 
+static void
+test_save_load_roundtrip_preserves_content_types(void) {
+    g_autofree char *tmp_dir = g_dir_make_tmp("fsearch-test-database-file-XXXXXX", NULL);
+    g_assert_nonnull(tmp_dir);
+
+    g_autofree char *file_a = g_build_filename(tmp_dir, "a.txt", NULL);
+    g_autofree char *file_b = g_build_filename(tmp_dir, "b.txt", NULL);
+    g_autofree char *file_c = g_build_filename(tmp_dir, "c.txt", NULL);
+    write_file(file_a, "a");
+    write_file(file_b, "b");
+    write_file(file_c, "c");
+
+    g_autoptr(FsearchDatabaseIncludeManager) include_manager = fsearch_database_include_manager_new();
+    g_autoptr(FsearchDatabaseInclude) include = fsearch_database_include_new(tmp_dir, TRUE, FALSE, FALSE, FALSE, 0);
+    fsearch_database_include_manager_add(include_manager, include);
+    g_autoptr(FsearchDatabaseExcludeManager) exclude_manager = fsearch_database_exclude_manager_new();
+
+    const FsearchDatabaseIndexPropertyFlags flags = DATABASE_INDEX_PROPERTY_FLAG_DEFAULT
+                                                  | DATABASE_INDEX_PROPERTY_FLAG_FILETYPE;
+    FsearchDatabaseIndexStore *store =
+        fsearch_database_index_store_new(include_manager, exclude_manager, flags, NULL, NULL);
+    fsearch_database_index_store_start(store, NULL);
+    g_assert_cmpuint(fsearch_database_index_store_get_num_files(store), ==, 3);
+
+    // Content types are determined in the background, hold the lock so it doesn't interfere. Two files share a content
+    // type, the last one isn't known yet.
+    const GQuark expected[3] = {
+        g_quark_from_static_string("text/x-test"),
+        g_quark_from_static_string("text/x-test"),
+        0,
+    };
+    fsearch_database_index_store_lock(store);
+    g_autoptr(FsearchDatabaseChunkedArray) files = fsearch_database_index_store_get_files(store,
+                                                                                          DATABASE_INDEX_PROPERTY_NAME);
+    for (uint32_t i = 0; i < 3; i++) {
+        db_entry_set_content_type(fsearch_database_chunked_array_get_entry(files, i), expected[i]);
+    }
+    g_autoptr(FsearchDatabaseChunkedArray) folders =
+        fsearch_database_index_store_get_folders(store, DATABASE_INDEX_PROPERTY_NAME);
+    db_entry_set_content_type(fsearch_database_chunked_array_get_entry(folders, 0),
+                              g_quark_from_static_string("inode/directory"));
+
+    g_autofree char *db_path = g_build_filename(tmp_dir, "test.db", NULL);
+    g_assert_true(fsearch_database_file_save(store, db_path));
+    fsearch_database_index_store_unlock(store);
+    g_clear_pointer(&files, fsearch_database_chunked_array_unref);
+    g_clear_pointer(&folders, fsearch_database_chunked_array_unref);
+    fsearch_database_index_store_unref(store);
+
+    g_autoptr(FsearchDatabaseIndexStore) loaded_store = NULL;
+    g_assert_true(fsearch_database_file_load(db_path,
+                                             NULL,
+                                             &loaded_store,
+                                             include_manager,
+                                             exclude_manager,
+                                             NULL,
+                                             NULL));
+    g_assert_nonnull(loaded_store);
+    g_assert_cmpuint(fsearch_database_index_store_get_flags(loaded_store), ==, flags);
+
+    fsearch_database_index_store_lock(loaded_store);
+    g_autoptr(FsearchDatabaseChunkedArray) loaded_files =
+        fsearch_database_index_store_get_files(loaded_store, DATABASE_INDEX_PROPERTY_NAME);
+    // The unknown one might have been determined in the background by now
+    for (uint32_t i = 0; i < 2; i++) {
+        FsearchDatabaseEntry *entry = fsearch_database_chunked_array_get_entry(loaded_files, i);
+        g_assert_cmpuint(db_entry_get_content_type(entry), ==, expected[i]);
+    }
+    g_autoptr(FsearchDatabaseChunkedArray) loaded_folders =
+        fsearch_database_index_store_get_folders(loaded_store, DATABASE_INDEX_PROPERTY_NAME);
+    g_assert_cmpstr(g_quark_to_string(
+                        db_entry_get_content_type(fsearch_database_chunked_array_get_entry(loaded_folders, 0))),
+                    ==,
+                    "inode/directory");
+    fsearch_database_index_store_unlock(loaded_store);
+
+    g_unlink(file_a);
+    g_unlink(file_b);
+    g_unlink(file_c);
+    g_unlink(db_path);
+    g_rmdir(tmp_dir);
+}
+
 int
 main(int argc, char **argv) {
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/FSearch/database/file/save_load_roundtrip_preserves_hierarchy_and_sort_orders",
                     test_save_load_roundtrip_preserves_hierarchy_and_sort_orders);
+    g_test_add_func("/FSearch/database/file/save_load_roundtrip_preserves_content_types",
+                    test_save_load_roundtrip_preserves_content_types);
 
     return g_test_run();
 }
@@ -20,18 +20,26 @@
  * incomplete, not silently treated as if it were a real, finished 0-result search.
  */
 
+#include "fsearch_database_chunked_array.h"
 #include "fsearch_database_entry.h"
+#include "fsearch_database_entry_info.h"
 #include "fsearch_database_exclude_manager.h"
+#include "fsearch_database_include.h"
 #include "fsearch_database_include_manager.h"
+#include "fsearch_database_index.h"
 #include "fsearch_database_index_properties.h"
 #include "fsearch_database_index_store.h"
 #include "fsearch_database_search_info.h"
 #include "fsearch_database_search_view.h"
+#include "fsearch_database_sort.h"
 #include "fsearch_filter_manager.h"
 #include "fsearch_query.h"
+#include "fsearch_query_match_data.h"
 
 #include <gio/gio.h>
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
 
 static DynamicArray *
 make_named_files(const char *prefix, uint32_t count) {
@@ -92,6 +100,7 @@ test_cancelled_search_keeps_partial_results_marked_incomplete(void) {
                                                       query_1,
                                                       DATABASE_INDEX_PROPERTY_NAME,
                                                       GTK_SORT_ASCENDING,
+                                                      0,
                                                       cancellable_1));
 
     g_autoptr(FsearchDatabaseSearchInfo) info_1 = fsearch_database_index_store_get_search_info(store, view_id);
@@ -110,6 +119,7 @@ test_cancelled_search_keeps_partial_results_marked_incomplete(void) {
                                                             query_2,
                                                             DATABASE_INDEX_PROPERTY_NAME,
                                                             GTK_SORT_ASCENDING,
+                                                            0,
                                                             cancellable_2);
     // The search function itself should report that it did not complete.
     g_assert_false(result);
@@ -131,12 +141,1225 @@ test_cancelled_search_keeps_partial_results_marked_incomplete(void) {
     fsearch_filter_manager_unref(filters);
 }
 
+static FsearchDatabaseIndexStore *
+make_store_with_event_func(DynamicArray *files,
+                           DynamicArray *folders,
+                           FsearchDatabaseIndexStoreEventFunc event_func,
+                           gpointer event_func_data) {
+    g_autoptr(FsearchDatabaseIncludeManager) include_manager = fsearch_database_include_manager_new();
+    g_autoptr(FsearchDatabaseExcludeManager) exclude_manager = fsearch_database_exclude_manager_new();
+
+    DynamicArray *files_by_property[NUM_DATABASE_INDEX_PROPERTIES] = {0};
+    DynamicArray *folders_by_property[NUM_DATABASE_INDEX_PROPERTIES] = {0};
+    files_by_property[DATABASE_INDEX_PROPERTY_NAME] = files;
+    folders_by_property[DATABASE_INDEX_PROPERTY_NAME] = folders;
+
+    g_autoptr(GPtrArray) indices = g_ptr_array_new();
+    return fsearch_database_index_store_new_with_content(indices,
+                                                         files_by_property,
+                                                         folders_by_property,
+                                                         include_manager,
+                                                         exclude_manager,
+                                                         DATABASE_INDEX_PROPERTY_FLAG_NAME,
+                                                         event_func,
+                                                         event_func_data);
+}
+
+static FsearchDatabaseIndexStore *
+make_store_with_files(DynamicArray *files, DynamicArray *folders) {
+    return make_store_with_event_func(files, folders, NULL, NULL);
+}
+
+// The trigram index gets built in the background, wait until searches can use it
+static void
+enable_trigram_index(FsearchDatabaseIndexStore *store) {
+    fsearch_database_index_store_lock(store);
+    fsearch_database_index_store_set_trigram_index_enabled(store, true);
+    bool ready = fsearch_database_index_store_has_trigram_index(store);
+    fsearch_database_index_store_unlock(store);
+    while (!ready) {
+        g_usleep(1000);
+        fsearch_database_index_store_lock(store);
+        ready = fsearch_database_index_store_has_trigram_index(store);
+        fsearch_database_index_store_unlock(store);
+    }
+}
+
+/*
+ * The search runs over the chunks of the fast-sort index directly, with threads claiming blocks of
+ * chunks in whatever order they get to them. Use enough entries to span several blocks and make
+ * sure the stitched result has exactly the matching entries, in index order.
+ */
+static void
+test_search_spanning_multiple_chunks_keeps_order(void) {
+    FsearchFilterManager *filters = fsearch_filter_manager_new_with_defaults();
+
+    const uint32_t num_files = 100000;
+    DynamicArray *files = make_named_files("apple", num_files);
+    g_autoptr(DynamicArray) folders = darray_new(0);
+    g_autoptr(FsearchDatabaseIndexStore) store = make_store_with_files(files, folders);
+
+    uint32_t num_expected = 0;
+    for (uint32_t i = 0; i < num_files; i++) {
+        if (strchr(db_entry_get_name_raw(darray_get_item(files, i)), '7')) {
+            num_expected++;
+        }
+    }
+
+    const uint32_t view_id = 1;
+    g_autoptr(FsearchQuery) query = make_query(filters, "7");
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    g_assert_true(fsearch_database_index_store_search(store,
+                                                      view_id,
+                                                      query,
+                                                      DATABASE_INDEX_PROPERTY_NAME,
+                                                      GTK_SORT_ASCENDING,
+                                                      0,
+                                                      cancellable));
+
+    g_autoptr(FsearchDatabaseSearchInfo) info = fsearch_database_index_store_get_search_info(store, view_id);
+    g_assert_nonnull(info);
+    g_assert_cmpuint(fsearch_database_search_info_get_num_files(info), ==, num_expected);
+
+    FsearchDatabaseSearchView *view = fsearch_database_index_store_get_search_view(store, view_id);
+    g_assert_nonnull(view);
+    const char *prev_name = NULL;
+    for (uint32_t i = 0; i < num_expected; i++) {
+        FsearchDatabaseEntry *entry = fsearch_database_search_view_get_entry_for_idx(view, i);
+        g_assert_nonnull(entry);
+        const char *name = db_entry_get_name_raw(entry);
+        g_assert_nonnull(strchr(name, '7'));
+        if (prev_name) {
+            g_assert_cmpint(strcmp(prev_name, name), <, 0);
+        }
+        prev_name = name;
+    }
+
+    free_entries(files);
+    fsearch_filter_manager_unref(filters);
+}
+
+/*
+ * With the trigram index enabled and built, selective substring searches only match the candidates the index hands out.
+ * They still have to find exactly the entries (and in the same order) a full scan finds, also for queries the index
+ * can't help with (short needles, OR, NOT), which fall back to the scan.
+ */
+static void
+test_trigram_index_search_matches_scan(void) {
+    FsearchFilterManager *filters = fsearch_filter_manager_new_with_defaults();
+
+    const char *prefixes[] = {"apple", "Banana", "cherry_pie", "README"};
+    const uint32_t num_files = 40000;
+    DynamicArray *files = darray_new(num_files);
+    for (uint32_t i = 0; i < num_files; i++) {
+        g_autofree char *name = g_strdup_printf("%s_%06u.txt", prefixes[i % G_N_ELEMENTS(prefixes)], i);
+        darray_add_item(files, db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE, name, NULL, DATABASE_ENTRY_TYPE_FILE));
+    }
+    g_autoptr(DynamicArray) folders = darray_new(0);
+    g_autoptr(FsearchDatabaseIndexStore) store = make_store_with_files(files, folders);
+
+    const char *search_terms[] = {
+        "12345",
+        "banana_0012",
+        "BANANA_0012",
+        "e_pie_03",
+        "readme 777",
+        "nothing_matches_this",
+        "12",
+        "12345 OR 23456",
+        "cherry !_0001",
+    };
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    for (uint32_t i = 0; i < G_N_ELEMENTS(search_terms); i++) {
+        g_autoptr(FsearchQuery) query = make_query(filters, search_terms[i]);
+
+        fsearch_database_index_store_lock(store);
+        fsearch_database_index_store_set_trigram_index_enabled(store, false);
+        fsearch_database_index_store_unlock(store);
+        g_assert_true(fsearch_database_index_store_search(store,
+                                                          1,
+                                                          query,
+                                                          DATABASE_INDEX_PROPERTY_NAME,
+                                                          GTK_SORT_ASCENDING,
+                                                          0,
+                                                          cancellable));
+
+        enable_trigram_index(store);
+        g_assert_true(fsearch_database_index_store_search(store,
+                                                          2,
+                                                          query,
+                                                          DATABASE_INDEX_PROPERTY_NAME,
+                                                          GTK_SORT_ASCENDING,
+                                                          0,
+                                                          cancellable));
+
+        g_autoptr(FsearchDatabaseSearchInfo) scan_info = fsearch_database_index_store_get_search_info(store, 1);
+        g_autoptr(FsearchDatabaseSearchInfo) trigram_info = fsearch_database_index_store_get_search_info(store, 2);
+        const uint32_t num_found = fsearch_database_search_info_get_num_files(scan_info);
+        g_assert_cmpuint(fsearch_database_search_info_get_num_files(trigram_info), ==, num_found);
+
+        FsearchDatabaseSearchView *scan_view = fsearch_database_index_store_get_search_view(store, 1);
+        FsearchDatabaseSearchView *trigram_view = fsearch_database_index_store_get_search_view(store, 2);
+        for (uint32_t j = 0; j < num_found; j++) {
+            g_assert_true(fsearch_database_search_view_get_entry_for_idx(scan_view, j)
+                          == fsearch_database_search_view_get_entry_for_idx(trigram_view, j));
+        }
+    }
+
+    free_entries(files);
+    fsearch_filter_manager_unref(filters);
+}
+
+/*
+ * Consecutive searches in the same view only search the previous results when the new query narrows down the
+ * previous one. Either way they have to find exactly what a fresh search on the whole index finds, also when the new
+ * query only looks like an extension of the previous one (e.g. below a NOT).
+ */
+static void
+test_refined_search_matches_fresh_search(void) {
+    FsearchFilterManager *filters = fsearch_filter_manager_new_with_defaults();
+
+    const char *prefixes[] = {"apple", "Banana", "cherry_pie"};
+    const uint32_t num_files = 30000;
+    DynamicArray *files = darray_new(num_files);
+    for (uint32_t i = 0; i < num_files; i++) {
+        g_autofree char *name = g_strdup_printf("%s_%06u.txt", prefixes[i % G_N_ELEMENTS(prefixes)], i);
+        darray_add_item(files, db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE, name, NULL, DATABASE_ENTRY_TYPE_FILE));
+    }
+    g_autoptr(DynamicArray) folders = darray_new(0);
+    g_autoptr(FsearchDatabaseIndexStore) store = make_store_with_files(files, folders);
+
+    const char *search_terms[] = {
+        "apple",
+        "apple_00",
+        "apple_001",
+        "pple_0012",
+        "apple_0012 .txt",
+        "banana",
+        "banana !_01",
+        "banana !_012",
+        "banana !_012 OR 99",
+        "banana !_012 OR 999",
+    };
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    for (uint32_t i = 0; i < G_N_ELEMENTS(search_terms); i++) {
+        g_autoptr(FsearchQuery) query = make_query(filters, search_terms[i]);
+
+        const uint32_t refined_id = 1;
+        const uint32_t fresh_id = 100 + i;
+        g_assert_true(fsearch_database_index_store_search(store,
+                                                          refined_id,
+                                                          query,
+                                                          DATABASE_INDEX_PROPERTY_NAME,
+                                                          GTK_SORT_ASCENDING,
+                                                          0,
+                                                          cancellable));
+        g_assert_true(fsearch_database_index_store_search(store,
+                                                          fresh_id,
+                                                          query,
+                                                          DATABASE_INDEX_PROPERTY_NAME,
+                                                          GTK_SORT_ASCENDING,
+                                                          0,
+                                                          cancellable));
+
+        g_autoptr(FsearchDatabaseSearchInfo) refined_info = fsearch_database_index_store_get_search_info(store,
+                                                                                                         refined_id);
+        g_autoptr(FsearchDatabaseSearchInfo) fresh_info = fsearch_database_index_store_get_search_info(store, fresh_id);
+        const uint32_t num_found = fsearch_database_search_info_get_num_files(fresh_info);
+        g_assert_cmpuint(fsearch_database_search_info_get_num_files(refined_info), ==, num_found);
+
+        FsearchDatabaseSearchView *refined_view = fsearch_database_index_store_get_search_view(store, refined_id);
+        FsearchDatabaseSearchView *fresh_view = fsearch_database_index_store_get_search_view(store, fresh_id);
+        for (uint32_t j = 0; j < num_found; j++) {
+            g_assert_true(fsearch_database_search_view_get_entry_for_idx(refined_view, j)
+                          == fsearch_database_search_view_get_entry_for_idx(fresh_view, j));
+        }
+    }
+
+    free_entries(files);
+    fsearch_filter_manager_unref(filters);
+}
+
+static DynamicArray *
+sorted_copy(DynamicArray *entries, FsearchDatabaseIndexProperty property) {
+    DynamicArray *sorted = darray_copy(entries);
+    g_autoptr(FsearchDatabaseEntryCompareContext) ctx = db_entry_compare_context_new(
+        fsearch_database_sort_order_chain_for_property(property));
+    darray_sort(sorted, (DynamicArrayCompareDataFunc)db_entry_compare_entries_by_chain, NULL, ctx);
+    return sorted;
+}
+
+/*
+ * Queries which require a size range only match the slice of the size index that range covers. They have to find
+ * exactly what matching every entry finds, in the order of the view, whether that's the size order or not.
+ */
+static void
+test_size_range_search_matches_scan(void) {
+    g_autoptr(FsearchDatabaseIncludeManager) include_manager = fsearch_database_include_manager_new();
+    g_autoptr(FsearchDatabaseExcludeManager) exclude_manager = fsearch_database_exclude_manager_new();
+    FsearchFilterManager *filters = fsearch_filter_manager_new_with_defaults();
+
+    const uint32_t num_files = 30000;
+    DynamicArray *files = darray_new(num_files);
+    for (uint32_t i = 0; i < num_files; i++) {
+        g_autofree char *name = g_strdup_printf("file_%06u", i);
+        darray_add_item(files,
+                        db_entry_new_with_attributes(DATABASE_INDEX_PROPERTY_FLAG_SIZE,
+                                                     name,
+                                                     NULL,
+                                                     DATABASE_ENTRY_TYPE_FILE,
+                                                     DATABASE_INDEX_PROPERTY_SIZE,
+                                                     (int64_t)((i * 7919) % 100000),
+                                                     DATABASE_INDEX_PROPERTY_NONE));
+    }
+    g_autoptr(DynamicArray) folders = darray_new(0);
+    g_autoptr(DynamicArray) files_by_size = sorted_copy(files, DATABASE_INDEX_PROPERTY_SIZE);
+    g_autoptr(DynamicArray) folders_by_size = darray_new(0);
+
+    DynamicArray *files_by_property[NUM_DATABASE_INDEX_PROPERTIES] = {0};
+    DynamicArray *folders_by_property[NUM_DATABASE_INDEX_PROPERTIES] = {0};
+    files_by_property[DATABASE_INDEX_PROPERTY_NAME] = files;
+    folders_by_property[DATABASE_INDEX_PROPERTY_NAME] = folders;
+    files_by_property[DATABASE_INDEX_PROPERTY_SIZE] = files_by_size;
+    folders_by_property[DATABASE_INDEX_PROPERTY_SIZE] = folders_by_size;
+
+    g_autoptr(GPtrArray) indices = g_ptr_array_new();
+    g_autoptr(FsearchDatabaseIndexStore) store = fsearch_database_index_store_new_with_content(
+        indices,
+        files_by_property,
+        folders_by_property,
+        include_manager,
+        exclude_manager,
+        DATABASE_INDEX_PROPERTY_FLAG_NAME | DATABASE_INDEX_PROPERTY_FLAG_SIZE,
+        NULL,
+        NULL);
+
+    const char *search_terms[] = {
+        "size:>99000",
+        "size:<100",
+        "size:=50000",
+        "size:>200000",
+        "size:>1000 size:<1500 file_01",
+        "size:<=100 OR file_000",
+        "!size:>10",
+    };
+    const FsearchDatabaseIndexProperty sort_orders[] = {DATABASE_INDEX_PROPERTY_NAME, DATABASE_INDEX_PROPERTY_SIZE};
+    DynamicArray *sorted_files[] = {files, files_by_size};
+
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    FsearchQueryMatchData *match_data = fsearch_query_match_data_new(NULL, NULL);
+    for (uint32_t i = 0; i < G_N_ELEMENTS(search_terms); i++) {
+        g_autoptr(FsearchQuery) query = make_query(filters, search_terms[i]);
+        for (uint32_t j = 0; j < G_N_ELEMENTS(sort_orders); j++) {
+            const uint32_t view_id = 100 * i + j;
+            g_assert_true(fsearch_database_index_store_search(store,
+                                                              view_id,
+                                                              query,
+                                                              sort_orders[j],
+                                                              GTK_SORT_ASCENDING,
+                                                              0,
+                                                              cancellable));
+            FsearchDatabaseSearchView *view = fsearch_database_index_store_get_search_view(store, view_id);
+            g_autoptr(FsearchDatabaseSearchInfo) info = fsearch_database_index_store_get_search_info(store, view_id);
+
+            uint32_t num_expected = 0;
+            for (uint32_t k = 0; k < num_files; k++) {
+                FsearchDatabaseEntry *entry = darray_get_item(sorted_files[j], k);
+                fsearch_query_match_data_set_entry(match_data, entry);
+                if (fsearch_query_match(query, match_data)) {
+                    g_assert_true(fsearch_database_search_view_get_entry_for_idx(view, num_expected) == entry);
+                    num_expected++;
+                }
+            }
+            g_assert_cmpuint(fsearch_database_search_info_get_num_files(info), ==, num_expected);
+        }
+    }
+    g_clear_pointer(&match_data, fsearch_query_match_data_free);
+
+    free_entries(files);
+    fsearch_filter_manager_unref(filters);
+}
+
+/*
+ * The radix sort by a numeric property is stable, so sorting name ordered entries with it has to produce exactly what
+ * a comparison sort by the property followed by name does, also for negative values and many equal ones.
+ */
+static void
+test_numeric_sort_matches_comparison_sort(void) {
+    const uint32_t num_files = 5000;
+    DynamicArray *files = darray_new(num_files);
+    for (uint32_t i = 0; i < num_files; i++) {
+        g_autofree char *name = g_strdup_printf("file_%06u", i);
+        darray_add_item(files,
+                        db_entry_new_with_attributes(DATABASE_INDEX_PROPERTY_FLAG_SIZE
+                                                         | DATABASE_INDEX_PROPERTY_FLAG_MODIFICATION_TIME
+                                                         | DATABASE_INDEX_PROPERTY_FLAG_ACCESS_TIME,
+                                                     name,
+                                                     NULL,
+                                                     DATABASE_ENTRY_TYPE_FILE,
+                                                     DATABASE_INDEX_PROPERTY_SIZE,
+                                                     (int64_t)((i * 7919) % 300),
+                                                     DATABASE_INDEX_PROPERTY_MODIFICATION_TIME,
+                                                     (int64_t)((i * 104729) % 2000) - 1000,
+                                                     DATABASE_INDEX_PROPERTY_ACCESS_TIME,
+                                                     (int64_t)((i * 31) % 977) * 1000000000,
+                                                     DATABASE_INDEX_PROPERTY_NONE));
+    }
+
+    const FsearchDatabaseIndexProperty properties[] = {
+        DATABASE_INDEX_PROPERTY_SIZE,
+        DATABASE_INDEX_PROPERTY_MODIFICATION_TIME,
+        DATABASE_INDEX_PROPERTY_ACCESS_TIME,
+        DATABASE_INDEX_PROPERTY_NUM_FILES,
+    };
+    for (uint32_t i = 0; i < G_N_ELEMENTS(properties); i++) {
+        g_assert_true(fsearch_database_sort_property_is_numeric(properties[i]));
+        g_autoptr(DynamicArray) sorted = fsearch_database_sort_entries_by_numeric_property(files, properties[i], NULL);
+
+        g_autoptr(DynamicArray) expected = darray_copy(files);
+        g_autoptr(FsearchDatabaseEntryCompareContext) ctx = db_entry_compare_context_new(
+            fsearch_database_sort_order_chain_prepend(
+                fsearch_database_sort_order_chain_for_property(DATABASE_INDEX_PROPERTY_NAME),
+                properties[i]));
+        darray_sort(expected, (DynamicArrayCompareDataFunc)db_entry_compare_entries_by_chain, NULL, ctx);
+
+        g_assert_cmpuint(darray_get_num_items(sorted), ==, num_files);
+        for (uint32_t j = 0; j < num_files; j++) {
+            g_assert_true(darray_get_item(sorted, j) == darray_get_item(expected, j));
+        }
+    }
+    g_assert_false(fsearch_database_sort_property_is_numeric(DATABASE_INDEX_PROPERTY_NAME));
+
+    free_entries(files);
+}
+
+/*
+ * Names and extensions are sorted by their abbreviated sort keys and paths by the parents' ranks. That has to be as
+ * stable as a comparison sort and agree with it, also for names which only differ after a long common prefix and for
+ * numbers in names.
+ */
+static void
+test_property_sort_matches_comparison_sort(void) {
+    const char *names[] = {
+        "file10.txt",      "file9.txt",        "file09.txt",       "file009.txt",  "file0.txt",
+        "file00.txt",      "file.txt",         "File.txt",         "a_very_long_common_prefix_1",
+        "a_very_long_common_prefix_2",         "a_very_long_common_prefix_10",     "archive.tar.gz",
+        "image.jpeg",      "image.jpg",        "notes.markdown",   "notes.markdownx", "x",
+    };
+    DynamicArray *folders = darray_new(3);
+    DynamicArray *files = darray_new(3 * G_N_ELEMENTS(names));
+    for (uint32_t i = 0; i < 3; i++) {
+        g_autofree char *folder_name = g_strdup_printf("folder_%u", i);
+        FsearchDatabaseEntry *folder = db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NAME,
+                                                    folder_name,
+                                                    NULL,
+                                                    DATABASE_ENTRY_TYPE_FOLDER);
+        darray_add_item(folders, folder);
+    }
+    // The folders are added last to first, so the input is neither in name nor in path order
+    for (uint32_t i = 0; i < 3 * G_N_ELEMENTS(names); i++) {
+        FsearchDatabaseEntry *folder = darray_get_item(folders, 2 - i % 3);
+        darray_add_item(files,
+                        db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NAME,
+                                     names[(i * 7) % G_N_ELEMENTS(names)],
+                                     folder,
+                                     DATABASE_ENTRY_TYPE_FILE));
+    }
+
+    const FsearchDatabaseIndexProperty properties[] = {
+        DATABASE_INDEX_PROPERTY_NAME,
+        DATABASE_INDEX_PROPERTY_EXTENSION,
+        DATABASE_INDEX_PROPERTY_PATH,
+    };
+    for (uint32_t ranked = 0; ranked < 2; ranked++) {
+        if (ranked) {
+            for (uint32_t i = 0; i < 3; i++) {
+                db_entry_set_path_rank(darray_get_item(folders, i), i + 1);
+            }
+        }
+        for (uint32_t i = 0; i < G_N_ELEMENTS(properties); i++) {
+            g_autoptr(DynamicArray) sorted = fsearch_database_sort_entries_by_property(files, properties[i], NULL);
+
+            FsearchDatabaseSortOrderChain chain = {};
+            chain.properties[chain.length++] = properties[i];
+            g_autoptr(DynamicArray) expected = darray_copy(files);
+            g_autoptr(FsearchDatabaseEntryCompareContext) ctx = db_entry_compare_context_new(chain);
+            darray_sort(expected, (DynamicArrayCompareDataFunc)db_entry_compare_entries_by_chain, NULL, ctx);
+
+            g_assert_cmpuint(darray_get_num_items(sorted), ==, darray_get_num_items(files));
+            for (uint32_t j = 0; j < darray_get_num_items(files); j++) {
+                g_assert_true(darray_get_item(sorted, j) == darray_get_item(expected, j));
+            }
+        }
+    }
+
+    free_entries(files);
+    free_entries(folders);
+}
+
+static void
+assert_index_in_chain_order(FsearchDatabaseChunkedArray *chunks, FsearchDatabaseIndexProperty property) {
+    g_assert_nonnull(chunks);
+    g_autoptr(DynamicArray) entries = fsearch_database_chunked_array_get_joined(chunks);
+    g_autoptr(DynamicArray) expected = darray_copy(entries);
+    g_autoptr(FsearchDatabaseEntryCompareContext) ctx = db_entry_compare_context_new(
+        fsearch_database_sort_order_chain_for_property(property));
+    darray_sort(expected, (DynamicArrayCompareDataFunc)db_entry_compare_entries_by_chain, NULL, ctx);
+    for (uint32_t i = 0; i < darray_get_num_items(entries); i++) {
+        g_assert_true(darray_get_item(entries, i) == darray_get_item(expected, i));
+    }
+}
+
+/*
+ * Starting a store builds all fast sort indices concurrently, most of them derived from the name order. Every one of
+ * them has to end up in the full order of its chain, for files and folders alike.
+ */
+static void
+test_start_builds_indices_in_chain_order(void) {
+    const char *folder_names[] = {"b", "a", "a/c"};
+    const char *file_names[] = {"file10.txt", "file9.txt", "File.txt", "notes.md", "x"};
+
+    g_autofree char *tmp_dir = g_dir_make_tmp("fsearch-test-index-store-XXXXXX", NULL);
+    g_assert_nonnull(tmp_dir);
+    g_autoptr(GPtrArray) dirs = g_ptr_array_new_with_free_func(g_free);
+    g_ptr_array_add(dirs, g_strdup(tmp_dir));
+    for (uint32_t i = 0; i < G_N_ELEMENTS(folder_names); i++) {
+        char *dir = g_build_filename(tmp_dir, folder_names[i], NULL);
+        g_assert_cmpint(g_mkdir(dir, 0700), ==, 0);
+        g_ptr_array_add(dirs, dir);
+    }
+    g_autoptr(GPtrArray) files = g_ptr_array_new_with_free_func(g_free);
+    for (uint32_t i = 0; i < dirs->len; i++) {
+        for (uint32_t j = 0; j < G_N_ELEMENTS(file_names); j++) {
+            char *path = g_build_filename(g_ptr_array_index(dirs, i), file_names[j], NULL);
+            // Sizes which repeat, so the size index relies on the rest of its chain as well
+            g_assert_true(g_file_set_contents(path, "abcd", (i * 7 + j) % 5, NULL));
+            g_ptr_array_add(files, path);
+        }
+    }
+
+    g_autoptr(FsearchDatabaseIncludeManager) include_manager = fsearch_database_include_manager_new();
+    g_autoptr(FsearchDatabaseInclude) include = fsearch_database_include_new(tmp_dir, TRUE, FALSE, FALSE, FALSE, 0);
+    fsearch_database_include_manager_add(include_manager, include);
+    g_autoptr(FsearchDatabaseExcludeManager) exclude_manager = fsearch_database_exclude_manager_new();
+
+    g_autoptr(FsearchDatabaseIndexStore) store = fsearch_database_index_store_new(
+        include_manager,
+        exclude_manager,
+        DATABASE_INDEX_PROPERTY_FLAG_NAME | DATABASE_INDEX_PROPERTY_FLAG_SIZE
+            | DATABASE_INDEX_PROPERTY_FLAG_MODIFICATION_TIME,
+        NULL,
+        NULL);
+    fsearch_database_index_store_start(store, NULL);
+    g_assert_true(fsearch_database_index_store_is_running(store));
+    g_assert_cmpuint(fsearch_database_index_store_get_num_files(store), ==, files->len);
+
+    const FsearchDatabaseIndexProperty properties[] = {
+        DATABASE_INDEX_PROPERTY_NAME,
+        DATABASE_INDEX_PROPERTY_PATH,
+        DATABASE_INDEX_PROPERTY_SIZE,
+        DATABASE_INDEX_PROPERTY_MODIFICATION_TIME,
+        DATABASE_INDEX_PROPERTY_EXTENSION,
+    };
+    for (uint32_t i = 0; i < G_N_ELEMENTS(properties); i++) {
+        g_autoptr(FsearchDatabaseChunkedArray) file_chunks = fsearch_database_index_store_get_files(store,
+                                                                                                    properties[i]);
+        g_autoptr(FsearchDatabaseChunkedArray) folder_chunks = fsearch_database_index_store_get_folders(store,
+                                                                                                        properties[i]);
+        assert_index_in_chain_order(file_chunks, properties[i]);
+        assert_index_in_chain_order(folder_chunks, properties[i]);
+    }
+
+    g_clear_pointer(&store, fsearch_database_index_store_unref);
+    for (uint32_t i = 0; i < files->len; i++) {
+        g_unlink(g_ptr_array_index(files, i));
+    }
+    for (uint32_t i = dirs->len; i > 0; i--) {
+        g_rmdir(g_ptr_array_index(dirs, i - 1));
+    }
+}
+
+/*
+ * With indexed content types, the store determines them on a thread of its own once it's running. Every entry ends up
+ * with the content type a direct lookup finds, which is also what its entry info hands out for the Type column.
+ */
+static void
+test_content_types_get_determined_in_background(void) {
+    const char *file_names[] = {"notes.txt", "data.bin", "script.sh"};
+    const char *file_contents[] = {"hello\n", "\x7f\x01\x02\x03", "#!/bin/sh\necho hello\n"};
+
+    g_autofree char *tmp_dir = g_dir_make_tmp("fsearch-test-index-store-XXXXXX", NULL);
+    g_assert_nonnull(tmp_dir);
+    g_autoptr(GPtrArray) files = g_ptr_array_new_with_free_func(g_free);
+    for (uint32_t i = 0; i < G_N_ELEMENTS(file_names); i++) {
+        char *path = g_build_filename(tmp_dir, file_names[i], NULL);
+        g_assert_true(g_file_set_contents(path, file_contents[i], -1, NULL));
+        g_ptr_array_add(files, path);
+    }
+
+    g_autoptr(FsearchDatabaseIncludeManager) include_manager = fsearch_database_include_manager_new();
+    g_autoptr(FsearchDatabaseInclude) include = fsearch_database_include_new(tmp_dir, TRUE, FALSE, FALSE, FALSE, 0);
+    fsearch_database_include_manager_add(include_manager, include);
+    g_autoptr(FsearchDatabaseExcludeManager) exclude_manager = fsearch_database_exclude_manager_new();
+
+    g_autoptr(FsearchDatabaseIndexStore) store = fsearch_database_index_store_new(
+        include_manager,
+        exclude_manager,
+        DATABASE_INDEX_PROPERTY_FLAG_NAME | DATABASE_INDEX_PROPERTY_FLAG_FILETYPE,
+        NULL,
+        NULL);
+    fsearch_database_index_store_start(store, NULL);
+    g_assert_cmpuint(fsearch_database_index_store_get_num_files(store), ==, files->len);
+
+    const int64_t deadline = g_get_monotonic_time() + 10 * G_USEC_PER_SEC;
+    while (true) {
+        fsearch_database_index_store_lock(store);
+        g_autoptr(FsearchDatabaseChunkedArray) file_chunks = fsearch_database_index_store_get_files(
+            store,
+            DATABASE_INDEX_PROPERTY_NAME);
+        g_autoptr(DynamicArray) entries = fsearch_database_chunked_array_get_joined(file_chunks);
+        uint32_t num_known = 0;
+        for (uint32_t i = 0; i < darray_get_num_items(entries); i++) {
+            FsearchDatabaseEntry *entry = darray_get_item(entries, i);
+            const GQuark content_type = db_entry_get_content_type(entry);
+            if (content_type == 0) {
+                continue;
+            }
+            num_known++;
+            g_autoptr(GString) path = db_entry_get_path_full(entry);
+            const GQuark queried_content_type = db_entry_query_content_type(path->str);
+            g_assert_cmpstr(g_quark_to_string(content_type), ==, g_quark_to_string(queried_content_type));
+            g_autoptr(FsearchDatabaseEntryInfo) info = fsearch_database_entry_info_new(
+                entry,
+                NULL,
+                0,
+                false,
+                FSEARCH_DATABASE_ENTRY_INFO_FLAG_CONTENT_TYPE);
+            g_assert_cmpuint(fsearch_database_entry_info_get_content_type(info), ==, content_type);
+        }
+        fsearch_database_index_store_unlock(store);
+
+        if (num_known == files->len) {
+            break;
+        }
+        g_assert_cmpint(g_get_monotonic_time(), <, deadline);
+        g_usleep(10000);
+    }
+
+    g_clear_pointer(&store, fsearch_database_index_store_unref);
+    for (uint32_t i = 0; i < files->len; i++) {
+        g_unlink(g_ptr_array_index(files, i));
+    }
+    g_rmdir(tmp_dir);
+}
+
+/*
+ * Queries with extension matches only match the entries the extension index hands out for them. They have to find
+ * exactly what matching every entry finds, regardless of the extension's case, also for queries the index can't help
+ * with (NOT, common extensions), which fall back to the scan.
+ */
+static void
+test_extension_index_search_matches_scan(void) {
+    FsearchFilterManager *filters = fsearch_filter_manager_new_with_defaults();
+
+    const char *extensions[] = {"jpg", "JPG", "png", "txt", "tar.gz"};
+    const uint32_t num_files = 40000;
+    DynamicArray *files = darray_new(num_files);
+    for (uint32_t i = 0; i < num_files; i++) {
+        // Every 64th file is rare enough for the extension index to be used
+        const char *ext = i % 64 == 0 ? extensions[(i / 64) % G_N_ELEMENTS(extensions)] : "dat";
+        g_autofree char *name = g_strdup_printf("file_%06u.%s", i, ext);
+        darray_add_item(files, db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE, name, NULL, DATABASE_ENTRY_TYPE_FILE));
+    }
+    g_autoptr(DynamicArray) folders = darray_new(0);
+    g_autoptr(FsearchDatabaseIndexStore) store = make_store_with_files(files, folders);
+
+    const char *search_terms[] = {
+        "ext:jpg",
+        "ext:jpg;png file_00",
+        "ext:gz",
+        "ext:doc",
+        "ext:dat",
+        "ext:txt OR file_0001",
+        "!ext:jpg",
+    };
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    FsearchQueryMatchData *match_data = fsearch_query_match_data_new(NULL, NULL);
+    for (uint32_t i = 0; i < G_N_ELEMENTS(search_terms); i++) {
+        g_autoptr(FsearchQuery) query = make_query(filters, search_terms[i]);
+        g_assert_true(fsearch_database_index_store_search(store,
+                                                          i,
+                                                          query,
+                                                          DATABASE_INDEX_PROPERTY_NAME,
+                                                          GTK_SORT_ASCENDING,
+                                                          0,
+                                                          cancellable));
+        FsearchDatabaseSearchView *view = fsearch_database_index_store_get_search_view(store, i);
+        g_autoptr(FsearchDatabaseSearchInfo) info = fsearch_database_index_store_get_search_info(store, i);
+
+        uint32_t num_expected = 0;
+        for (uint32_t j = 0; j < num_files; j++) {
+            FsearchDatabaseEntry *entry = darray_get_item(files, j);
+            fsearch_query_match_data_set_entry(match_data, entry);
+            if (fsearch_query_match(query, match_data)) {
+                g_assert_true(fsearch_database_search_view_get_entry_for_idx(view, num_expected) == entry);
+                num_expected++;
+            }
+        }
+        g_assert_cmpuint(fsearch_database_search_info_get_num_files(info), ==, num_expected);
+    }
+    g_clear_pointer(&match_data, fsearch_query_match_data_free);
+
+    free_entries(files);
+    fsearch_filter_manager_unref(filters);
+}
+
+/*
+ * With both inverted indices, the candidates of the operands get combined like the operators combine their matches
+ * (intersected for AND, united for OR). Such queries still have to find exactly what matching every entry finds.
+ */
+static void
+test_combined_index_candidates_match_scan(void) {
+    FsearchFilterManager *filters = fsearch_filter_manager_new_with_defaults();
+
+    const char *prefixes[] = {"apple", "Banana", "cherry_pie", "README"};
+    const char *extensions[] = {"jpg", "png", "txt", "gz"};
+    const uint32_t num_files = 40000;
+    DynamicArray *files = darray_new(num_files);
+    for (uint32_t i = 0; i < num_files; i++) {
+        const char *ext = i % 32 == 0 ? extensions[(i / 32) % G_N_ELEMENTS(extensions)] : "dat";
+        g_autofree char *name = g_strdup_printf("%s_%06u.%s", prefixes[i % G_N_ELEMENTS(prefixes)], i, ext);
+        darray_add_item(files, db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE, name, NULL, DATABASE_ENTRY_TYPE_FILE));
+    }
+    g_autoptr(DynamicArray) files_by_name = sorted_copy(files, DATABASE_INDEX_PROPERTY_NAME);
+    g_autoptr(DynamicArray) folders = darray_new(0);
+    g_autoptr(FsearchDatabaseIndexStore) store = make_store_with_files(files_by_name, folders);
+    enable_trigram_index(store);
+
+    const char *search_terms[] = {
+        "ext:jpg apple",
+        "ext:jpg OR ext:png",
+        "banana_0012 OR ext:gz",
+        "(ext:txt cherry) OR readme_001",
+        "ext:png readme_00 OR apple_0001",
+        "ext:jpg !apple",
+        "ext:jpg OR 12",
+        "ext:doc OR nothing_matches_this",
+    };
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    FsearchQueryMatchData *match_data = fsearch_query_match_data_new(NULL, NULL);
+    for (uint32_t i = 0; i < G_N_ELEMENTS(search_terms); i++) {
+        g_autoptr(FsearchQuery) query = make_query(filters, search_terms[i]);
+        g_assert_true(fsearch_database_index_store_search(store,
+                                                          i,
+                                                          query,
+                                                          DATABASE_INDEX_PROPERTY_NAME,
+                                                          GTK_SORT_ASCENDING,
+                                                          0,
+                                                          cancellable));
+        FsearchDatabaseSearchView *view = fsearch_database_index_store_get_search_view(store, i);
+        g_autoptr(FsearchDatabaseSearchInfo) info = fsearch_database_index_store_get_search_info(store, i);
+
+        uint32_t num_expected = 0;
+        for (uint32_t j = 0; j < num_files; j++) {
+            FsearchDatabaseEntry *entry = darray_get_item(files_by_name, j);
+            fsearch_query_match_data_set_entry(match_data, entry);
+            if (fsearch_query_match(query, match_data)) {
+                g_assert_true(fsearch_database_search_view_get_entry_for_idx(view, num_expected) == entry);
+                num_expected++;
+            }
+        }
+        g_assert_cmpuint(fsearch_database_search_info_get_num_files(info), ==, num_expected);
+    }
+    g_clear_pointer(&match_data, fsearch_query_match_data_free);
+
+    free_entries(files);
+    fsearch_filter_manager_unref(filters);
+}
+
+/*
+ * Queries with a parent path match only the children of the folder the path refers to, which get looked up in the
+ * path index. They have to find exactly what matching every entry finds, in the order of the view, also without case
+ * sensitivity (which can refer to several folders) and when the folder doesn't exist.
+ */
+static void
+test_parent_search_matches_scan(void) {
+    g_autoptr(FsearchDatabaseIncludeManager) include_manager = fsearch_database_include_manager_new();
+    g_autoptr(FsearchDatabaseExcludeManager) exclude_manager = fsearch_database_exclude_manager_new();
+    FsearchFilterManager *filters = fsearch_filter_manager_new_with_defaults();
+
+    // /data/project_XX/{src,Src}/file_XXXXXX, with files in the project folders as well
+    g_autoptr(DynamicArray) folders = darray_new(128);
+    DynamicArray *files = darray_new(4096);
+    FsearchDatabaseEntry *root = db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE,
+                                              "/data",
+                                              NULL,
+                                              DATABASE_ENTRY_TYPE_FOLDER);
+    darray_add_item(folders, root);
+    uint32_t num_files = 0;
+    for (uint32_t i = 0; i < 40; i++) {
+        g_autofree char *project_name = g_strdup_printf("project_%02u", i);
+        FsearchDatabaseEntry *project = db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE,
+                                                     project_name,
+                                                     root,
+                                                     DATABASE_ENTRY_TYPE_FOLDER);
+        darray_add_item(folders, project);
+        FsearchDatabaseEntry *parents[] = {
+            project,
+            db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE, "src", project, DATABASE_ENTRY_TYPE_FOLDER),
+            db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE, "Src", project, DATABASE_ENTRY_TYPE_FOLDER),
+        };
+        darray_add_item(folders, parents[1]);
+        darray_add_item(folders, parents[2]);
+        for (uint32_t j = 0; j < 100; j++) {
+            g_autofree char *name = g_strdup_printf("file_%06u", num_files++);
+            darray_add_item(files,
+                            db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE,
+                                         name,
+                                         parents[j % G_N_ELEMENTS(parents)],
+                                         DATABASE_ENTRY_TYPE_FILE));
+        }
+    }
+    g_autoptr(DynamicArray) files_by_name = sorted_copy(files, DATABASE_INDEX_PROPERTY_NAME);
+    g_autoptr(DynamicArray) files_by_path = sorted_copy(files, DATABASE_INDEX_PROPERTY_PATH);
+    g_autoptr(DynamicArray) folders_by_name = sorted_copy(folders, DATABASE_INDEX_PROPERTY_NAME);
+    g_autoptr(DynamicArray) folders_by_path = sorted_copy(folders, DATABASE_INDEX_PROPERTY_PATH);
+
+    DynamicArray *files_by_property[NUM_DATABASE_INDEX_PROPERTIES] = {0};
+    DynamicArray *folders_by_property[NUM_DATABASE_INDEX_PROPERTIES] = {0};
+    files_by_property[DATABASE_INDEX_PROPERTY_NAME] = files_by_name;
+    folders_by_property[DATABASE_INDEX_PROPERTY_NAME] = folders_by_name;
+    files_by_property[DATABASE_INDEX_PROPERTY_PATH] = files_by_path;
+    folders_by_property[DATABASE_INDEX_PROPERTY_PATH] = folders_by_path;
+
+    g_autoptr(GPtrArray) indices = g_ptr_array_new();
+    g_autoptr(FsearchDatabaseIndexStore) store = fsearch_database_index_store_new_with_content(
+        indices,
+        files_by_property,
+        folders_by_property,
+        include_manager,
+        exclude_manager,
+        DATABASE_INDEX_PROPERTY_FLAG_NAME | DATABASE_INDEX_PROPERTY_FLAG_PATH,
+        NULL,
+        NULL);
+
+    const char *search_terms[] = {
+        "parent:/data/project_07",
+        "parent:/data/project_07/src",
+        "parent:/DATA/PROJECT_07/SRC",
+        "case:parent:/data/project_07/Src",
+        "parent:/data",
+        "parent:/data/project_07/src file_0007",
+        "parent:/data/project_99",
+        "parent:/data/project_07 OR file_00001",
+        "!parent:/data/project_07",
+    };
+    const FsearchDatabaseIndexProperty sort_orders[] = {DATABASE_INDEX_PROPERTY_NAME, DATABASE_INDEX_PROPERTY_PATH};
+    DynamicArray *sorted_files[] = {files_by_name, files_by_path};
+    DynamicArray *sorted_folders[] = {folders_by_name, folders_by_path};
+
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    FsearchQueryMatchData *match_data = fsearch_query_match_data_new(NULL, NULL);
+    for (uint32_t i = 0; i < G_N_ELEMENTS(search_terms); i++) {
+        g_autoptr(FsearchQuery) query = make_query(filters, search_terms[i]);
+        for (uint32_t j = 0; j < G_N_ELEMENTS(sort_orders); j++) {
+            const uint32_t view_id = 100 * i + j;
+            g_assert_true(fsearch_database_index_store_search(store,
+                                                              view_id,
+                                                              query,
+                                                              sort_orders[j],
+                                                              GTK_SORT_ASCENDING,
+                                                              0,
+                                                              cancellable));
+            FsearchDatabaseSearchView *view = fsearch_database_index_store_get_search_view(store, view_id);
+            g_autoptr(FsearchDatabaseSearchInfo) info = fsearch_database_index_store_get_search_info(store, view_id);
+
+            // The view lists the folders first
+            uint32_t num_expected = 0;
+            DynamicArray *expected[] = {sorted_folders[j], sorted_files[j]};
+            for (uint32_t k = 0; k < G_N_ELEMENTS(expected); k++) {
+                for (uint32_t l = 0; l < darray_get_num_items(expected[k]); l++) {
+                    FsearchDatabaseEntry *entry = darray_get_item(expected[k], l);
+                    fsearch_query_match_data_set_entry(match_data, entry);
+                    if (fsearch_query_match(query, match_data)) {
+                        g_assert_true(fsearch_database_search_view_get_entry_for_idx(view, num_expected) == entry);
+                        num_expected++;
+                    }
+                }
+            }
+            g_assert_cmpuint(fsearch_database_search_info_get_num_files(info)
+                                 + fsearch_database_search_info_get_num_folders(info),
+                             ==,
+                             num_expected);
+        }
+    }
+    g_clear_pointer(&match_data, fsearch_query_match_data_free);
+
+    free_entries(files);
+    // Children first, so no folder gets unparented from an already freed one
+    for (uint32_t i = darray_get_num_items(folders); i > 0; i--) {
+        db_entry_free(darray_get_item(folders, i - 1));
+    }
+    fsearch_filter_manager_unref(filters);
+}
+
+/*
+ * A limited search only keeps the first results in the order of the view, which are the first folders for the
+ * ascending order and the last files for the descending one. Those have to be exactly the first rows of the
+ * unlimited search, for scans which stop early as well as for queries which match everything.
+ */
+static void
+test_limited_search_keeps_first_results(void) {
+    FsearchFilterManager *filters = fsearch_filter_manager_new_with_defaults();
+
+    DynamicArray *files = make_named_files("file", 100000);
+    DynamicArray *folders = darray_new(20);
+    for (uint32_t i = 0; i < 20; i++) {
+        g_autofree char *name = g_strdup_printf("folder_7_%02u", i);
+        darray_add_item(folders, db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE, name, NULL, DATABASE_ENTRY_TYPE_FOLDER));
+    }
+    g_autoptr(FsearchDatabaseIndexStore) store = make_store_with_files(files, folders);
+
+    const char *search_terms[] = {"7", ""};
+    const GtkSortType sort_types[] = {GTK_SORT_ASCENDING, GTK_SORT_DESCENDING};
+    const uint32_t limits[] = {1, 5, 50, 1000000};
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    for (uint32_t i = 0; i < G_N_ELEMENTS(search_terms); i++) {
+        g_autoptr(FsearchQuery) query = make_query(filters, search_terms[i]);
+        for (uint32_t j = 0; j < G_N_ELEMENTS(sort_types); j++) {
+            const uint32_t full_id = 1;
+            g_assert_true(fsearch_database_index_store_search(store,
+                                                              full_id,
+                                                              query,
+                                                              DATABASE_INDEX_PROPERTY_NAME,
+                                                              sort_types[j],
+                                                              0,
+                                                              cancellable));
+            g_autoptr(FsearchDatabaseSearchInfo) full_info = fsearch_database_index_store_get_search_info(store,
+                                                                                                          full_id);
+            const uint32_t num_full = fsearch_database_search_info_get_num_entries(full_info);
+            FsearchDatabaseSearchView *full_view = fsearch_database_index_store_get_search_view(store, full_id);
+
+            for (uint32_t k = 0; k < G_N_ELEMENTS(limits); k++) {
+                const uint32_t limited_id = 2;
+                const bool is_complete = fsearch_database_index_store_search(store,
+                                                                             limited_id,
+                                                                             query,
+                                                                             DATABASE_INDEX_PROPERTY_NAME,
+                                                                             sort_types[j],
+                                                                             limits[k],
+                                                                             cancellable);
+                g_autoptr(FsearchDatabaseSearchInfo) info = fsearch_database_index_store_get_search_info(store,
+                                                                                                         limited_id);
+                const uint32_t num_entries = fsearch_database_search_info_get_num_entries(info);
+                g_assert_cmpuint(num_entries, ==, MIN(limits[k], num_full));
+                g_assert_cmpint(is_complete, ==, num_full <= limits[k]);
+                g_assert_cmpint(fsearch_database_search_info_get_is_complete(info), ==, is_complete);
+
+                FsearchDatabaseSearchView *view = fsearch_database_index_store_get_search_view(store, limited_id);
+                for (uint32_t idx = 0; idx < num_entries; idx++) {
+                    g_assert_true(fsearch_database_search_view_get_entry_for_idx(view, idx)
+                                  == fsearch_database_search_view_get_entry_for_idx(full_view, idx));
+                }
+            }
+        }
+    }
+
+    free_entries(files);
+    free_entries(folders);
+    fsearch_filter_manager_unref(filters);
+}
+
+/*
+ * A limited search is only incomplete if matches got dropped because of the limit. With exactly `limit` matches
+ * nothing is missing, so the search is complete and its results can be refined, both for scans and for queries which
+ * match everything.
+ */
+static void
+test_limited_search_with_exactly_limit_matches_is_complete(void) {
+    FsearchFilterManager *filters = fsearch_filter_manager_new_with_defaults();
+
+    DynamicArray *files = make_named_files("file", 100000);
+    DynamicArray *folders = darray_new(20);
+    for (uint32_t i = 0; i < 20; i++) {
+        g_autofree char *name = g_strdup_printf("folder_7_%02u", i);
+        darray_add_item(folders, db_entry_new(DATABASE_INDEX_PROPERTY_FLAG_NONE, name, NULL, DATABASE_ENTRY_TYPE_FOLDER));
+    }
+    g_autoptr(FsearchDatabaseIndexStore) store = make_store_with_files(files, folders);
+
+    const char *search_terms[] = {"7", "folder", ""};
+    const GtkSortType sort_types[] = {GTK_SORT_ASCENDING, GTK_SORT_DESCENDING};
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    for (uint32_t i = 0; i < G_N_ELEMENTS(search_terms); i++) {
+        g_autoptr(FsearchQuery) query = make_query(filters, search_terms[i]);
+        for (uint32_t j = 0; j < G_N_ELEMENTS(sort_types); j++) {
+            const uint32_t full_id = 1;
+            g_assert_true(fsearch_database_index_store_search(store,
+                                                              full_id,
+                                                              query,
+                                                              DATABASE_INDEX_PROPERTY_NAME,
+                                                              sort_types[j],
+                                                              0,
+                                                              cancellable));
+            g_autoptr(FsearchDatabaseSearchInfo) full_info = fsearch_database_index_store_get_search_info(store,
+                                                                                                          full_id);
+            const uint32_t num_full = fsearch_database_search_info_get_num_entries(full_info);
+            g_assert_cmpuint(num_full, >, 1);
+
+            const uint32_t limited_id = 2;
+            g_assert_true(fsearch_database_index_store_search(store,
+                                                              limited_id,
+                                                              query,
+                                                              DATABASE_INDEX_PROPERTY_NAME,
+                                                              sort_types[j],
+                                                              num_full,
+                                                              cancellable));
+            g_autoptr(FsearchDatabaseSearchInfo) info = fsearch_database_index_store_get_search_info(store, limited_id);
+            g_assert_cmpuint(fsearch_database_search_info_get_num_entries(info), ==, num_full);
+            g_assert_true(fsearch_database_search_info_get_is_complete(info));
+
+            // One less than the number of matches drops one of them
+            g_assert_false(fsearch_database_index_store_search(store,
+                                                               limited_id,
+                                                               query,
+                                                               DATABASE_INDEX_PROPERTY_NAME,
+                                                               sort_types[j],
+                                                               num_full - 1,
+                                                               cancellable));
+            g_autoptr(FsearchDatabaseSearchInfo) cut_info = fsearch_database_index_store_get_search_info(store,
+                                                                                                         limited_id);
+            g_assert_cmpuint(fsearch_database_search_info_get_num_entries(cut_info), ==, num_full - 1);
+            g_assert_false(fsearch_database_search_info_get_is_complete(cut_info));
+        }
+    }
+
+    free_entries(files);
+    free_entries(folders);
+    fsearch_filter_manager_unref(filters);
+}
+
+/*
+ * Large scans publish the matches they found so far before they're finished. Every published view has to show the
+ * first rows of the final results (with only files, in both sort orders), readable without the store lock while the
+ * search is still running, and gone once it's finished.
+ */
+typedef struct {
+    FsearchDatabaseIndexStore *store;
+    uint32_t view_id;
+    GPtrArray *last_names;
+    GArray *num_files;
+} StreamingContext;
+
+static void
+streaming_event_cb(FsearchDatabaseIndexStore *store,
+                   FsearchDatabaseIndexStoreEventKind kind,
+                   gpointer data,
+                   gpointer user_data) {
+    StreamingContext *ctx = user_data;
+    if (kind != FSEARCH_DATABASE_INDEX_STORE_EVENT_SEARCH_PROGRESS) {
+        return;
+    }
+    g_autoptr(FsearchDatabaseSearchInfo) info = data;
+    g_assert_false(fsearch_database_search_info_get_is_complete(info));
+    const uint32_t num_files = fsearch_database_search_info_get_num_files(info);
+    g_array_append_val(ctx->num_files, num_files);
+
+    g_autoptr(FsearchDatabaseEntryInfo) entry_info = fsearch_database_index_store_get_streaming_entry_info(
+        store,
+        num_files - 1,
+        ctx->view_id,
+        FSEARCH_DATABASE_ENTRY_INFO_FLAG_NAME);
+    g_assert_nonnull(entry_info);
+    g_ptr_array_add(ctx->last_names, g_strdup(fsearch_database_entry_info_get_name(entry_info)->str));
+}
+
+static void
+check_streaming_search_publishes_prefixes(GtkSortType sort_type) {
+    FsearchFilterManager *filters = fsearch_filter_manager_new_with_defaults();
+
+    // Enough files for two stages to get published before the last one
+    const uint32_t num_files = 400000;
+    DynamicArray *files = make_named_files("file", num_files);
+    g_autoptr(DynamicArray) folders = darray_new(0);
+
+    const uint32_t view_id = 1;
+    StreamingContext ctx = {
+        .view_id = view_id,
+        .last_names = g_ptr_array_new_with_free_func(g_free),
+        .num_files = g_array_new(FALSE, FALSE, sizeof(uint32_t)),
+    };
+    g_autoptr(FsearchDatabaseIndexStore) store = make_store_with_event_func(files, folders, streaming_event_cb, &ctx);
+    ctx.store = store;
+
+    g_autoptr(FsearchQuery) query = make_query(filters, "7");
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    g_assert_true(fsearch_database_index_store_search(store,
+                                                      view_id,
+                                                      query,
+                                                      DATABASE_INDEX_PROPERTY_NAME,
+                                                      sort_type,
+                                                      0,
+                                                      cancellable));
+
+    g_autoptr(FsearchDatabaseSearchInfo) info = fsearch_database_index_store_get_search_info(store, view_id);
+    g_assert_nonnull(info);
+    g_assert_true(fsearch_database_search_info_get_is_complete(info));
+    const uint32_t num_found = fsearch_database_search_info_get_num_files(info);
+
+    // The partial results grew with every stage, and each of them is where the final results continue from
+    g_assert_cmpuint(ctx.num_files->len, >, 1);
+    FsearchDatabaseSearchView *view = fsearch_database_index_store_get_search_view(store, view_id);
+    uint32_t prev_num_files = 0;
+    for (uint32_t i = 0; i < ctx.num_files->len; i++) {
+        const uint32_t num_published = g_array_index(ctx.num_files, uint32_t, i);
+        g_assert_cmpuint(num_published, >, prev_num_files);
+        g_assert_cmpuint(num_published, <, num_found);
+        FsearchDatabaseEntry *entry = fsearch_database_search_view_get_entry_for_idx(view, num_published - 1);
+        g_assert_cmpstr(db_entry_get_name_raw(entry), ==, g_ptr_array_index(ctx.last_names, i));
+        prev_num_files = num_published;
+    }
+
+    // Nothing to read anymore once the search is finished
+    g_assert_null(fsearch_database_index_store_get_streaming_entry_info(store,
+                                                                        0,
+                                                                        view_id,
+                                                                        FSEARCH_DATABASE_ENTRY_INFO_FLAG_NAME));
+
+    g_clear_pointer(&ctx.last_names, g_ptr_array_unref);
+    g_clear_pointer(&ctx.num_files, g_array_unref);
+    free_entries(files);
+    fsearch_filter_manager_unref(filters);
+}
+
+static void
+test_streaming_search_publishes_prefixes(void) {
+    check_streaming_search_publishes_prefixes(GTK_SORT_ASCENDING);
+}
+
+static void
+test_streaming_search_publishes_prefixes_descending(void) {
+    // The scan starts at the end of the index, whose matches are the first rows of the descending view
+    check_streaming_search_publishes_prefixes(GTK_SORT_DESCENDING);
+}
+
+/*
+ * An index which holds the only reference to its arena drops the arena as a whole instead of freeing its entries one by
+ * one. Entries which were too large for the arena, like a root folder with a long path, still have to be freed
+ * (checked by valgrind/asan).
+ */
+static void
+test_index_frees_entries_too_large_for_its_arena(void) {
+    g_autofree char *long_path = g_strnfill(600, 'x');
+    g_autoptr(FsearchDatabaseInclude) include = fsearch_database_include_new(long_path, TRUE, FALSE, FALSE, FALSE, 0);
+    g_autoptr(FsearchDatabaseExcludeManager) exclude_manager = fsearch_database_exclude_manager_new();
+
+    FsearchDatabaseEntryArena *arena = fsearch_database_entry_arena_new();
+    FsearchDatabaseEntry *root = db_entry_new_in_arena(arena, 0, long_path, NULL, DATABASE_ENTRY_TYPE_FOLDER);
+    FsearchDatabaseEntry *folder = db_entry_new_in_arena(arena, 0, "folder", root, DATABASE_ENTRY_TYPE_FOLDER);
+    FsearchDatabaseEntry *file = db_entry_new_in_arena(arena, 0, "file", folder, DATABASE_ENTRY_TYPE_FILE);
+    g_assert_false(db_entry_get_flags(root) & FSEARCH_DATABASE_ENTRY_FLAG_ARENA);
+    g_assert_true(db_entry_get_flags(file) & FSEARCH_DATABASE_ENTRY_FLAG_ARENA);
+
+    g_autoptr(DynamicArray) folders = darray_new(2);
+    darray_add_item(folders, root);
+    darray_add_item(folders, folder);
+    g_autoptr(DynamicArray) files = darray_new(1);
+    darray_add_item(files, file);
+
+    FsearchDatabaseIndex *index = fsearch_database_index_new_with_content(include,
+                                                                          exclude_manager,
+                                                                          folders,
+                                                                          files,
+                                                                          arena,
+                                                                          DATABASE_INDEX_PROPERTY_FLAG_NAME);
+    // Leave the index as the arena's only owner
+    g_clear_pointer(&arena, fsearch_database_entry_arena_unref);
+    g_clear_pointer(&index, fsearch_database_index_unref);
+}
+
+/*
+ * Benchmark (only run with -m perf): time until a selective query has its results on a large
+ * index, next to the cost of joining the index into a single array, which every search used to
+ * pay before matching its first entry.
+ */
+static void
+test_perf_search_time_to_first_result(void) {
+    FsearchFilterManager *filters = fsearch_filter_manager_new_with_defaults();
+
+    const uint32_t num_files = 999999;
+    DynamicArray *files = make_named_files("file", num_files);
+    g_autoptr(DynamicArray) folders = darray_new(0);
+    g_autoptr(FsearchDatabaseIndexStore) store = make_store_with_files(files, folders);
+
+    g_autoptr(FsearchDatabaseChunkedArray) file_chunks = fsearch_database_index_store_get_files(
+        store,
+        DATABASE_INDEX_PROPERTY_NAME);
+    g_test_timer_start();
+    g_autoptr(DynamicArray) joined = fsearch_database_chunked_array_get_joined(file_chunks);
+    const double join_time = g_test_timer_elapsed();
+    g_assert_cmpuint(darray_get_num_items(joined), ==, num_files);
+
+    g_autoptr(FsearchQuery) query = make_query(filters, "123456");
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    g_test_timer_start();
+    g_assert_true(fsearch_database_index_store_search(store,
+                                                      1,
+                                                      query,
+                                                      DATABASE_INDEX_PROPERTY_NAME,
+                                                      GTK_SORT_ASCENDING,
+                                                      0,
+                                                      cancellable));
+    const double search_time = g_test_timer_elapsed();
+
+    g_test_message("%u entries: join %.3f ms, search %.3f ms", num_files, join_time * 1000.0, search_time * 1000.0);
+    g_test_minimized_result(search_time, "time to first result: %.3f ms", search_time * 1000.0);
+
+    free_entries(files);
+    fsearch_filter_manager_unref(filters);
+}
+
 int
 main(int argc, char **argv) {
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/FSearch/database/index_store/cancelled_search_keeps_partial_results_marked_incomplete",
                     test_cancelled_search_keeps_partial_results_marked_incomplete);
+    g_test_add_func("/FSearch/database/index_store/search_spanning_multiple_chunks_keeps_order",
+                    test_search_spanning_multiple_chunks_keeps_order);
+    g_test_add_func("/FSearch/database/index_store/index_frees_entries_too_large_for_its_arena",
+                    test_index_frees_entries_too_large_for_its_arena);
+    g_test_add_func("/FSearch/database/index_store/trigram_index_search_matches_scan",
+                    test_trigram_index_search_matches_scan);
+    g_test_add_func("/FSearch/database/index_store/refined_search_matches_fresh_search",
+                    test_refined_search_matches_fresh_search);
+    g_test_add_func("/FSearch/database/index_store/size_range_search_matches_scan",
+                    test_size_range_search_matches_scan);
+    g_test_add_func("/FSearch/database/index_store/numeric_sort_matches_comparison_sort",
+                    test_numeric_sort_matches_comparison_sort);
+    g_test_add_func("/FSearch/database/index_store/property_sort_matches_comparison_sort",
+                    test_property_sort_matches_comparison_sort);
+    g_test_add_func("/FSearch/database/index_store/start_builds_indices_in_chain_order",
+                    test_start_builds_indices_in_chain_order);
+    g_test_add_func("/FSearch/database/index_store/content_types_get_determined_in_background",
+                    test_content_types_get_determined_in_background);
+    g_test_add_func("/FSearch/database/index_store/extension_index_search_matches_scan",
+                    test_extension_index_search_matches_scan);
+    g_test_add_func("/FSearch/database/index_store/combined_index_candidates_match_scan",
+                    test_combined_index_candidates_match_scan);
+    g_test_add_func("/FSearch/database/index_store/parent_search_matches_scan", test_parent_search_matches_scan);
+    g_test_add_func("/FSearch/database/index_store/streaming_search_publishes_prefixes",
+                    test_streaming_search_publishes_prefixes);
+    g_test_add_func("/FSearch/database/index_store/streaming_search_publishes_prefixes_descending",
+                    test_streaming_search_publishes_prefixes_descending);
+    g_test_add_func("/FSearch/database/index_store/limited_search_keeps_first_results",
+                    test_limited_search_keeps_first_results);
+    g_test_add_func("/FSearch/database/index_store/limited_search_with_exactly_limit_matches_is_complete",
+                    test_limited_search_with_exactly_limit_matches_is_complete);
+
+    if (g_test_perf()) {
+        g_test_add_func("/FSearch/database/index_store/perf/search_time_to_first_result",
+                        test_perf_search_time_to_first_result);
+    }
 
     return g_test_run();
 }
@@ -5,6 +5,9 @@
 
 #include <src/fsearch_limits.h>
 #include <src/fsearch_query.h>
+#include <src/fsearch_query_match_data.h>
+#include <src/fsearch_query_matchers.h>
+#include <src/fsearch_query_node.h>
 
 typedef struct QueryTest {
     const char *needle;
@@ -263,6 +266,18 @@ test_main(void) {
             {"test || (pic: video:)", "test.doc", false, 0, 0, true},
             {"test || (pic: video:)", "test.doc", false, 0, 0, true},
 
+            // files and folders only
+            {"folder:test", "test", true, 0, 0, true},
+            {"folder:test", "test", false, 0, 0, false},
+            {"file:test", "test", false, 0, 0, true},
+            {"file:test", "test", true, 0, 0, false},
+            {"folder:test || file:doc", "test.doc", false, 0, 0, true},
+            {"folder:test || file:pdf", "test.doc", false, 0, 0, false},
+            {"!folder:test", "test", false, 0, 0, true},
+            {"(a || b) (c || !d) e", "ace", false, 0, 0, true},
+            {"(a || b) (c || !d) e", "bde", false, 0, 0, false},
+            {"(a || b) (c || !d) e", "be", false, 0, 0, true},
+
             // bug reports:
             // #360
             {"(", "test", false, 0, QUERY_FLAG_REGEX, false},
@@ -349,11 +364,94 @@ test_german_case_mapping(void) {
     }
 }
 
+static FsearchQueryNode *
+get_first_operand(FsearchQuery *q) {
+    g_assert_nonnull(q->query_tree);
+    g_assert_nonnull(q->query_tree->children);
+    return q->query_tree->children->data;
+}
+
+static void
+test_planner_evaluates_cheap_nodes_first(void) {
+    FsearchFilterManager *manager = fsearch_filter_manager_new_with_defaults();
+
+    // The content type lookup is by far the most expensive test, the name match should reject entries before that
+    g_autoptr(FsearchQuery) content_type_query = fsearch_query_new("contenttype:image foo", NULL, manager, 0, "plan");
+    g_assert_true(get_first_operand(content_type_query)->haystack_func
+                  == (FsearchQueryNodeHaystackFunc *)fsearch_query_match_data_get_name_str);
+
+    // A size comparison is cheaper than any string search
+    g_autoptr(FsearchQuery) size_query = fsearch_query_new("foo size:>1mb", NULL, manager, 0, "plan");
+    g_assert_true(get_first_operand(size_query)->search_func == fsearch_query_matcher_size);
+
+    // Reordering must not change the results
+    QueryTest tests[] = {
+        {"foo size:>1kb", "foobar", false, 2000, 0, true},
+        {"foo size:>1kb", "foobar", false, 200, 0, false},
+        {"size:>1kb OR foo", "foobar", false, 200, 0, true},
+        {"!size:>1kb foo", "foobar", false, 200, 0, true},
+        {"regex:^f.o$ OR bar", "foo", false, 0, 0, true},
+    };
+    for (uint32_t i = 0; i < G_N_ELEMENTS(tests); i++) {
+        test_query(&tests[i]);
+    }
+
+    g_clear_pointer(&manager, fsearch_filter_manager_unref);
+}
+
+static void
+test_or_groups(void) {
+    // Long OR chains of substring searches get matched with a single automaton, which must not change the results
+    QueryTest tests[] = {
+        {"aa || bb || cc || dd", "xxccxx", false, 0, 0, true},
+        {"aa || bb || cc || dd", "xxcxcx", false, 0, 0, false},
+        {"aa || bb || cc || dd", "XXDD", false, 0, 0, true},
+        {"aa || bb || cc || dd", "XXDD", false, 0, QUERY_FLAG_MATCH_CASE, false},
+        {"abcd || bc || cdx || d", "abcx", false, 0, 0, true},
+        {"abcd || bcx || cdx || xd", "abcabc", false, 0, 0, false},
+        {"aa || size:>1kb || bb || cc || dd", "zz", false, 2000, 0, true},
+        {"aa || size:>1kb || bb || cc || dd", "zz", false, 200, 0, false},
+        {"aa || size:>1kb || bb || cc || dd", "zzdd", false, 200, 0, true},
+        {"(aa || bb || cc || dd) ee", "ddee", false, 0, 0, true},
+        {"(aa || bb || cc || dd) ee", "dd", false, 0, 0, false},
+        {"!(aa || bb || cc || dd)", "xx", false, 0, 0, true},
+        {"!(aa || bb || cc || dd)", "bb", false, 0, 0, false},
+        {"(aa || bb) || (cc || dd)", "ccc", false, 0, 0, true},
+    };
+    for (uint32_t i = 0; i < G_N_ELEMENTS(tests); i++) {
+        test_query(&tests[i]);
+    }
+}
+
+static void
+test_refinement_with_reordered_operands(void) {
+    FsearchFilterManager *manager = fsearch_filter_manager_new_with_defaults();
+
+    // With the needle "a" the planner evaluates "bc" first, once it got extended to "ab" it keeps the typed order
+    g_autoptr(FsearchQuery) old_query = fsearch_query_new("a bc", NULL, manager, 0, "refine");
+    g_autoptr(FsearchQuery) query = fsearch_query_new("ab bc", NULL, manager, 0, "refine");
+    g_assert_true(fsearch_query_is_refinement_of(query, old_query));
+
+    // OR prefers the less selective "a" first instead
+    g_autoptr(FsearchQuery) old_or_query = fsearch_query_new("bc || a", NULL, manager, 0, "refine");
+    g_autoptr(FsearchQuery) or_query = fsearch_query_new("bc || ab", NULL, manager, 0, "refine");
+    g_assert_true(fsearch_query_is_refinement_of(or_query, old_or_query));
+
+    // Each operand still has to narrow down one of the old ones
+    g_autoptr(FsearchQuery) other_query = fsearch_query_new("ab cd", NULL, manager, 0, "refine");
+    g_assert_false(fsearch_query_is_refinement_of(other_query, old_query));
+
+    g_clear_pointer(&manager, fsearch_filter_manager_unref);
+}
+
 int
 main(int argc, char *argv[]) {
     g_test_init(&argc, &argv, NULL);
     g_test_add_func("/FSearch/query/main", test_main);
     g_test_add_func("/FSearch/query/mappings_turkic", test_turkic_case_mapping);
     g_test_add_func("/FSearch/query/mappings_german", test_german_case_mapping);
+    g_test_add_func("/FSearch/query/planner_evaluates_cheap_nodes_first", test_planner_evaluates_cheap_nodes_first);
+    g_test_add_func("/FSearch/query/or_groups", test_or_groups);
+    g_test_add_func("/FSearch/query/refinement_with_reordered_operands", test_refinement_with_reordered_operands);
     return g_test_run();
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include <glib.h>
 #include <locale.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include <src/fsearch_file_utils.h>
 #include <src/fsearch_string_utils.h>
 
 static bool
@@ -203,6 +205,51 @@ test_str_wildcard_to_regex(void) {
     }
 }
 
+void
+test_str_regex_literals(void) {
+    typedef struct {
+        const char *pattern;
+        const char *prefix;
+        const char *suffix;
+        const char *literal;
+    } FsearchTestRegexLiteralsContext;
+
+    FsearchTestRegexLiteralsContext strings[] = {
+        {"^.*\\.mkv$", NULL, ".mkv", NULL},
+        {"IMG_\\d+", NULL, NULL, "IMG_"},
+        {"^IMG_.*$", "IMG_", NULL, NULL},
+        {"^abc$", "abc", "abc", NULL},
+        {"^ab?cd", "a", NULL, "cd"},
+        {"^ab+cd", "ab", NULL, "cd"},
+        {"ab{0,2}cde", NULL, NULL, "cde"},
+        {"ab{2}cde", NULL, NULL, "cde"},
+        {"x[abc]+yz(foo|bar)longest", NULL, NULL, "longest"},
+        {"a\\.b\\[c", NULL, NULL, "a.b[c"},
+        {"[]abc]def", NULL, NULL, "def"},
+        {"ab|cd", NULL, NULL, NULL},
+        {"(?i)abc", NULL, NULL, NULL},
+        {"\\Qa.b\\E", NULL, NULL, NULL},
+        {"\\x41bc", NULL, NULL, NULL},
+        {"(ab)\\1", NULL, NULL, NULL},
+        {"ab$c", NULL, NULL, "ab"},
+        {"abc\\z", NULL, NULL, "abc"},
+        {"äbc$", NULL, "bc", NULL},
+        {"a", NULL, NULL, NULL},
+        {"", NULL, NULL, NULL},
+    };
+
+    for (gint i = 0; i < G_N_ELEMENTS(strings); ++i) {
+        FsearchTestRegexLiteralsContext *ctx = &strings[i];
+        g_autofree char *prefix = NULL;
+        g_autofree char *suffix = NULL;
+        g_autofree char *literal = NULL;
+        fsearch_string_get_regex_literals(ctx->pattern, &prefix, &suffix, &literal);
+        g_assert_cmpstr(prefix, ==, ctx->prefix);
+        g_assert_cmpstr(suffix, ==, ctx->suffix);
+        g_assert_cmpstr(literal, ==, ctx->literal);
+    }
+}
+
 void
 test_str_starts_with_interval(void) {
     typedef struct {
@@ -234,6 +281,189 @@ test_str_starts_with_interval(void) {
     }
 }
 
+void
+test_str_ascii_casestr(void) {
+    typedef struct {
+        const char *haystack;
+        const char *needle;
+        int match_idx;
+    } FsearchTestAsciiCaseStrContext;
+
+    FsearchTestAsciiCaseStrContext strings[] = {
+        {"", "", 0},
+        {"abc", "", 0},
+        {"", "a", -1},
+        {"a", "ab", -1},
+        {"README.md", "readme", 0},
+        {"readme.MD", "Md", 7},
+        {"Screenshot from 2024-05-01 12-00-00.png", "2024-05", 16},
+        {"Screenshot from 2024-05-01 12-00-00.png", ".PNG", 35},
+        {"Screenshot from 2024-05-01 12-00-00.png", "12-00-01", -1},
+        // '@' and '`' as well as '[' and '{' only differ in the bit used for folding letters
+        {"user@example.com", "`", -1},
+        {"user`example.com", "@", -1},
+        {"array[0]", "{", -1},
+        {"a_very_long_file_name_which_spans_more_than_one_vector_block.tar.gz", "TAR.GZ", 61},
+        {"a_very_long_file_name_which_spans_more_than_one_vector_block.tar.gz", "tar.gzip", -1},
+        {"Bücher und Noten.pdf", "NOTEN", 12},
+    };
+
+    for (gint i = 0; i < G_N_ELEMENTS(strings); ++i) {
+        FsearchTestAsciiCaseStrContext *ctx = &strings[i];
+        const char *res = fsearch_string_ascii_casestr(ctx->haystack, ctx->needle, strlen(ctx->needle));
+        if (ctx->match_idx < 0) {
+            g_assert_null(res);
+        }
+        else {
+            g_assert_true(res == ctx->haystack + ctx->match_idx);
+        }
+    }
+
+    // Compare with strcasestr for all kinds of haystack lengths, so every vector block and tail size gets hit
+    const char alphabet[] = "aAbBzZ09.-_@`[{";
+    GRand *rand = g_rand_new_with_seed(42);
+    char haystack[200];
+    char needle[8];
+    for (uint32_t i = 0; i < 100000; ++i) {
+        const int32_t haystack_len = g_rand_int_range(rand, 0, sizeof(haystack));
+        const int32_t needle_len = g_rand_int_range(rand, 1, sizeof(needle));
+        for (int32_t j = 0; j < haystack_len; ++j) {
+            haystack[j] = alphabet[g_rand_int_range(rand, 0, sizeof(alphabet) - 1)];
+        }
+        haystack[haystack_len] = '\0';
+        for (int32_t j = 0; j < needle_len; ++j) {
+            needle[j] = alphabet[g_rand_int_range(rand, 0, sizeof(alphabet) - 1)];
+        }
+        needle[needle_len] = '\0';
+
+        g_assert_true(fsearch_string_ascii_casestr(haystack, needle, needle_len) == strcasestr(haystack, needle));
+    }
+    g_rand_free(rand);
+}
+
+static int
+cmp_path_sort_keys(const char *s1, const char *s2) {
+    g_autofree uint8_t *key1 = g_malloc(fsearch_file_utils_get_path_sort_key(s1, NULL, 0));
+    g_autofree uint8_t *key2 = g_malloc(fsearch_file_utils_get_path_sort_key(s2, NULL, 0));
+    const size_t len1 = fsearch_file_utils_get_path_sort_key(s1, key1, SIZE_MAX);
+    const size_t len2 = fsearch_file_utils_get_path_sort_key(s2, key2, SIZE_MAX);
+    const int res = memcmp(key1, key2, MIN(len1, len2));
+    if (res != 0) {
+        return res < 0 ? -1 : 1;
+    }
+    return len1 < len2 ? -1 : len1 > len2 ? 1 : 0;
+}
+
+static int
+sign(int value) {
+    return (value > 0) - (value < 0);
+}
+
+void
+test_file_path_sort_keys(void) {
+    // Runs of digits around the limit of the one byte length and zero count fields of the sort keys
+    g_autofree char *nines_254 = g_strnfill(254, '9');
+    g_autofree char *nines_255 = g_strnfill(255, '9');
+    g_autofree char *nines_300 = g_strnfill(300, '9');
+    g_autofree char *zeros_254 = g_strnfill(254, '0');
+    g_autofree char *zeros_255 = g_strnfill(255, '0');
+    g_autofree char *zeros_300 = g_strnfill(300, '0');
+    g_autofree char *zeros_255_one = g_strconcat(zeros_255, "1", NULL);
+    g_autofree char *one_zeros_255 = g_strconcat("1", zeros_255, NULL);
+
+    // Each in the order fsearch_file_utils_cmp_paths() sorts them
+    const char *ordered[][10] = {
+        {"000", "00", "01", "010", "09", "0", "1", "9", "10", NULL},
+        {"", "/", "//", "a", "a/", "a//", "a/b", "a-b", "ab", NULL},
+        {"a", "a01b", "a0", "a1b", "a9", "a10b", NULL},
+        {"x/y0", "x0/y", NULL},
+        {"007", "00a", "0a", "7", "99a", "100a", NULL},
+        {zeros_300, zeros_255_one, zeros_255, zeros_254, "0", NULL},
+        {"9", nines_254, nines_255, one_zeros_255, nines_300, NULL},
+    };
+
+    g_autoptr(GPtrArray) strings = g_ptr_array_new();
+    for (uint32_t i = 0; i < G_N_ELEMENTS(ordered); ++i) {
+        for (uint32_t j = 0; ordered[i][j]; ++j) {
+            if (ordered[i][j + 1]) {
+                g_assert_cmpint(fsearch_file_utils_cmp_paths(ordered[i][j], ordered[i][j + 1]), <, 0);
+            }
+            g_ptr_array_add(strings, (gpointer)ordered[i][j]);
+        }
+    }
+
+    // The keys of all pairs compare like the strings themselves
+    for (uint32_t i = 0; i < strings->len; ++i) {
+        for (uint32_t j = 0; j < strings->len; ++j) {
+            const char *s1 = g_ptr_array_index(strings, i);
+            const char *s2 = g_ptr_array_index(strings, j);
+            g_assert_cmpint(cmp_path_sort_keys(s1, s2), ==, sign(fsearch_file_utils_cmp_paths(s1, s2)));
+        }
+    }
+
+    // A small buffer gets a prefix of the key, but the full length is returned
+    uint8_t full_key[64] = {};
+    uint8_t prefix[4] = {};
+    const size_t len = fsearch_file_utils_get_path_sort_key("a/b10c", full_key, sizeof(full_key));
+    g_assert_cmpuint(fsearch_file_utils_get_path_sort_key("a/b10c", prefix, sizeof(prefix)), ==, len);
+    g_assert_cmpuint(len, >, sizeof(prefix));
+    g_assert_cmpmem(prefix, sizeof(prefix), full_key, sizeof(prefix));
+}
+
+static GPtrArray *
+make_file_name_corpus(uint32_t num_names) {
+    const char *stems[] = {"IMG_", "Screenshot from 2024-", "libgtk-3", "README", "node_modules", "index", "main",
+                           "Makefile", "report_final_v", "DSC0", "backup-", "invoice ", "CMakeLists", "config"};
+    const char *extensions[] = {".jpg", ".PNG", ".so.0", ".md", "", ".c", ".h", ".pdf", ".tar.gz", ".txt", ".json"};
+
+    GPtrArray *names = g_ptr_array_new_full(num_names, g_free);
+    GRand *rand = g_rand_new_with_seed(42);
+    for (uint32_t i = 0; i < num_names; ++i) {
+        g_ptr_array_add(names,
+                        g_strdup_printf("%s%u%s",
+                                        stems[g_rand_int_range(rand, 0, G_N_ELEMENTS(stems))],
+                                        g_rand_int_range(rand, 0, 100000),
+                                        extensions[g_rand_int_range(rand, 0, G_N_ELEMENTS(extensions))]));
+    }
+    g_rand_free(rand);
+    return names;
+}
+
+void
+test_perf_str_ascii_casestr(void) {
+    const char *needles[] = {"e", "png", "readme", "screenshot from", "42.tar.gz", "does_not_exist"};
+    const uint32_t num_names = 1000000;
+    g_autoptr(GPtrArray) names = make_file_name_corpus(num_names);
+
+    for (uint32_t i = 0; i < G_N_ELEMENTS(needles); ++i) {
+        const char *needle = needles[i];
+        const size_t needle_len = strlen(needle);
+
+        uint32_t num_matches_libc = 0;
+        g_test_timer_start();
+        for (uint32_t j = 0; j < num_names; ++j) {
+            num_matches_libc += strcasestr(g_ptr_array_index(names, j), needle) ? 1 : 0;
+        }
+        const double libc_time = g_test_timer_elapsed();
+
+        uint32_t num_matches = 0;
+        g_test_timer_start();
+        for (uint32_t j = 0; j < num_names; ++j) {
+            num_matches += fsearch_string_ascii_casestr(g_ptr_array_index(names, j), needle, needle_len) ? 1 : 0;
+        }
+        const double time = g_test_timer_elapsed();
+
+        g_assert_cmpuint(num_matches, ==, num_matches_libc);
+        g_test_message("\"%s\" in %u names (%u matches): strcasestr %.3f ms, ascii_casestr %.3f ms",
+                       needle,
+                       num_names,
+                       num_matches,
+                       libc_time * 1000.0,
+                       time * 1000.0);
+        g_test_minimized_result(time, "ascii_casestr \"%s\": %.3f ms", needle, time * 1000.0);
+    }
+}
+
 int
 main(int argc, char *argv[]) {
     g_test_init(&argc, &argv, NULL);
@@ -243,6 +473,13 @@ main(int argc, char *argv[]) {
     g_test_add_func("/FSearch/string_utils/has_upper_utf8", test_str_utf8_has_upper);
     g_test_add_func("/FSearch/string_utils/is_ascii_icase", test_str_icase_is_ascii);
     g_test_add_func("/FSearch/string_utils/convert_wildcard_to_regex", test_str_wildcard_to_regex);
+    g_test_add_func("/FSearch/string_utils/regex_literals", test_str_regex_literals);
     g_test_add_func("/FSearch/string_utils/starts_with_interval", test_str_starts_with_interval);
+    g_test_add_func("/FSearch/string_utils/ascii_casestr", test_str_ascii_casestr);
+    g_test_add_func("/FSearch/string_utils/file_path_sort_keys", test_file_path_sort_keys);
+
+    if (g_test_perf()) {
+        g_test_add_func("/FSearch/string_utils/perf/ascii_casestr", test_perf_str_ascii_casestr);
+    }
     return g_test_run();
 }
\ No newline at end of file